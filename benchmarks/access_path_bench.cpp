@@ -0,0 +1,91 @@
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "encomsys.hpp"
+
+/*
+ * Reads the position of 100k admin players for a number of ticks through get_ref() and through cached
+ * access paths.
+ */
+
+constexpr std::size_t NUMBER_OF_ADMINS = 100000;
+constexpr std::size_t NUMBER_OF_TICKS = 20;
+
+struct player_name_t {
+	player_name_t() = default;
+	player_name_t(const std::string& name) : name(name) {}
+
+	std::string name;
+};
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x) : x(x) {}
+
+	float x;
+};
+
+struct password_component {
+	std::string passwd;
+
+	password_component() = default;
+	password_component(const std::string& pw) : passwd(pw) {}
+};
+
+struct player_relation : encom::relation<player_name_t, position_t> {
+	using encom::relation<player_name_t, position_t>::relation;
+};
+
+struct admin_player_relation : encom::relation<player_relation, password_component> {
+	using encom::relation<player_relation, password_component>::relation;
+
+	admin_player_relation() {}
+};
+
+using ensys = encom::encomsys<admin_player_relation, player_relation, player_name_t, position_t, password_component>;
+using admin_position_path = encom::access_path<ensys, admin_player_relation, player_relation, position_t>;
+
+template<typename Func>
+double measure(Func func) {
+	const auto start = std::chrono::steady_clock::now();
+	func();
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+int main() {
+	ensys ensys;
+	std::vector<encom::handle<admin_player_relation>> admins;
+	const admin_player_relation admin(player_relation("admin", position_t(1.f)), password_component("password"));
+	ensys.add_n(admin, NUMBER_OF_ADMINS, std::back_inserter(admins));
+
+	std::vector<admin_position_path> paths;
+	paths.reserve(NUMBER_OF_ADMINS);
+	for (const encom::handle<admin_player_relation>& handle : admins) {
+		paths.emplace_back(handle);
+	}
+
+	float sum = 0.f;
+	const double get_ref_ms = measure([&]() {
+		for (std::size_t tick = 0; tick < NUMBER_OF_TICKS; tick++) {
+			for (const encom::handle<admin_player_relation>& handle : admins) {
+				sum += ensys.get_ref(handle)->get<player_relation, position_t>().x;
+			}
+		}
+	});
+
+	const double path_ms = measure([&]() {
+		for (std::size_t tick = 0; tick < NUMBER_OF_TICKS; tick++) {
+			for (admin_position_path& path : paths) {
+				sum += path.get(ensys)->x;
+			}
+		}
+	});
+
+	std::cout << "admins=" << NUMBER_OF_ADMINS << " ticks=" << NUMBER_OF_TICKS << " (checksum " << sum << ")" << std::endl;
+	std::cout << "get_ref:     " << get_ref_ms << " ms" << std::endl;
+	std::cout << "access_path: " << path_ms << " ms (" << get_ref_ms / path_ms << "x)" << std::endl;
+}
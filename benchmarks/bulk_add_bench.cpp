@@ -0,0 +1,69 @@
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "encomsys.hpp"
+
+/*
+ * Loads 500k players one by one with add() and at once with add_bulk().
+ */
+
+constexpr std::size_t NUMBER_OF_PLAYERS = 500000;
+
+struct player_name_t {
+	player_name_t() = default;
+	player_name_t(const std::string& name) : name(name) {}
+
+	std::string name;
+};
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x) : x(x) {}
+
+	float x;
+};
+
+struct player_relation : encom::relation<player_name_t, position_t> {
+	using encom::relation<player_name_t, position_t>::relation;
+};
+
+using ensys = encom::encomsys<player_relation, player_name_t, position_t>;
+
+template<typename Func>
+double measure(Func func) {
+	const auto start = std::chrono::steady_clock::now();
+	func();
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+int main() {
+	std::vector<player_relation> players;
+	players.reserve(NUMBER_OF_PLAYERS);
+	for (std::size_t i = 0; i < NUMBER_OF_PLAYERS; i++) {
+		players.emplace_back(player_name_t("player" + std::to_string(i)), position_t(static_cast<float>(i)));
+	}
+
+	std::vector<encom::handle<player_relation>> handles;
+	handles.reserve(NUMBER_OF_PLAYERS);
+
+	const double single_ms = measure([&]() {
+		ensys ensys;
+		for (const player_relation& player : players) {
+			handles.push_back(ensys.add(player));
+		}
+	});
+
+	handles.clear();
+	const double bulk_ms = measure([&]() {
+		ensys ensys;
+		ensys.add_bulk<player_relation>(players.begin(), players.end(), std::back_inserter(handles));
+	});
+
+	std::cout << "players=" << NUMBER_OF_PLAYERS << std::endl;
+	std::cout << "add:      " << single_ms << " ms" << std::endl;
+	std::cout << "add_bulk: " << bulk_ms << " ms (" << single_ms / bulk_ms << "x)" << std::endl;
+}
@@ -0,0 +1,118 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "encomsys.hpp"
+
+/*
+ * Fragments the storages of 1M players by removing and adding random players for a while and then
+ * removing half of them. Compares the memory of the storages and the time to iterate over all players
+ * before and after defragment() with and without reordering the childs. The incremental compaction
+ * is measured per step.
+ */
+
+constexpr std::size_t NUMBER_OF_PLAYERS = 1000000;
+constexpr std::size_t NUMBER_OF_CHURNS = 2000000;
+constexpr std::size_t NUMBER_OF_ITERATIONS = 10;
+constexpr std::size_t STEP_BUDGET = 4096;
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x, const float y) : x(x), y(y) {}
+
+	float x;
+	float y;
+};
+
+struct velocity_t {
+	velocity_t() = default;
+	velocity_t(const float x, const float y) : x(x), y(y) {}
+
+	float x;
+	float y;
+};
+
+struct player_relation : encom::relation<position_t, velocity_t> {
+	using encom::relation<position_t, velocity_t>::relation;
+};
+
+using ensys = encom::encomsys<player_relation, position_t, velocity_t>;
+
+template<typename Func>
+double measure(Func func) {
+	const auto start = std::chrono::steady_clock::now();
+	func();
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+/**
+ * @returns the bytes of all slots of the storages
+ */
+std::size_t storage_bytes(const ensys& ensys) {
+	return ensys.get_components<player_relation>().slot_count() * sizeof(encom::index_vector_slot<encom::component_wrapper<player_relation>>)
+		+ ensys.get_components<position_t>().slot_count() * sizeof(encom::index_vector_slot<encom::component_wrapper<position_t>>)
+		+ ensys.get_components<velocity_t>().slot_count() * sizeof(encom::index_vector_slot<encom::component_wrapper<velocity_t>>);
+}
+
+/**
+ * Fills the encomsys with fragmented players.
+ */
+void fragment(ensys& ensys) {
+	std::mt19937 rng(42);
+	std::vector<encom::handle<player_relation>> players;
+	players.reserve(NUMBER_OF_PLAYERS);
+	for (std::size_t i = 0; i < NUMBER_OF_PLAYERS; i++) {
+		players.push_back(ensys.add(player_relation(position_t(float(i), 0.f), velocity_t(1.f, 0.f))));
+	}
+	for (std::size_t i = 0; i < NUMBER_OF_CHURNS; i++) {
+		const std::size_t victim = rng() % players.size();
+		ensys.remove(players[victim]);
+		players[victim] = ensys.add(player_relation(position_t(float(i), 0.f), velocity_t(1.f, 0.f)));
+	}
+	for (std::size_t i = 0; i < NUMBER_OF_PLAYERS; i += 2) {
+		ensys.remove(players[i]);
+	}
+}
+
+double iterate_ms(ensys& ensys, double* sum) {
+	return measure([&]() {
+		for (std::size_t i = 0; i < NUMBER_OF_ITERATIONS; i++) {
+			ensys.view<player_relation>().for_each([sum](const player_relation::as_ref& player) {
+				*sum += player.get<position_t>().x + player.get<velocity_t>().x;
+			});
+		}
+	}) / NUMBER_OF_ITERATIONS;
+}
+
+void report(const char* name, ensys& ensys) {
+	double sum = 0.0;
+	const double ms = iterate_ms(ensys, &sum);
+	std::cout << "  " << name << ": " << ms << " ms per iteration, " << storage_bytes(ensys) / (1024 * 1024) << " MiB in "
+		<< ensys.get_components<position_t>().slot_count() << " position slots (checksum " << sum << ")" << std::endl;
+}
+
+int main() {
+	std::cout << "players=" << NUMBER_OF_PLAYERS / 2 << " after " << NUMBER_OF_CHURNS << " random removes and adds" << std::endl;
+	for (const encom::compaction_order order : {encom::compaction_order::none, encom::compaction_order::parents}) {
+		ensys ensys;
+		fragment(ensys);
+		std::cout << (order == encom::compaction_order::parents ? "reordered childs" : "moved into holes") << std::endl;
+		report("fragmented", ensys);
+
+		std::size_t number_of_steps = 0;
+		double longest_step_ms = 0.0;
+		const double compact_ms = measure([&]() {
+			bool done = false;
+			while (!done) {
+				const double step_ms = measure([&]() { done = ensys.defragment_step(STEP_BUDGET, order); });
+				longest_step_ms = step_ms > longest_step_ms ? step_ms : longest_step_ms;
+				number_of_steps++;
+			}
+		});
+		std::cout << "  defragment: " << compact_ms << " ms in " << number_of_steps << " steps of " << STEP_BUDGET
+			<< " (longest " << longest_step_ms << " ms)" << std::endl;
+		report("compacted", ensys);
+	}
+}
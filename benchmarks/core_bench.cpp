@@ -0,0 +1,365 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "encomsys.hpp"
+
+/*
+ * Measures the core operations add, get, get_ref, remove, has_element and for_each for components and
+ * relations with a nesting depth of 1 to 3 at 10k, 100k and 1M live entities. Before measuring, the
+ * storages are filled with entities / (1 - hole_ratio) entities and the surplus is removed at random,
+ * so the entities are spread over storages with holes. A std::vector of the same components without
+ * holes is the baseline.
+ *
+ * The results are written as JSON to the file given as first argument or to stdout. Every result is
+ * the average time of one operation:
+ *   {"container": "encomsys", "type": "relation_depth_2", "depth": 2, "entities": 100000,
+ *    "hole_ratio": 0.5, "operation": "get_ref", "ns_per_op": 12.3, "ops": 1000000}
+ * The reads of every configuration are repeated until they cover about MIN_OPS operations.
+ * has_element is called with the handles of the removed entities too, so the share of failed lookups
+ * equals the hole ratio. remove removes half of the entities at random, add adds them again.
+ * The build options, that change the measured code, are written next to the results. Build with
+ * -DENCOM_NO_STATS and -DENCOM_COMPACT_HANDLES to compare them.
+ */
+
+constexpr std::size_t NUMBER_OF_ENTITIES[] = {10000, 100000, 1000000};
+constexpr double HOLE_RATIOS[] = {0.0, 0.25, 0.5};
+constexpr std::size_t MIN_OPS = 1000000;
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x, const float y) : x(x), y(y) {}
+
+	float x;
+	float y;
+};
+
+struct velocity_t {
+	velocity_t() = default;
+	velocity_t(const float x, const float y) : x(x), y(y) {}
+
+	float x;
+	float y;
+};
+
+struct health_t {
+	health_t() = default;
+	health_t(const int hp) : hp(hp) {}
+
+	int hp;
+};
+
+struct team_t {
+	team_t() = default;
+	team_t(const int id) : id(id) {}
+
+	int id;
+};
+
+struct relation_depth_1 : encom::relation<position_t, velocity_t> {
+	using encom::relation<position_t, velocity_t>::relation;
+};
+
+struct relation_depth_2 : encom::relation<relation_depth_1, health_t> {
+	using encom::relation<relation_depth_1, health_t>::relation;
+
+	relation_depth_2() {}
+};
+
+struct relation_depth_3 : encom::relation<relation_depth_2, team_t> {
+	using encom::relation<relation_depth_2, team_t>::relation;
+
+	relation_depth_3() {}
+};
+
+using ensys = encom::encomsys<relation_depth_3, relation_depth_2, relation_depth_1, position_t, velocity_t, health_t, team_t>;
+
+/**
+ * How the benchmark creates and reads the entities of one type. read() and write() access the
+ * position of the entity.
+ */
+template<typename EntityType>
+struct bench_type;
+
+template<>
+struct bench_type<position_t> {
+	static constexpr const char* name = "position_t";
+	static constexpr int depth = 0;
+
+	static position_t make(const std::size_t i) { return position_t(float(i), 0.f); }
+	static float read(const position_t& p) { return p.x; }
+	static void write(position_t& p) { p.y += 1.f; }
+};
+
+template<>
+struct bench_type<relation_depth_1> {
+	static constexpr const char* name = "relation_depth_1";
+	static constexpr int depth = 1;
+
+	static relation_depth_1 make(const std::size_t i) {
+		return relation_depth_1(position_t(float(i), 0.f), velocity_t(1.f, 0.f));
+	}
+	static float read(const relation_depth_1& r) { return r.get<position_t>().x; }
+	static void write(const relation_depth_1::as_ref& r) { r.get<position_t>().y += 1.f; }
+};
+
+template<>
+struct bench_type<relation_depth_2> {
+	static constexpr const char* name = "relation_depth_2";
+	static constexpr int depth = 2;
+
+	static relation_depth_2 make(const std::size_t i) {
+		return relation_depth_2(bench_type<relation_depth_1>::make(i), health_t(100));
+	}
+	static float read(const relation_depth_2& r) { return r.get<relation_depth_1, position_t>().x; }
+	static void write(const relation_depth_2::as_ref& r) { r.get<relation_depth_1, position_t>().y += 1.f; }
+};
+
+template<>
+struct bench_type<relation_depth_3> {
+	static constexpr const char* name = "relation_depth_3";
+	static constexpr int depth = 3;
+
+	static relation_depth_3 make(const std::size_t i) {
+		return relation_depth_3(bench_type<relation_depth_2>::make(i), team_t(int(i % 2)));
+	}
+	static float read(const relation_depth_3& r) { return r.get<relation_depth_2, relation_depth_1, position_t>().x; }
+	static void write(const relation_depth_3::as_ref& r) { r.get<relation_depth_2, relation_depth_1, position_t>().y += 1.f; }
+};
+
+// keeps the compiler from dropping the reads
+double checksum = 0.0;
+
+void sum_position(const position_t& p) {
+	checksum += p.x;
+}
+
+template<typename Func>
+double measure(Func func) {
+	const auto start = std::chrono::steady_clock::now();
+	func();
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(stop - start).count();
+}
+
+class json_results {
+	private:
+		std::ostringstream _results;
+		bool _first = true;
+
+	public:
+		void add(const char* container, const char* type, const int depth, const std::size_t entities, const double hole_ratio,
+			const char* operation, const double total_ns, const std::size_t ops)
+		{
+			_results << (_first ? "\n" : ",\n") << "    {\"container\": \"" << container << "\", \"type\": \"" << type
+				<< "\", \"depth\": " << depth << ", \"entities\": " << entities << ", \"hole_ratio\": " << hole_ratio
+				<< ", \"operation\": \"" << operation << "\", \"ns_per_op\": " << (ops == 0 ? 0.0 : total_ns / double(ops))
+				<< ", \"ops\": " << ops << "}";
+			_first = false;
+		}
+
+		void write(std::ostream& out) const {
+			out << "{\n  \"benchmark\": \"core\",\n";
+#ifdef ENCOM_COMPACT_HANDLES
+			out << "  \"compact_handles\": true,\n";
+#else
+			out << "  \"compact_handles\": false,\n";
+#endif
+#ifdef ENCOM_NO_STATS
+			out << "  \"stats\": false,\n";
+#else
+			out << "  \"stats\": true,\n";
+#endif
+			out << "  \"checksum\": " << checksum << ",\n";
+			out << "  \"results\": [" << _results.str() << "\n  ]\n}" << std::endl;
+		}
+};
+
+/**
+ * @returns how often the reads over n entities are repeated to cover MIN_OPS operations
+ */
+std::size_t repetitions(const std::size_t n) {
+	return std::max<std::size_t>(1, MIN_OPS / n);
+}
+
+template<typename EntityType>
+void bench_encomsys(json_results* results, const std::size_t entities, const double hole_ratio) {
+	using type = bench_type<EntityType>;
+	const auto report = [&](const char* operation, const double total_ns, const std::size_t ops) {
+		results->add("encomsys", type::name, type::depth, entities, hole_ratio, operation, total_ns, ops);
+	};
+
+	ensys ensys;
+	std::mt19937 rng(42);
+
+	// fill and punch holes. The handles of the removed entities are kept for has_element.
+	const std::size_t number_of_slots = std::size_t(double(entities) / (1.0 - hole_ratio));
+	std::vector<encom::handle<EntityType>> all_handles;
+	all_handles.reserve(number_of_slots);
+	for (std::size_t i = 0; i < number_of_slots; i++) {
+		all_handles.push_back(ensys.add(type::make(i)));
+	}
+	std::vector<std::size_t> victims(number_of_slots);
+	for (std::size_t i = 0; i < number_of_slots; i++) {
+		victims[i] = i;
+	}
+	std::shuffle(victims.begin(), victims.end(), rng);
+	std::vector<bool> removed(number_of_slots, false);
+	for (std::size_t i = 0; i < number_of_slots - entities; i++) {
+		ensys.remove(all_handles[victims[i]]);
+		removed[victims[i]] = true;
+	}
+	std::vector<encom::handle<EntityType>> live;
+	live.reserve(entities);
+	for (std::size_t i = 0; i < number_of_slots; i++) {
+		if (!removed[i]) {
+			live.push_back(all_handles[i]);
+		}
+	}
+
+	const std::size_t reps = repetitions(entities);
+	report("get", measure([&]() {
+		for (std::size_t r = 0; r < reps; r++) {
+			for (const encom::handle<EntityType>& h : live) {
+				checksum += type::read(*ensys.get(h));
+			}
+		}
+	}), reps * live.size());
+
+	report("get_ref", measure([&]() {
+		for (std::size_t r = 0; r < reps; r++) {
+			for (const encom::handle<EntityType>& h : live) {
+				type::write(*ensys.get_ref(h));
+			}
+		}
+	}), reps * live.size());
+
+	std::size_t found = 0;
+	report("has_element", measure([&]() {
+		for (std::size_t r = 0; r < reps; r++) {
+			for (const encom::handle<EntityType>& h : all_handles) {
+				found += ensys.has_element(h);
+			}
+		}
+	}), reps * all_handles.size());
+	checksum += double(found);
+
+	if constexpr (encom::is_relation_v<EntityType>) {
+		report("for_each", measure([&]() {
+			for (std::size_t r = 0; r < reps; r++) {
+				ensys.query<EntityType>([](const typename EntityType::as_ref& relation) {
+					type::write(relation);
+				});
+			}
+		}), reps * live.size());
+	} else {
+		report("for_each", measure([&]() {
+			for (std::size_t r = 0; r < reps; r++) {
+				ensys.for_each<EntityType>(&sum_position);
+			}
+		}), reps * live.size());
+	}
+
+	// remove half of the entities at random and add them again
+	std::shuffle(live.begin(), live.end(), rng);
+	const std::size_t half = live.size() / 2;
+	report("remove", measure([&]() {
+		for (std::size_t i = 0; i < half; i++) {
+			ensys.remove(live[i]);
+		}
+	}), half);
+
+	report("add", measure([&]() {
+		for (std::size_t i = 0; i < half; i++) {
+			live[i] = ensys.add(type::make(i));
+		}
+	}), half);
+}
+
+/**
+ * The same operations on a std::vector of positions. get_ref writes through the index, has_element
+ * checks the index, remove swaps the element with the last one.
+ */
+void bench_vector(json_results* results, const std::size_t entities) {
+	const auto report = [&](const char* operation, const double total_ns, const std::size_t ops) {
+		results->add("std::vector", "position_t", 0, entities, 0.0, operation, total_ns, ops);
+	};
+
+	std::mt19937 rng(42);
+	std::vector<position_t> positions;
+	report("add", measure([&]() {
+		for (std::size_t i = 0; i < entities; i++) {
+			positions.push_back(position_t(float(i), 0.f));
+		}
+	}), entities);
+
+	const std::size_t reps = repetitions(entities);
+	report("get", measure([&]() {
+		for (std::size_t r = 0; r < reps; r++) {
+			for (std::size_t i = 0; i < entities; i++) {
+				checksum += positions[i].x;
+			}
+		}
+	}), reps * entities);
+
+	report("get_ref", measure([&]() {
+		for (std::size_t r = 0; r < reps; r++) {
+			for (std::size_t i = 0; i < entities; i++) {
+				positions[i].y += 1.f;
+			}
+		}
+	}), reps * entities);
+
+	std::size_t found = 0;
+	report("has_element", measure([&]() {
+		for (std::size_t r = 0; r < reps; r++) {
+			for (std::size_t i = 0; i < entities; i++) {
+				found += i < positions.size();
+			}
+		}
+	}), reps * entities);
+	checksum += double(found);
+
+	report("for_each", measure([&]() {
+		for (std::size_t r = 0; r < reps; r++) {
+			for (const position_t& p : positions) {
+				sum_position(p);
+			}
+		}
+	}), reps * entities);
+
+	const std::size_t half = entities / 2;
+	report("remove", measure([&]() {
+		for (std::size_t i = 0; i < half; i++) {
+			const std::size_t victim = rng() % positions.size();
+			positions[victim] = positions.back();
+			positions.pop_back();
+		}
+	}), half);
+}
+
+int main(int argc, char* argv[]) {
+	json_results results;
+	for (const std::size_t entities : NUMBER_OF_ENTITIES) {
+		bench_vector(&results, entities);
+		for (const double hole_ratio : HOLE_RATIOS) {
+			std::cerr << "entities=" << entities << " hole_ratio=" << hole_ratio << std::endl;
+			bench_encomsys<position_t>(&results, entities, hole_ratio);
+			bench_encomsys<relation_depth_1>(&results, entities, hole_ratio);
+			bench_encomsys<relation_depth_2>(&results, entities, hole_ratio);
+			bench_encomsys<relation_depth_3>(&results, entities, hole_ratio);
+		}
+	}
+
+	if (argc > 1) {
+		std::ofstream out(argv[1]);
+		results.write(out);
+	} else {
+		results.write(std::cout);
+	}
+}
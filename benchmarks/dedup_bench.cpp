@@ -0,0 +1,128 @@
+#include <array>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "encomsys.hpp"
+
+/*
+ * Adds 200k relations, that share one of 16 configurations and one of 64 names, once with plain childs
+ * and std::string names and once with deduplicated childs and interned names. Reports the time to add
+ * and read them and the memory of the child storages.
+ */
+
+constexpr std::size_t NUMBER_OF_UNITS = 200000;
+constexpr std::size_t NUMBER_OF_CONFIGS = 16;
+constexpr std::size_t NUMBER_OF_NAMES = 64;
+
+struct config_t {
+	config_t() = default;
+	config_t(const int difficulty) : difficulty(difficulty), spawn_rate(1.f), view_distance(100.f) {}
+
+	bool operator==(const config_t& other) const {
+		return difficulty == other.difficulty && spawn_rate == other.spawn_rate && view_distance == other.view_distance && flags == other.flags;
+	}
+
+	int difficulty;
+	float spawn_rate;
+	float view_distance;
+	std::array<int, 13> flags = {};
+};
+
+struct shared_config_t : config_t {
+	using config_t::config_t;
+};
+
+struct name_t {
+	name_t() = default;
+	name_t(const std::string& name) : name(name) {}
+
+	std::string name;
+};
+
+struct shared_name_t {
+	shared_name_t() = default;
+	shared_name_t(const std::string& name) : name(name) {}
+
+	bool operator==(const shared_name_t& other) const {
+		return name == other.name;
+	}
+
+	encom::interned_string name;
+};
+
+struct unit_relation : encom::relation<name_t, config_t> {
+	using encom::relation<name_t, config_t>::relation;
+};
+
+struct shared_unit_relation : encom::relation<shared_name_t, shared_config_t> {
+	using encom::relation<shared_name_t, shared_config_t>::relation;
+};
+
+template<>
+struct std::hash<shared_config_t> {
+	std::size_t operator()(const shared_config_t& config) const {
+		return std::hash<int>()(config.difficulty);
+	}
+};
+
+template<>
+struct std::hash<shared_name_t> {
+	std::size_t operator()(const shared_name_t& name) const {
+		return std::hash<encom::interned_string>()(name.name);
+	}
+};
+
+template<> struct encom::deduplicate<shared_config_t> : std::true_type {};
+template<> struct encom::deduplicate<shared_name_t> : std::true_type {};
+
+using ensys = encom::encomsys<unit_relation, shared_unit_relation, name_t, config_t, shared_name_t, shared_config_t>;
+
+template<typename Func>
+double measure(Func func) {
+	const auto start = std::chrono::steady_clock::now();
+	func();
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+template<typename UnitType, typename NameType, typename ConfigType>
+void run(ensys& ensys, const char* name) {
+	std::vector<std::string> names;
+	for (std::size_t i = 0; i < NUMBER_OF_NAMES; i++) {
+		names.push_back("player_with_a_long_name_" + std::to_string(i));
+	}
+
+	std::vector<encom::handle<UnitType>> units;
+	units.reserve(NUMBER_OF_UNITS);
+	const double add_ms = measure([&]() {
+		for (std::size_t i = 0; i < NUMBER_OF_UNITS; i++) {
+			units.push_back(ensys.add(UnitType(NameType(names[i % NUMBER_OF_NAMES]), ConfigType(int(i % NUMBER_OF_CONFIGS)))));
+		}
+	});
+
+	std::size_t sum = 0;
+	const double get_ms = measure([&]() {
+		for (const encom::handle<UnitType>& unit : units) {
+			sum += ensys.get(unit)->template get<ConfigType>().difficulty;
+		}
+	});
+
+	const encom::component_stats names_stats = ensys.stats<NameType>();
+	const encom::component_stats configs_stats = ensys.stats<ConfigType>();
+	std::cout << name << " (checksum " << sum << ")" << std::endl;
+	std::cout << "  add:     " << add_ms << " ms" << std::endl;
+	std::cout << "  get:     " << get_ms << " ms" << std::endl;
+	std::cout << "  names:   " << names_stats.live << " live, " << names_stats.allocated_bytes / 1024 << " KiB" << std::endl;
+	std::cout << "  configs: " << configs_stats.live << " live, " << configs_stats.allocated_bytes / 1024 << " KiB" << std::endl;
+}
+
+int main() {
+	ensys ensys;
+	std::cout << "units=" << NUMBER_OF_UNITS << " configs=" << NUMBER_OF_CONFIGS << " names=" << NUMBER_OF_NAMES << std::endl;
+	run<unit_relation, name_t, config_t>(ensys, "plain childs");
+	run<shared_unit_relation, shared_name_t, shared_config_t>(ensys, "deduplicated childs");
+	std::cout << "string arena: " << encom::string_arena::instance().allocated_bytes() / 1024 << " KiB" << std::endl;
+}
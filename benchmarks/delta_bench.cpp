@@ -0,0 +1,92 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#include "delta.hpp"
+
+/*
+ * Changes a few positions of 1M entities per tick and replicates them into a second encomsys. Compares
+ * exporting and applying a delta with the previous approach of diffing the position storage against a
+ * copy from the last tick.
+ */
+
+constexpr std::size_t NUMBER_OF_ENTITIES = 1000000;
+constexpr std::size_t NUMBER_OF_TICKS = 20;
+constexpr std::size_t CHANGES_PER_TICK[] = {100, 10000};
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x, const float y) : x(x), y(y) {}
+
+	float x;
+	float y;
+};
+
+template<> struct encom::track_changes<position_t> : std::true_type {};
+
+using ensys = encom::encomsys<position_t>;
+using ensys_delta = encom::delta<ensys>;
+
+template<typename Func>
+double measure(Func func) {
+	const auto start = std::chrono::steady_clock::now();
+	func();
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+int main() {
+	for (const std::size_t changes_per_tick : CHANGES_PER_TICK) {
+		ensys source;
+		std::vector<encom::handle<position_t>> handles;
+		source.add_n(position_t(0.f, 0.f), NUMBER_OF_ENTITIES, std::back_inserter(handles));
+
+		ensys replica;
+		ensys_delta(source, 0).apply(replica);
+		encom::ID_TYPE last_tick = source.advance_tick();
+		source.discard_changes_before(last_tick);
+
+		const auto& positions = source.get_components<position_t>();
+		std::vector<encom::component_wrapper<position_t>> copy;
+		for (const encom::component_wrapper<position_t>& wrapper : positions) {
+			copy.push_back(wrapper);
+		}
+
+		std::size_t number_of_delta_changes = 0;
+		std::size_t number_of_diff_changes = 0;
+		double delta_ms = 0.0;
+		double diff_ms = 0.0;
+		std::size_t next = 0;
+		for (std::size_t tick = 0; tick < NUMBER_OF_TICKS; tick++) {
+			for (std::size_t i = 0; i < changes_per_tick; i++) {
+				next = (next + 7919) % NUMBER_OF_ENTITIES;
+				source.get_ref(handles[next])->x += 1.f;
+			}
+
+			delta_ms += measure([&]() {
+				ensys_delta changes(source, last_tick);
+				last_tick = source.advance_tick();
+				source.discard_changes_before(last_tick);
+				changes.apply(replica);
+				number_of_delta_changes += changes.size();
+			});
+
+			diff_ms += measure([&]() {
+				std::size_t index = 0;
+				for (auto iter = positions.begin(); iter != positions.end(); ++iter, ++index) {
+					if (std::memcmp(&copy[index].value, &(*iter).value, sizeof(position_t)) != 0) {
+						copy[index] = *iter;
+						number_of_diff_changes++;
+					}
+				}
+			});
+		}
+
+		std::cout << "entities=" << NUMBER_OF_ENTITIES << " changes per tick=" << changes_per_tick << " ticks=" << NUMBER_OF_TICKS
+			<< " (changes: delta " << number_of_delta_changes << ", diff " << number_of_diff_changes << ")" << std::endl;
+		std::cout << "  delta export + apply: " << delta_ms << " ms" << std::endl;
+		std::cout << "  diff against copy:    " << diff_ms << " ms (" << diff_ms / delta_ms << "x)" << std::endl;
+	}
+}
@@ -0,0 +1,119 @@
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "encomsys.hpp"
+
+/*
+ * Integrates 1M positions for a number of ticks with hand-written loops over a std::vector of plain
+ * positions and of component wrappers, which have the layout of the slots in the encomsys, and with
+ * for_each() and a lambda over an index_vector and a dense storage. The same lambda behind a
+ * std::function shows the cost of an indirect call per component. A search with early exit stops in
+ * the middle of the storage.
+ */
+
+constexpr std::size_t NUMBER_OF_POSITIONS = 1000000;
+constexpr std::size_t NUMBER_OF_TICKS = 50;
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x, const float velocity) : x(x), velocity(velocity) {}
+
+	float x;
+	float velocity;
+};
+
+struct dense_position_t : position_t {
+	using position_t::position_t;
+};
+
+template<>
+struct encom::component_storage<dense_position_t> : encom::dense_storage {};
+
+using ensys = encom::encomsys<position_t, dense_position_t>;
+
+template<typename Func>
+double measure(Func func) {
+	const auto start = std::chrono::steady_clock::now();
+	func();
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+/**
+ * Measures every tick on its own, so the compiler can not merge the loops of consecutive ticks.
+ */
+template<typename Func>
+double measure_ticks(Func func) {
+	double ms = 0.0;
+	for (std::size_t tick = 0; tick < NUMBER_OF_TICKS; tick++) {
+		ms += measure(func);
+	}
+	return ms;
+}
+
+int main() {
+	ensys ensys;
+	std::vector<position_t> vector;
+	std::vector<encom::component_wrapper<position_t>> wrappers;
+	vector.reserve(NUMBER_OF_POSITIONS);
+	wrappers.reserve(NUMBER_OF_POSITIONS);
+	ensys.reserve<position_t>(NUMBER_OF_POSITIONS);
+	ensys.reserve<dense_position_t>(NUMBER_OF_POSITIONS);
+	for (std::size_t i = 0; i < NUMBER_OF_POSITIONS; i++) {
+		vector.emplace_back(float(i), 0.5f);
+		wrappers.emplace_back(0, 0, position_t(float(i), 0.5f));
+		ensys.add(position_t(float(i), 0.5f));
+		ensys.add(dense_position_t(float(i), 0.5f));
+	}
+
+	const auto integrate = [](position_t& position) {
+		position.x += position.velocity;
+	};
+
+	const double vector_ms = measure_ticks([&]() {
+		for (position_t& position : vector) {
+			position.x += position.velocity;
+		}
+	});
+
+	const double wrappers_ms = measure_ticks([&]() {
+		for (encom::component_wrapper<position_t>& wrapper : wrappers) {
+			wrapper.value.x += wrapper.value.velocity;
+		}
+	});
+
+	const double lambda_ms = measure_ticks([&]() {
+		ensys.for_each<position_t>(integrate);
+	});
+
+	const double dense_ms = measure_ticks([&]() {
+		ensys.for_each<dense_position_t>(integrate);
+	});
+
+	const std::function<void(position_t&)> indirect = integrate;
+	const double function_ms = measure_ticks([&]() {
+		ensys.for_each<position_t>(indirect);
+	});
+
+	// the search stops at the position in the middle
+	const float middle = float(NUMBER_OF_POSITIONS / 2) + NUMBER_OF_TICKS * 2 * 0.5f;
+	std::size_t visited = 0;
+	const double search_ms = measure_ticks([&]() {
+		ensys.for_each<position_t>([&visited, middle](const position_t& position) {
+			visited++;
+			return position.x != middle;
+		});
+	});
+
+	float checksum = 0.f;
+	ensys.for_each<position_t>([&checksum](const position_t& position) { checksum += position.x; });
+	std::cout << "positions=" << NUMBER_OF_POSITIONS << " ticks=" << NUMBER_OF_TICKS << " (checksum " << checksum << " " << vector.back().x << ")" << std::endl;
+	std::cout << "std::vector loop:        " << vector_ms << " ms" << std::endl;
+	std::cout << "std::vector of wrappers: " << wrappers_ms << " ms" << std::endl;
+	std::cout << "for_each lambda:         " << lambda_ms << " ms (" << lambda_ms / wrappers_ms << "x of wrappers)" << std::endl;
+	std::cout << "for_each lambda, dense:  " << dense_ms << " ms (" << dense_ms / wrappers_ms << "x of wrappers)" << std::endl;
+	std::cout << "for_each std::function:  " << function_ms << " ms (" << function_ms / wrappers_ms << "x of wrappers)" << std::endl;
+	std::cout << "early exit at half:      " << search_ms << " ms (" << visited / NUMBER_OF_TICKS << " visited per tick)" << std::endl;
+}
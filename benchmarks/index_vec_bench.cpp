@@ -0,0 +1,60 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <util/index_vector.hpp>
+
+/*
+ * Iterates over index_vectors, that had the same number of elements, but a different number of elements removed.
+ * The time per iteration should grow with the number of live elements and not with the number of holes.
+ */
+
+constexpr std::size_t NUMBER_OF_SLOTS = 1000000;
+constexpr int ITERATIONS = 20;
+
+double iterate(const encom::index_vector<std::uint64_t>& vec) {
+	std::uint64_t sum = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < ITERATIONS; i++) {
+		for (std::uint64_t v : vec) {
+			sum += v;
+		}
+	}
+	const auto stop = std::chrono::steady_clock::now();
+	// keep the sum alive
+	if (sum == 42) {
+		std::cout << "";
+	}
+	return std::chrono::duration<double, std::micro>(stop - start).count() / ITERATIONS;
+}
+
+int main() {
+	std::mt19937_64 rng(1234);
+
+	std::cout << "slots=" << NUMBER_OF_SLOTS << std::endl;
+	std::cout << "removed%\tlive\titerate_us\tns_per_live" << std::endl;
+
+	for (int removed_percent : {0, 50, 90, 99, 100}) {
+		encom::index_vector<std::uint64_t> vec;
+		for (std::size_t i = 0; i < NUMBER_OF_SLOTS; i++) {
+			vec.add(i);
+		}
+
+		std::vector<encom::ID_TYPE> indices(NUMBER_OF_SLOTS);
+		for (std::size_t i = 0; i < NUMBER_OF_SLOTS; i++) {
+			indices[i] = i;
+		}
+		std::shuffle(indices.begin(), indices.end(), rng);
+		const std::size_t number_to_remove = NUMBER_OF_SLOTS * removed_percent / 100;
+		for (std::size_t i = 0; i < number_to_remove; i++) {
+			vec.remove(indices[i]);
+		}
+
+		const double us = iterate(vec);
+		const double ns_per_live = vec.size() ? us * 1000.0 / vec.size() : 0.0;
+		std::cout << removed_percent << "\t" << vec.size() << "\t" << us << "\t" << ns_per_live << std::endl;
+	}
+}
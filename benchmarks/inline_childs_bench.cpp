@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "encomsys.hpp"
+
+/*
+ * Reads and writes 100k relations of a position and a velocity for a number of ticks through get(),
+ * get_ref() and query(), once with the childs stored in their own storages and referenced by handles
+ * and once with the childs stored inline in the slots of the relations. The relations are read in
+ * random order.
+ */
+
+constexpr std::size_t NUMBER_OF_UNITS = 100000;
+constexpr std::size_t NUMBER_OF_TICKS = 20;
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x, const float y) : x(x), y(y) {}
+
+	float x;
+	float y;
+};
+
+struct velocity_t {
+	velocity_t() = default;
+	velocity_t(const float x, const float y) : x(x), y(y) {}
+
+	float x;
+	float y;
+};
+
+struct handle_unit_relation : encom::relation<position_t, velocity_t> {
+	using encom::relation<position_t, velocity_t>::relation;
+};
+
+struct inline_unit_relation : encom::relation<position_t, velocity_t> {
+	using encom::relation<position_t, velocity_t>::relation;
+};
+
+template<> struct encom::inline_childs<inline_unit_relation> : std::true_type {};
+
+using ensys = encom::encomsys<handle_unit_relation, inline_unit_relation, position_t, velocity_t>;
+
+template<typename Func>
+double measure(Func func) {
+	const auto start = std::chrono::steady_clock::now();
+	func();
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+template<typename UnitType>
+void run(ensys& ensys, const char* name) {
+	std::vector<encom::handle<UnitType>> units;
+	for (std::size_t i = 0; i < NUMBER_OF_UNITS; i++) {
+		units.push_back(ensys.add(UnitType(position_t(float(i), 0.f), velocity_t(1.f, 1.f))));
+	}
+	std::shuffle(units.begin(), units.end(), std::mt19937(42));
+
+	float sum = 0.f;
+	const double get_ms = measure([&]() {
+		for (std::size_t tick = 0; tick < NUMBER_OF_TICKS; tick++) {
+			for (const encom::handle<UnitType>& unit : units) {
+				sum += ensys.get(unit)->template get<position_t>().x;
+			}
+		}
+	});
+
+	const double get_ref_ms = measure([&]() {
+		for (std::size_t tick = 0; tick < NUMBER_OF_TICKS; tick++) {
+			for (const encom::handle<UnitType>& unit : units) {
+				typename UnitType::as_ref ref = *ensys.get_ref(unit);
+				ref.template get<position_t>().x += ref.template get<velocity_t>().x;
+			}
+		}
+	});
+
+	const double query_ms = measure([&]() {
+		for (std::size_t tick = 0; tick < NUMBER_OF_TICKS; tick++) {
+			ensys.template query<UnitType>([](const typename UnitType::as_ref& unit) {
+				unit.template get<position_t>().y += unit.template get<velocity_t>().y;
+			});
+		}
+	});
+
+	std::cout << name << " (checksum " << sum << ")" << std::endl;
+	std::cout << "  get:     " << get_ms << " ms" << std::endl;
+	std::cout << "  get_ref: " << get_ref_ms << " ms" << std::endl;
+	std::cout << "  query:   " << query_ms << " ms" << std::endl;
+}
+
+int main() {
+	ensys ensys;
+	std::cout << "units=" << NUMBER_OF_UNITS << " ticks=" << NUMBER_OF_TICKS << std::endl;
+	run<handle_unit_relation>(ensys, "childs by handle");
+	run<inline_unit_relation>(ensys, "inline childs");
+}
@@ -0,0 +1,54 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+#include "encomsys.hpp"
+
+/*
+ * Measures parallel_for_each over 1M components with 1 to N worker threads.
+ */
+
+constexpr std::size_t NUMBER_OF_ENTITIES = 1000000;
+constexpr int ITERATIONS = 10;
+
+struct body_t {
+	float x, v;
+};
+
+using ensys = encom::encomsys<body_t>;
+
+int main() {
+	ensys ensys;
+	std::vector<encom::handle<body_t>> handles;
+	for (std::size_t i = 0; i < NUMBER_OF_ENTITIES; i++) {
+		handles.push_back(ensys.add(body_t {static_cast<float>(i), 1.f}));
+	}
+	// holes make the chunks uneven
+	for (std::size_t i = 0; i < NUMBER_OF_ENTITIES / 2; i += 7) {
+		ensys.remove(handles[i]);
+	}
+
+	const std::size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+	std::cout << "entities=" << ensys.get_components<body_t>().size() << std::endl;
+	std::cout << "threads\tms\tspeedup" << std::endl;
+
+	double single_thread_ms = 0.0;
+	for (std::size_t threads = 1; threads <= max_threads; threads++) {
+		encom::thread_pool pool(threads);
+		ensys.attach_thread_pool(pool);
+
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < ITERATIONS; i++) {
+			ensys.parallel_for_each<body_t>([](body_t& body) {
+				body.x = std::sqrt(body.x * body.x + body.v);
+			});
+		}
+		const auto stop = std::chrono::steady_clock::now();
+		const double ms = std::chrono::duration<double, std::milli>(stop - start).count() / ITERATIONS;
+		if (threads == 1) {
+			single_thread_ms = ms;
+		}
+		std::cout << threads << "\t" << ms << "\t" << single_thread_ms / ms << std::endl;
+	}
+}
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "encomsys.hpp"
+
+/*
+ * Despawns 100k admin players in random order one by one with remove(), at once with remove_bulk()
+ * and all of them with clear().
+ */
+
+constexpr std::size_t NUMBER_OF_ADMINS = 100000;
+
+struct player_name_t {
+	player_name_t() = default;
+	player_name_t(const std::string& name) : name(name) {}
+
+	std::string name;
+};
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x) : x(x) {}
+
+	float x;
+};
+
+struct password_component {
+	std::string passwd;
+
+	password_component() = default;
+	password_component(const std::string& pw) : passwd(pw) {}
+};
+
+struct player_relation : encom::relation<player_name_t, position_t> {
+	using encom::relation<player_name_t, position_t>::relation;
+};
+
+struct admin_player_relation : encom::relation<player_relation, password_component> {
+	using encom::relation<player_relation, password_component>::relation;
+
+	admin_player_relation() {}
+};
+
+using ensys = encom::encomsys<admin_player_relation, player_relation, player_name_t, position_t, password_component>;
+
+template<typename Func>
+double measure(Func func) {
+	const auto start = std::chrono::steady_clock::now();
+	func();
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+void fill(ensys& ensys, std::vector<encom::handle<admin_player_relation>>* handles) {
+	const admin_player_relation admin(player_relation("admin", position_t(1.f)), password_component("password"));
+	handles->clear();
+	ensys.add_n(admin, NUMBER_OF_ADMINS, std::back_inserter(*handles));
+	std::shuffle(handles->begin(), handles->end(), std::mt19937(42));
+}
+
+int main() {
+	std::vector<encom::handle<admin_player_relation>> handles;
+
+	ensys single;
+	fill(single, &handles);
+	const double single_ms = measure([&]() {
+		for (const encom::handle<admin_player_relation>& handle : handles) {
+			single.remove(handle);
+		}
+	});
+
+	ensys bulk;
+	fill(bulk, &handles);
+	const double bulk_ms = measure([&]() {
+		bulk.remove_bulk<admin_player_relation>(handles.begin(), handles.end());
+	});
+
+	ensys cleared;
+	fill(cleared, &handles);
+	const double clear_ms = measure([&]() {
+		cleared.clear<admin_player_relation>();
+	});
+
+	std::cout << "admins=" << NUMBER_OF_ADMINS << std::endl;
+	std::cout << "remove:      " << single_ms << " ms" << std::endl;
+	std::cout << "remove_bulk: " << bulk_ms << " ms (" << single_ms / bulk_ms << "x)" << std::endl;
+	std::cout << "clear:       " << clear_ms << " ms (" << single_ms / clear_ms << "x)" << std::endl;
+}
@@ -0,0 +1,125 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "encomsys.hpp"
+
+/*
+ * Finds players by name among 200k players. Compares a lookup in the secondary index with the
+ * previous approach of scanning the names linearly and then scanning the players for the relation,
+ * that owns the found name. The cost of keeping the index up to date is measured by adding and
+ * removing the players with and without index.
+ */
+
+constexpr std::size_t NUMBER_OF_PLAYERS = 200000;
+constexpr std::size_t NUMBER_OF_LOOKUPS = 1000;
+
+struct player_name_t {
+	player_name_t() = default;
+	player_name_t(const std::string& name) : name(name) {}
+
+	std::string name;
+};
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x, const float y) : x(x), y(y) {}
+
+	float x;
+	float y;
+};
+
+struct player_relation : encom::relation<player_name_t, position_t> {
+	using encom::relation<player_name_t, position_t>::relation;
+};
+
+struct indexed_player_relation : encom::relation<player_name_t, position_t> {
+	using encom::relation<player_name_t, position_t>::relation;
+};
+
+template<> struct encom::secondary_index<indexed_player_relation> : encom::unique_key<&player_name_t::name> {};
+
+using ensys = encom::encomsys<player_relation, indexed_player_relation, player_name_t, position_t>;
+
+template<typename Func>
+double measure(Func func) {
+	const auto start = std::chrono::steady_clock::now();
+	func();
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+std::string player_name(const std::size_t i) {
+	return "player" + std::to_string(i);
+}
+
+template<typename RelationType>
+std::vector<encom::handle<RelationType>> add_players(ensys& ensys) {
+	std::vector<encom::handle<RelationType>> players;
+	players.reserve(NUMBER_OF_PLAYERS);
+	for (std::size_t i = 0; i < NUMBER_OF_PLAYERS; i++) {
+		players.push_back(ensys.add(RelationType(player_name(i), position_t(float(i), 0.f))));
+	}
+	return players;
+}
+
+int main() {
+	ensys ensys;
+	std::vector<encom::handle<player_relation>> players;
+	std::vector<encom::handle<indexed_player_relation>> indexed_players;
+	const double add_ms = measure([&]() { players = add_players<player_relation>(ensys); });
+	const double indexed_add_ms = measure([&]() { indexed_players = add_players<indexed_player_relation>(ensys); });
+
+	std::vector<std::string> names;
+	for (std::size_t i = 0; i < NUMBER_OF_LOOKUPS; i++) {
+		names.push_back(player_name((i * 7919) % NUMBER_OF_PLAYERS));
+	}
+
+	float scan_sum = 0.f;
+	const double scan_ms = measure([&]() {
+		const auto& name_storage = ensys.get_components<player_name_t>();
+		const auto& player_storage = ensys.get_components<player_relation>();
+		for (const std::string& name : names) {
+			encom::ID_TYPE name_index = 0;
+			for (auto iter = name_storage.begin(); iter != name_storage.end(); ++iter) {
+				if ((*iter).value.name == name) {
+					name_index = iter.index();
+					break;
+				}
+			}
+			for (auto iter = player_storage.begin(); iter != player_storage.end(); ++iter) {
+				if (std::get<encom::handle<player_name_t>>((*iter)._handles).array_index == name_index) {
+					scan_sum += ensys.__resolve_unchecked(encom::handle<player_relation>((*iter).consecutive_index, iter.index())).get<position_t>().x;
+					break;
+				}
+			}
+		}
+	});
+
+	float lookup_sum = 0.f;
+	const double lookup_ms = measure([&]() {
+		for (const std::string& name : names) {
+			lookup_sum += ensys.get_ref(*ensys.lookup<indexed_player_relation>(name))->get<position_t>().x;
+		}
+	});
+
+	const double remove_ms = measure([&]() {
+		for (const encom::handle<player_relation>& player : players) {
+			ensys.remove(player);
+		}
+	});
+	const double indexed_remove_ms = measure([&]() {
+		for (const encom::handle<indexed_player_relation>& player : indexed_players) {
+			ensys.remove(player);
+		}
+	});
+
+	std::cout << "players=" << NUMBER_OF_PLAYERS << " lookups=" << NUMBER_OF_LOOKUPS
+		<< " (checksum " << (scan_sum == lookup_sum ? "equal" : "different") << ")" << std::endl;
+	std::cout << "  linear scan:  " << scan_ms << " ms (" << scan_ms * 1000000.0 / NUMBER_OF_LOOKUPS << " ns per lookup)" << std::endl;
+	std::cout << "  index lookup: " << lookup_ms << " ms (" << lookup_ms * 1000000.0 / NUMBER_OF_LOOKUPS << " ns per lookup, "
+		<< scan_ms / lookup_ms << "x)" << std::endl;
+	std::cout << "  add without index:    " << add_ms << " ms, with index: " << indexed_add_ms << " ms" << std::endl;
+	std::cout << "  remove without index: " << remove_ms << " ms, with index: " << indexed_remove_ms << " ms" << std::endl;
+}
@@ -0,0 +1,88 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#include "encomsys.hpp"
+
+/*
+ * Saves 1M moving entities into a snapshot and compares loading the snapshot with building the same
+ * encomsys by add_n(). Loading maps the file, so the first pass over the loaded entities pays the page
+ * faults, that building pays while writing.
+ */
+
+constexpr std::size_t NUMBER_OF_ENTITIES = 1000000;
+const char* const SNAPSHOT_PATH = "snapshot_bench.bin";
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x, const float y) : x(x), y(y) {}
+
+	float x;
+	float y;
+};
+
+struct velocity_t {
+	velocity_t() = default;
+	velocity_t(const float dx, const float dy) : dx(dx), dy(dy) {}
+
+	float dx;
+	float dy;
+};
+
+struct moving_relation : encom::relation<position_t, velocity_t> {
+	using encom::relation<position_t, velocity_t>::relation;
+};
+
+using ensys = encom::encomsys<moving_relation, position_t, velocity_t>;
+
+template<typename Func>
+double measure(Func func) {
+	const auto start = std::chrono::steady_clock::now();
+	func();
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+float move_all(ensys& ensys) {
+	float sum = 0.f;
+	ensys.query<moving_relation>([&sum](const moving_relation::as_ref& entity) {
+		position_t& position = entity.get<position_t>();
+		const velocity_t& velocity = entity.get<velocity_t>();
+		position.x += velocity.dx;
+		position.y += velocity.dy;
+		sum += position.x;
+	});
+	return sum;
+}
+
+int main() {
+	float sum = 0.f;
+	const moving_relation entity(position_t(1.f, 2.f), velocity_t(0.5f, 0.25f));
+
+	ensys built;
+	std::vector<encom::handle<moving_relation>> handles;
+	const double build_ms = measure([&]() {
+		built.add_n(entity, NUMBER_OF_ENTITIES, std::back_inserter(handles));
+	});
+	const double built_pass_ms = measure([&]() { sum += move_all(built); });
+
+	const double save_ms = measure([&]() { built.save(SNAPSHOT_PATH); });
+
+	ensys loaded;
+	const double load_ms = measure([&]() { loaded.load(SNAPSHOT_PATH); });
+	const double first_pass_ms = measure([&]() { sum += move_all(loaded); });
+	const double second_pass_ms = measure([&]() { sum += move_all(loaded); });
+	std::remove(SNAPSHOT_PATH);
+
+	std::cout << "entities=" << NUMBER_OF_ENTITIES << " (checksum " << sum << ")" << std::endl;
+	std::cout << "add_n:                  " << build_ms << " ms" << std::endl;
+	std::cout << "pass after add_n:       " << built_pass_ms << " ms" << std::endl;
+	std::cout << "save:                   " << save_ms << " ms" << std::endl;
+	std::cout << "load:                   " << load_ms << " ms" << std::endl;
+	std::cout << "first pass after load:  " << first_pass_ms << " ms" << std::endl;
+	std::cout << "second pass after load: " << second_pass_ms << " ms" << std::endl;
+	std::cout << "load + first pass:      " << load_ms + first_pass_ms << " ms ("
+		<< (build_ms + built_pass_ms) / (load_ms + first_pass_ms) << "x faster than add_n + pass)" << std::endl;
+}
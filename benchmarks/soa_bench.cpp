@@ -0,0 +1,101 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "encomsys.hpp"
+
+/*
+ * Integrates 1M positions with their velocities. Compares the interleaved index_vector layout, that is
+ * iterated with for_each, to the structure-of-arrays layout, that is updated with batch_update.
+ */
+
+constexpr std::size_t NUMBER_OF_ENTITIES = 1000000;
+constexpr int ITERATIONS = 50;
+constexpr float DT = 0.016f;
+
+struct aos_body_t {
+	float x, y, z;
+	float vx, vy, vz;
+};
+
+struct soa_body_t {
+	float x, y, z;
+	float vx, vy, vz;
+};
+
+template<>
+struct encom::soa_layout<soa_body_t> {
+	using fields = encom::soa_fields<
+		&soa_body_t::x, &soa_body_t::y, &soa_body_t::z,
+		&soa_body_t::vx, &soa_body_t::vy, &soa_body_t::vz
+	>;
+};
+
+using ensys = encom::encomsys<aos_body_t, soa_body_t>;
+
+void integrate(aos_body_t& body) {
+	body.x += body.vx * DT;
+	body.y += body.vy * DT;
+	body.z += body.vz * DT;
+}
+
+void integrate_columns(std::size_t count, float* __restrict x, float* __restrict y, float* __restrict z,
+					   float* __restrict vx, float* __restrict vy, float* __restrict vz) {
+	for (std::size_t i = 0; i < count; i++) {
+		x[i] += vx[i] * DT;
+		y[i] += vy[i] * DT;
+		z[i] += vz[i] * DT;
+	}
+}
+
+#ifdef __AVX2__
+void integrate_column_avx2(std::size_t count, float* p, const float* v) {
+	const __m256 dt = _mm256_set1_ps(DT);
+	std::size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		_mm256_store_ps(p + i, _mm256_fmadd_ps(_mm256_load_ps(v + i), dt, _mm256_load_ps(p + i)));
+	}
+	for (; i < count; i++) {
+		p[i] += v[i] * DT;
+	}
+}
+
+void integrate_columns_avx2(std::size_t count, float* x, float* y, float* z, float* vx, float* vy, float* vz) {
+	integrate_column_avx2(count, x, vx);
+	integrate_column_avx2(count, y, vy);
+	integrate_column_avx2(count, z, vz);
+}
+#endif
+
+template<typename Func>
+double measure(Func func) {
+	const auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < ITERATIONS; i++) {
+		func();
+	}
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count() / ITERATIONS;
+}
+
+int main() {
+	ensys ensys;
+	for (std::size_t i = 0; i < NUMBER_OF_ENTITIES; i++) {
+		const float f = static_cast<float>(i);
+		ensys.add(aos_body_t {f, f, f, 1.f, 2.f, 3.f});
+		ensys.add(soa_body_t {f, f, f, 1.f, 2.f, 3.f});
+	}
+
+	const double aos_ms = measure([&]() { ensys.for_each<aos_body_t>(integrate); });
+	const double soa_ms = measure([&]() { ensys.batch_update<soa_body_t>(integrate_columns); });
+
+	std::cout << "entities=" << NUMBER_OF_ENTITIES << std::endl;
+	std::cout << "aos for_each:        " << aos_ms << " ms" << std::endl;
+	std::cout << "soa batch_update:    " << soa_ms << " ms (" << aos_ms / soa_ms << "x)" << std::endl;
+#ifdef __AVX2__
+	const double avx2_ms = measure([&]() { ensys.batch_update<soa_body_t>(integrate_columns_avx2); });
+	std::cout << "soa batch_update avx2: " << avx2_ms << " ms (" << aos_ms / avx2_ms << "x)" << std::endl;
+#endif
+}
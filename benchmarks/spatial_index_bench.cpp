@@ -0,0 +1,129 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "encomsys.hpp"
+
+/*
+ * Measures the throughput of the spatial index with 100k and 1M entities spread over a square with
+ * about 4 entities per 16x16 area. Every tick moves all entities a little and queries the entities
+ * within the interest radius of some of them. Radius queries are compared with a scan over all
+ * positions.
+ */
+
+constexpr std::size_t NUMBER_OF_ENTITIES[] = {100000, 1000000};
+constexpr std::size_t NUMBER_OF_QUERIES = 10000;
+constexpr std::size_t NUMBER_OF_SCANS = 20;
+constexpr std::size_t NEAREST = 8;
+constexpr float RADIUS = 16.f;
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x, const float y) : x(x), y(y) {}
+
+	float x;
+	float y;
+};
+
+template<> struct encom::spatial_index<position_t> : encom::uniform_grid<&position_t::x, &position_t::y> {
+	static constexpr float cell_size = RADIUS;
+};
+
+using ensys = encom::encomsys<position_t>;
+
+template<typename Func>
+double measure(Func func) {
+	const auto start = std::chrono::steady_clock::now();
+	func();
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+int main() {
+	for (const std::size_t number_of_entities : NUMBER_OF_ENTITIES) {
+		const float world_size = std::sqrt(float(number_of_entities) / 4.f) * 16.f;
+		std::mt19937 rng(42);
+		std::uniform_real_distribution<float> coordinate(0.f, world_size);
+		std::uniform_real_distribution<float> step(-1.f, 1.f);
+
+		ensys ensys;
+		std::vector<encom::handle<position_t>> handles;
+		handles.reserve(number_of_entities);
+		const double add_ms = measure([&]() {
+			for (std::size_t i = 0; i < number_of_entities; i++) {
+				handles.push_back(ensys.add(position_t(coordinate(rng), coordinate(rng))));
+			}
+		});
+
+		const double move_ms = measure([&]() {
+			for (const encom::handle<position_t>& h : handles) {
+				const float dx = step(rng);
+				const float dy = step(rng);
+				ensys.modify(h, [dx, dy](position_t& p) { p.x += dx; p.y += dy; });
+			}
+		});
+
+		std::vector<position_t> centers;
+		for (std::size_t i = 0; i < NUMBER_OF_QUERIES; i++) {
+			centers.push_back(*ensys.get(handles[(i * 7919) % number_of_entities]));
+		}
+
+		std::size_t radius_found = 0;
+		std::vector<encom::handle<position_t>> result;
+		const double radius_ms = measure([&]() {
+			for (const position_t& center : centers) {
+				result.clear();
+				ensys.query_radius(center, RADIUS, std::back_inserter(result));
+				radius_found += result.size();
+			}
+		});
+
+		std::size_t box_found = 0;
+		const double box_ms = measure([&]() {
+			for (const position_t& center : centers) {
+				result.clear();
+				ensys.query_box(position_t(center.x - RADIUS, center.y - RADIUS), position_t(center.x + RADIUS, center.y + RADIUS), std::back_inserter(result));
+				box_found += result.size();
+			}
+		});
+
+		std::size_t nearest_found = 0;
+		const double nearest_ms = measure([&]() {
+			for (const position_t& center : centers) {
+				result.clear();
+				ensys.query_nearest(center, NEAREST, std::back_inserter(result));
+				nearest_found += result.size();
+			}
+		});
+
+		std::size_t scan_found = 0;
+		const double scan_ms = measure([&]() {
+			const auto& positions = ensys.get_components<position_t>();
+			for (std::size_t i = 0; i < NUMBER_OF_SCANS; i++) {
+				const position_t& center = centers[i];
+				for (auto iter = positions.begin(); iter != positions.end(); ++iter) {
+					const float dx = (*iter).value.x - center.x;
+					const float dy = (*iter).value.y - center.y;
+					if (dx * dx + dy * dy <= RADIUS * RADIUS) {
+						scan_found++;
+					}
+				}
+			}
+		});
+
+		const double radius_ns = radius_ms * 1000000.0 / NUMBER_OF_QUERIES;
+		const double scan_ns = scan_ms * 1000000.0 / NUMBER_OF_SCANS;
+		std::cout << "entities=" << number_of_entities << " radius=" << RADIUS << " (avg " << double(radius_found) / NUMBER_OF_QUERIES
+			<< " in radius, " << double(box_found) / NUMBER_OF_QUERIES << " in box, " << nearest_found << " nearest, "
+			<< scan_found << " scanned)" << std::endl;
+		std::cout << "  add:            " << add_ms * 1000000.0 / number_of_entities << " ns per entity" << std::endl;
+		std::cout << "  move:           " << move_ms * 1000000.0 / number_of_entities << " ns per entity" << std::endl;
+		std::cout << "  radius query:   " << radius_ns << " ns" << std::endl;
+		std::cout << "  box query:      " << box_ms * 1000000.0 / NUMBER_OF_QUERIES << " ns" << std::endl;
+		std::cout << "  nearest " << NEAREST << ":      " << nearest_ms * 1000000.0 / NUMBER_OF_QUERIES << " ns" << std::endl;
+		std::cout << "  radius by scan: " << scan_ns << " ns (" << scan_ns / radius_ns << "x)" << std::endl;
+	}
+}
@@ -0,0 +1,141 @@
+#ifndef __ACCESS_PATH_CLASS__
+#define __ACCESS_PATH_CLASS__
+
+#include <tuple>
+#include <type_traits>
+#include "util/types.hpp"
+#include "handle.hpp"
+#include "relation.hpp"
+
+namespace encom {
+	/**
+	 * Whether T is one of Ts...
+	 */
+	template<typename T, typename ...Ts>
+	constexpr bool __contains_type_v = (std::is_same_v<T, Ts> || ...);
+
+	template<typename RelationType, typename ChildType>
+	struct __is_child_of : std::false_type {};
+
+	template<typename ...RelationComponentTypes, typename ChildType>
+	struct __is_child_of<std::tuple<RelationComponentTypes...>, ChildType>
+		: std::bool_constant<__contains_type_v<ChildType, RelationComponentTypes...>> {};
+
+	/**
+	 * A cached lookup of a component, that is nested in a relation, e.g.
+	 *
+	 *   encom::access_path<ensys, admin_player_relation, player_relation, position_t> path(admin);
+	 *   position_t* position = path.get(ensys);
+	 *
+	 * resolves admin -> player_relation -> position_t. The chain of handles is walked once with a
+	 * sequence of unchecked storage lookups, that is unrolled at compile time. The resulting pointer is
+	 * cached together with the epochs (see encomsys::epoch()) of all storages on the path. Later calls
+	 * only compare the epochs and dereference the cached pointer, until a component of a type on the
+	 * path is added or removed. Deduplicated components (see deduplicate) are accessed by const pointer,
+	 * because their slot can be shared.
+	 *
+	 * @tparam Encomsys The encomsys type
+	 * @tparam RootType The relation, that the path starts at
+	 * @tparam PathTypes Each type is a direct child of the type before it. The last type is the
+	 * 		   component, that is accessed. It must not be a relation or a structure-of-arrays component.
+	 */
+	template<typename Encomsys, typename RootType, typename ...PathTypes>
+	class access_path {
+		private:
+			static_assert(sizeof...(PathTypes) > 0, "An access path needs at least one child type");
+
+			using leaf_type = std::tuple_element_t<sizeof...(PathTypes) - 1, std::tuple<PathTypes...>>;
+
+			static_assert(!is_relation_v<leaf_type>, "The last type of an access path has to be a component");
+			static_assert(!is_soa_v<leaf_type>, "Structure-of-arrays components can not be accessed by pointer");
+
+			// like in relation::as_ref deduplicated components are const
+			using pointer_type = std::remove_reference_t<relation_ref_expander_t<leaf_type>>*;
+
+			template<typename Parent, typename Child, typename ...Rest>
+			static constexpr bool valid_path() {
+				if constexpr (!is_relation_v<Parent>) {
+					return false;
+				} else if constexpr (sizeof...(Rest) == 0) {
+					return __is_child_of<typename Parent::__component_types, Child>::value;
+				} else {
+					return __is_child_of<typename Parent::__component_types, Child>::value && valid_path<Child, Rest...>();
+				}
+			}
+
+			static_assert(valid_path<RootType, PathTypes...>(), "Every type of an access path has to be a direct child of the type before it");
+
+			static constexpr ID_TYPE UNRESOLVED = ~ID_TYPE(0);
+
+			handle<RootType> _root;
+			pointer_type _pointer;
+			ID_TYPE _epoch;
+
+			static ID_TYPE current_epoch(const Encomsys& encomsys) {
+				return encomsys.template epoch<RootType>() + (encomsys.template epoch<PathTypes>() + ...);
+			}
+
+			template<typename Current, typename Next, typename ...Rest>
+			static pointer_type descend(Encomsys& encomsys, const handle<Current>& current) {
+				auto& wrapper = encomsys.template get_components<Current>().get_unchecked(current.array_index);
+				if constexpr (is_inline_child_v<Current, Next>) {
+					// inline childs are plain components, so this is the leaf
+					return &std::get<Next>(wrapper._handles);
+				} else {
+					const handle<Next>& next = std::get<handle<Next>>(wrapper._handles);
+					if constexpr (sizeof...(Rest) == 0) {
+						return &encomsys.template get_components<Next>().get_unchecked(next.array_index).value;
+					} else {
+						return descend<Next, Rest...>(encomsys, next);
+					}
+				}
+			}
+
+		public:
+			/**
+			 * @param root The relation, that the path starts at
+			 */
+			explicit access_path(const handle<RootType>& root)
+				: _root(root), _pointer(nullptr), _epoch(UNRESOLVED)
+			{}
+
+			/**
+			 * Resolves the path starting at root without caching. Only the root handle is validated,
+			 * because the childs of a present relation are always present.
+			 *
+			 * @returns a pointer to the accessed component or nullptr, if root is not present
+			 */
+			static pointer_type resolve(Encomsys& encomsys, const handle<RootType>& root) {
+				if (!encomsys.has_element(root)) {
+					return nullptr;
+				}
+				return descend<RootType, PathTypes...>(encomsys, root);
+			}
+
+			/**
+			 * @returns a pointer to the accessed component or nullptr, if the root is not present. The
+			 * 			path is resolved again, if a storage on the path has changed since the last call.
+			 */
+			pointer_type get(Encomsys& encomsys) {
+				const ID_TYPE epoch = current_epoch(encomsys);
+				if (epoch != _epoch) {
+					_pointer = resolve(encomsys, _root);
+					_epoch = epoch;
+				}
+				return _pointer;
+			}
+
+			/**
+			 * Forgets the cached pointer, so the next get() resolves the path again.
+			 */
+			void invalidate() {
+				_epoch = UNRESOLVED;
+			}
+
+			const handle<RootType>& root() const {
+				return _root;
+			}
+	};
+}
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef __CHANGE_LOG_CLASS__
+#define __CHANGE_LOG_CLASS__
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "util/types.hpp"
+
+namespace encom {
+	/**
+	 * Enables change tracking for a component or relation type. Specialize this to record, at which tick
+	 * each slot was last added, written through get_ref() or removed, e.g.
+	 *
+	 *   template<> struct encom::track_changes<position_t> : std::true_type {};
+	 *
+	 * Types without change tracking pay nothing. The childs of a tracked relation have to be tracked
+	 * as well, so a delta (see delta.hpp) contains the childs of every relation it contains.
+	 */
+	template<typename ComponentType, typename __Specialization=void>
+	struct track_changes : std::false_type {};
+
+	template<typename ComponentType>
+	inline constexpr bool track_changes_v = track_changes<ComponentType>::value;
+
+	enum class change_kind : std::uint8_t {
+		added,
+		modified,
+		removed,
+	};
+
+	/**
+	 * Records the changes of the slots of one storage. Every slot has at most one entry per tick, that
+	 * describes the last change of the slot in this tick. The entries are ordered by tick, so the
+	 * changes since a tick are found by a binary search and visiting them costs time in the number of
+	 * changes, not in the number of slots.
+	 */
+	class change_log {
+		private:
+			static constexpr ID_TYPE NO_CHANGE = ~ID_TYPE(0);
+
+			struct change {
+				ID_TYPE tick;
+				ID_TYPE array_index;
+				// the consecutive index of the component, that is in the slot after the change
+				ID_TYPE consecutive_index;
+				bool removed;
+			};
+
+			std::vector<change> _changes;
+			// the position of the last change of every slot in _changes
+			std::vector<ID_TYPE> _last_change;
+			// the tick, at which the component in a slot was added
+			std::vector<ID_TYPE> _added_tick;
+
+		public:
+			/**
+			 * Records a change of the slot at array_index. Changes of the same slot in the same tick are
+			 * merged.
+			 *
+			 * @param tick The current tick. Has to be at least the tick of every recorded change.
+			 * @param array_index The changed slot
+			 * @param consecutive_index The consecutive index of the added, modified or removed component
+			 * @param kind What happened to the slot
+			 */
+			void record(const ID_TYPE tick, const ID_TYPE array_index, const ID_TYPE consecutive_index, const change_kind kind) {
+				if (array_index >= _last_change.size()) {
+					_last_change.resize(array_index + 1, NO_CHANGE);
+					_added_tick.resize(array_index + 1, 0);
+				}
+				if (kind == change_kind::added) {
+					_added_tick[array_index] = tick;
+				}
+				const ID_TYPE last_change = _last_change[array_index];
+				if (last_change != NO_CHANGE && _changes[last_change].tick == tick) {
+					_changes[last_change].consecutive_index = consecutive_index;
+					_changes[last_change].removed = kind == change_kind::removed;
+				} else {
+					_last_change[array_index] = _changes.size();
+					_changes.push_back(change {tick, array_index, consecutive_index, kind == change_kind::removed});
+				}
+			}
+
+			/**
+			 * Calls func(array_index, consecutive_index, kind) for every slot, that changed at or after
+			 * the given tick. kind is added, if the component in the slot was added at or after tick,
+			 * removed, if the slot is empty, and modified otherwise. For removed slots consecutive_index
+			 * is the one of the removed component.
+			 */
+			template<typename Func>
+			void for_each_since(const ID_TYPE tick, Func&& func) const {
+				auto first = std::lower_bound(_changes.begin(), _changes.end(), tick, [](const change& c, const ID_TYPE t) {
+					return c.tick < t;
+				});
+				for (ID_TYPE position = first - _changes.begin(); position < _changes.size(); position++) {
+					const change& c = _changes[position];
+					if (_last_change[c.array_index] != position) {
+						continue;
+					}
+					const change_kind kind = c.removed
+						? change_kind::removed
+						: (_added_tick[c.array_index] >= tick ? change_kind::added : change_kind::modified);
+					func(c.array_index, c.consecutive_index, kind);
+				}
+			}
+
+			/**
+			 * Forgets the changes before the given tick. Afterwards for_each_since() only works for ticks
+			 * at least tick.
+			 */
+			void discard_before(const ID_TYPE tick) {
+				std::vector<change> kept;
+				for (ID_TYPE position = 0; position < _changes.size(); position++) {
+					const change& c = _changes[position];
+					if (_last_change[c.array_index] != position) {
+						continue;
+					}
+					if (c.tick < tick) {
+						_last_change[c.array_index] = NO_CHANGE;
+					} else {
+						_last_change[c.array_index] = kept.size();
+						kept.push_back(c);
+					}
+				}
+				_changes = std::move(kept);
+			}
+
+			/**
+			 * Forgets all changes.
+			 */
+			void clear() {
+				_changes.clear();
+				_last_change.clear();
+				_added_tick.clear();
+			}
+
+			/**
+			 * @returns the number of recorded changes
+			 */
+			std::size_t size() const {
+				return _changes.size();
+			}
+	};
+}
+
+#endif
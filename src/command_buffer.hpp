@@ -0,0 +1,333 @@
+#ifndef __COMMAND_BUFFER_CLASS__
+#define __COMMAND_BUFFER_CLASS__
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "encomsys.hpp"
+
+namespace encom {
+	template<typename Encomsys>
+	class command_buffer;
+
+	/**
+	 * Records adds, removes and component writes for an encomsys, that are applied later in one batch by
+	 * apply(). Use this to change an encomsys while iterating over it, or from systems running on worker
+	 * threads.
+	 *
+	 * Added components get their handles immediately: the handles are reserved in the encomsys and stay
+	 * valid after apply(). Recording never touches the storages, so multiple command buffers can record
+	 * concurrently, as long as nobody adds or removes components directly. All command buffers of an
+	 * encomsys, that recorded adds, have to be applied at the same sync point (see command_queue).
+	 *
+	 * apply() first adds the components, then executes the writes and then the removes, each in
+	 * recording order.
+	 */
+	template<typename ...ComponentTypes>
+	class command_buffer<encomsys<ComponentTypes...>> {
+		private:
+			using encomsys_type = encomsys<ComponentTypes...>;
+
+			template<typename ComponentType>
+			struct pending_add {
+				handle<ComponentType> target;
+				component_wrapper<ComponentType> wrapper;
+			};
+
+			template<typename ComponentType>
+			struct pending_write {
+				handle<ComponentType> target;
+				ComponentType value;
+			};
+
+			encomsys_type* _encomsys;
+			std::tuple<std::vector<pending_add<ComponentTypes>>...> _adds;
+			std::tuple<std::vector<pending_write<ComponentTypes>>...> _writes;
+			std::tuple<std::vector<handle<ComponentTypes>>...> _removes;
+
+			template<typename ComponentType>
+			std::vector<pending_add<ComponentType>>& adds() {
+				return std::get<std::vector<pending_add<ComponentType>>>(_adds);
+			}
+
+			template<typename ComponentType>
+			std::vector<pending_write<ComponentType>>& writes() {
+				return std::get<std::vector<pending_write<ComponentType>>>(_writes);
+			}
+
+			template<typename ComponentType>
+			std::vector<handle<ComponentType>>& removes() {
+				return std::get<std::vector<handle<ComponentType>>>(_removes);
+			}
+
+			/**
+			 * Reserves a handle for the given component or relation and records its add. The childs of
+			 * relations are recorded as separate adds with one reference, inline childs are kept in the
+			 * relation.
+			 */
+			template<typename ComponentType>
+			handle<std::decay_t<ComponentType>> record_add(ComponentType&& component, std::uint32_t number_of_references) {
+				using component_type = std::decay_t<ComponentType>;
+				const handle<component_type> target = _encomsys->template __reserve_handle<component_type>();
+				if constexpr (is_relation_v<component_type>) {
+					constexpr std::size_t number_of_childs = std::tuple_size_v<typename component_type::__component_types>;
+					adds<component_type>().push_back(pending_add<component_type> {
+						target,
+						component_wrapper<component_type>(
+							target.consecutive_index,
+							number_of_references,
+							record_childs(std::forward<ComponentType>(component), std::make_index_sequence<number_of_childs>())
+						)
+					});
+				} else {
+					adds<component_type>().push_back(pending_add<component_type> {
+						target,
+						component_wrapper<component_type>(target.consecutive_index, number_of_references, std::forward<ComponentType>(component))
+					});
+				}
+				return target;
+			}
+
+			template<typename Relation, std::size_t ...I>
+			stored_childs_t<std::decay_t<Relation>> record_childs(Relation&& relation_components, std::index_sequence<I...>) {
+				// braced initialization records the childs from left to right
+				return stored_childs_t<std::decay_t<Relation>> {
+					record_child<std::decay_t<Relation>, I>(std::forward<Relation>(relation_components))...
+				};
+			}
+
+			template<typename RelationType, std::size_t I, typename Relation>
+			stored_child_t<RelationType, std::tuple_element_t<I, typename RelationType::__component_types>> record_child(Relation&& relation_components) {
+				if constexpr (is_inline_child_v<RelationType, std::tuple_element_t<I, typename RelationType::__component_types>>) {
+					return std::get<I>(std::forward<Relation>(relation_components));
+				} else {
+					return record_add(std::get<I>(std::forward<Relation>(relation_components)), 1);
+				}
+			}
+
+			template<typename ComponentType>
+			static void apply_adds(encomsys_type* encomsys, command_buffer* const* buffers, const std::size_t number_of_buffers) {
+				std::vector<pending_add<ComponentType>*> pending;
+				for (std::size_t i = 0; i < number_of_buffers; i++) {
+					for (pending_add<ComponentType>& add : buffers[i]->template adds<ComponentType>()) {
+						pending.push_back(&add);
+					}
+				}
+				// reserved indices have to be filled in ascending order
+				std::sort(pending.begin(), pending.end(), [](const pending_add<ComponentType>* a, const pending_add<ComponentType>* b) {
+					return a->target.array_index < b->target.array_index;
+				});
+				if constexpr (is_relation_v<ComponentType>) {
+					for (pending_add<ComponentType>* add : pending) {
+						encomsys->__emplace_reserved(add->target, add->wrapper.number_of_references, std::move(add->wrapper._handles));
+					}
+				} else {
+					for (pending_add<ComponentType>* add : pending) {
+						encomsys->__emplace_reserved(add->target, add->wrapper.number_of_references, std::move(add->wrapper.value));
+					}
+				}
+			}
+
+			template<typename ComponentType>
+			void apply_writes() {
+				for (pending_write<ComponentType>& write : writes<ComponentType>()) {
+					if constexpr (is_relation_v<ComponentType>) {
+						// relations can not be written, see set()
+					} else if constexpr (is_soa_v<ComponentType>) {
+						if (auto ref = _encomsys->get_ref(write.target)) {
+							ref->set_value(write.value);
+						}
+					} else {
+						if (ComponentType* const component = _encomsys->get_ref(write.target)) {
+							*component = std::move(write.value);
+						}
+					}
+				}
+			}
+
+			template<typename ComponentType>
+			void apply_removes() {
+				for (const handle<ComponentType>& target : removes<ComponentType>()) {
+					_encomsys->remove(target);
+				}
+			}
+
+		public:
+			/**
+			 * @param encomsys The encomsys, that the recorded commands are applied to
+			 */
+			explicit command_buffer(encomsys_type& encomsys)
+				: _encomsys(&encomsys)
+			{}
+
+			/**
+			 * Records adding the given component or relation.
+			 *
+			 * @returns the handle, that the component has after apply()
+			 */
+			template<typename ComponentType>
+			handle<std::decay_t<ComponentType>> add(ComponentType&& component) {
+				return record_add(std::forward<ComponentType>(component), 0);
+			}
+
+			/**
+			 * Records adding a component of type <ComponentType> constructed from the given arguments.
+			 *
+			 * @returns the handle, that the component has after apply()
+			 */
+			template<typename ComponentType, typename ...Args>
+			handle<ComponentType> emplace(Args&&... args) {
+				return record_add(ComponentType(std::forward<Args>(args)...), 0);
+			}
+
+			/**
+			 * Records overwriting the component given by handle with value. Nothing happens, if the
+			 * component is not present when the write is applied.
+			 */
+			template<typename ComponentType, typename ValueType>
+			void set(const handle<ComponentType>& handle, ValueType&& value) {
+				static_assert(!is_relation_v<ComponentType>, "Relations can not be written, write their childs instead");
+				writes<ComponentType>().push_back(pending_write<ComponentType> {handle, ComponentType(std::forward<ValueType>(value))});
+			}
+
+			/**
+			 * Records removing the component or relation given by handle. The remove follows the rules of
+			 * encomsys::remove() at the time it is applied.
+			 */
+			template<typename ComponentType>
+			void remove(const handle<ComponentType>& handle) {
+				removes<ComponentType>().push_back(handle);
+			}
+
+			/**
+			 * @returns whether no command was recorded since the last apply()
+			 */
+			bool empty() const {
+				bool result = true;
+				std::apply([&result](const auto& ...vectors) { ((result = result && vectors.empty()), ...); }, _adds);
+				std::apply([&result](const auto& ...vectors) { ((result = result && vectors.empty()), ...); }, _writes);
+				std::apply([&result](const auto& ...vectors) { ((result = result && vectors.empty()), ...); }, _removes);
+				return result;
+			}
+
+			/**
+			 * Forgets all recorded commands. Their memory is kept for the next recording.
+			 */
+			void clear() {
+				std::apply([](auto& ...vectors) { (vectors.clear(), ...); }, _adds);
+				std::apply([](auto& ...vectors) { (vectors.clear(), ...); }, _writes);
+				std::apply([](auto& ...vectors) { (vectors.clear(), ...); }, _removes);
+			}
+
+			/**
+			 * Applies the commands of all given buffers to their encomsys and clears the buffers. All buffers
+			 * have to belong to the same encomsys.
+			 */
+			static void apply_all(command_buffer* const* buffers, const std::size_t number_of_buffers) {
+				if (number_of_buffers == 0) {
+					return;
+				}
+				encomsys_type* const encomsys = buffers[0]->_encomsys;
+				(apply_adds<ComponentTypes>(encomsys, buffers, number_of_buffers), ...);
+				encomsys->__release_reservations();
+				for (std::size_t i = 0; i < number_of_buffers; i++) {
+					(buffers[i]->template apply_writes<ComponentTypes>(), ...);
+				}
+				for (std::size_t i = 0; i < number_of_buffers; i++) {
+					(buffers[i]->template apply_removes<ComponentTypes>(), ...);
+					buffers[i]->clear();
+				}
+			}
+
+			/**
+			 * Applies the recorded commands and clears this buffer.
+			 */
+			void apply() {
+				command_buffer* self = this;
+				apply_all(&self, 1);
+			}
+	};
+
+	/**
+	 * Owns one command_buffer per thread. Threads record into their own buffer returned by local()
+	 * without locking. apply() is the sync point, that applies the buffers of all threads.
+	 */
+	template<typename Encomsys>
+	class command_queue {
+		private:
+			struct local_cache {
+				std::size_t queue_id;
+				command_buffer<Encomsys>* buffer;
+			};
+
+			inline static std::atomic<std::size_t> _next_queue_id {1};
+			inline static thread_local local_cache _local_cache {0, nullptr};
+
+			Encomsys* _encomsys;
+			std::size_t _id;
+			std::mutex _mutex;
+			std::vector<std::unique_ptr<command_buffer<Encomsys>>> _buffers;
+			// the thread, that records into the buffer with the same index
+			std::vector<std::thread::id> _threads;
+
+		public:
+			explicit command_queue(Encomsys& encomsys)
+				: _encomsys(&encomsys), _id(_next_queue_id.fetch_add(1, std::memory_order_relaxed))
+			{}
+
+			command_queue(const command_queue&) = delete;
+			command_queue& operator=(const command_queue&) = delete;
+
+			/**
+			 * @returns the command buffer of the calling thread. Only locks, if the thread used another
+			 * 			queue since its last call.
+			 */
+			command_buffer<Encomsys>& local() {
+				if (_local_cache.queue_id == _id) {
+					return *_local_cache.buffer;
+				}
+				std::lock_guard<std::mutex> lock(_mutex);
+				// the cache holds a single queue, so a thread alternating between queues finds its buffer here
+				const std::thread::id thread = std::this_thread::get_id();
+				const auto found = std::find(_threads.begin(), _threads.end(), thread);
+				command_buffer<Encomsys>* buffer;
+				if (found != _threads.end()) {
+					buffer = _buffers[found - _threads.begin()].get();
+				} else {
+					_buffers.push_back(std::make_unique<command_buffer<Encomsys>>(*_encomsys));
+					_threads.push_back(thread);
+					buffer = _buffers.back().get();
+				}
+				_local_cache = local_cache {_id, buffer};
+				return *buffer;
+			}
+
+			/**
+			 * @returns the number of threads, that recorded into this queue
+			 */
+			std::size_t number_of_buffers() {
+				std::lock_guard<std::mutex> lock(_mutex);
+				return _buffers.size();
+			}
+
+			/**
+			 * Applies the commands of every thread. Must not be called while other threads record commands.
+			 */
+			void apply() {
+				std::lock_guard<std::mutex> lock(_mutex);
+				std::vector<command_buffer<Encomsys>*> buffers;
+				for (const std::unique_ptr<command_buffer<Encomsys>>& buffer : _buffers) {
+					buffers.push_back(buffer.get());
+				}
+				command_buffer<Encomsys>::apply_all(buffers.data(), buffers.size());
+			}
+	};
+}
+
+#endif
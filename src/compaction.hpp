@@ -0,0 +1,147 @@
+#ifndef __COMPACTION_CLASS__
+#define __COMPACTION_CLASS__
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "util/types.hpp"
+#include "util/hash_index.hpp"
+#include "handle.hpp"
+#include "relation.hpp"
+#include "access_path.hpp"
+
+namespace encom {
+	/**
+	 * How encomsys::compact() arranges the childs of relations.
+	 */
+	enum class compaction_order {
+		// components keep their order, the components behind the holes are moved into the holes
+		none,
+		// the exclusively owned childs of relations are placed in the iteration order of their parents
+		parents
+	};
+
+	/**
+	 * Whether RelationType is a relation, that references a child of type ChildType by handle
+	 */
+	template<typename RelationType, typename ChildType, typename __Specialization=void>
+	struct __is_parent_of : std::false_type {};
+
+	template<typename RelationType, typename ChildType>
+	struct __is_parent_of<RelationType, ChildType, std::enable_if_t<is_relation_v<RelationType>>>
+		: std::bool_constant<
+			__is_child_of<typename RelationType::__component_types, ChildType>::value && !is_inline_child_v<RelationType, ChildType>
+		> {};
+
+	/**
+	 * Whether a storage keeps its elements packed and maps stable indices to positions, like
+	 * dense_vector and soa_vector. The elements of packed storages are reordered without changing
+	 * their indices.
+	 */
+	template<typename Storage, typename __Specialization=void>
+	struct is_packed_storage : std::false_type {};
+
+	template<typename Storage>
+	struct is_packed_storage<Storage, std::void_t<decltype(std::declval<const Storage&>().index_at_position(ID_TYPE(0)))>>
+		: std::true_type {};
+
+	template<typename Storage>
+	inline constexpr bool is_packed_storage_v = is_packed_storage<Storage>::value;
+
+	enum class compaction_phase : std::uint8_t {
+		idle,
+		// exclusively owned childs are moved behind all slots in the order of their parents
+		evacuate,
+		// exclusively owned childs behind the target are moved into the lowest holes
+		childs,
+		// unreferenced components behind the target are moved into the lowest holes
+		standalone,
+		// the elements of a packed storage are swapped into the order of their parents
+		reorder,
+		// the unused memory is released
+		shrink
+	};
+
+	/**
+	 * The progress of the compaction of one component type, so it can be continued by the next step.
+	 */
+	struct compaction_state {
+		compaction_phase phase = compaction_phase::idle;
+		// the number of slots, when the compaction started
+		ID_TYPE end = 0;
+		// the number of elements, when the current phase started. Elements behind it are moved.
+		ID_TYPE target = 0;
+		// the component index of the parent type, that is visited
+		std::size_t parent_type = 0;
+		// the position in the storage of the parent type or in the own storage
+		ID_TYPE cursor = 0;
+		// no hole and no unordered position lies before this
+		ID_TYPE hole = 0;
+	};
+
+	/**
+	 * Records the handles of the components, that were moved by a compaction. Handles held outside of
+	 * the encomsys are translated with find() (see encomsys::remap()).
+	 */
+	template<typename ComponentType>
+	class remap_table {
+		private:
+			static constexpr std::size_t NO_MOVE = ~std::size_t(0);
+
+			struct move {
+				handle<ComponentType> from;
+				handle<ComponentType> to;
+			};
+
+			// the moves in the order they happened
+			std::vector<move> _moves;
+			// finds the moves by the slot they started at
+			hash_index<ID_TYPE, std::size_t> _by_source;
+
+		public:
+			void record(const handle<ComponentType>& from, const handle<ComponentType>& to) {
+				const ID_TYPE source = from.array_index;
+				_by_source.insert(hash_index<ID_TYPE, std::size_t>::hash_key(source), source, _moves.size());
+				_moves.push_back(move {from, to});
+			}
+
+			/**
+			 * Follows all recorded moves of the component given by h. A slot can be the source of several
+			 * moves, so only moves of the same component after the previous move are followed.
+			 *
+			 * @returns the handle the component was moved to or h, if it was not moved
+			 */
+			handle<ComponentType> find(handle<ComponentType> h) const {
+				std::size_t after = 0;
+				while (true) {
+					const ID_TYPE source = h.array_index;
+					std::size_t next = NO_MOVE;
+					_by_source.find_all(hash_index<ID_TYPE, std::size_t>::hash_key(source), source, [&](const std::size_t i) {
+						if (i >= after && i < next && _moves[i].from.consecutive_index == h.consecutive_index) {
+							next = i;
+						}
+					});
+					if (next == NO_MOVE) {
+						return h;
+					}
+					h = _moves[next].to;
+					after = next + 1;
+				}
+			}
+
+			void clear() {
+				_moves.clear();
+				_by_source.clear();
+			}
+
+			/**
+			 * @returns the number of recorded moves
+			 */
+			std::size_t size() const {
+				return _moves.size();
+			}
+	};
+}
+
+#endif
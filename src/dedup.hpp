@@ -0,0 +1,124 @@
+#ifndef __DEDUP_CLASS__
+#define __DEDUP_CLASS__
+
+#include <cstdint>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "util/types.hpp"
+#include "util/hash_index.hpp"
+#include "handle.hpp"
+#include "relation.hpp"
+#include "soa.hpp"
+
+namespace encom {
+	/**
+	 * Shares equal childs of a component type between relations. Specialize this to enable it, e.g.
+	 *
+	 *   template<> struct encom::deduplicate<config_t> : std::true_type {};
+	 *
+	 * The type needs a specialization of std::hash and operator==. When a relation is added, a child of
+	 * this type, that equals a child already stored for another relation, is not stored again: the
+	 * relation references the existing slot and its number of references is increased. The slot is
+	 * removed with its last relation.
+	 *
+	 * A shared slot must not be written in place, so relations, views, query(), for_each() and access
+	 * paths reference deduplicated components as const (see relation_ref_expander). modify_child() of a
+	 * relation copies on write: a shared child is replaced by a copy of its own, before func is called,
+	 * so the write never reaches the other relations. get_ref() of a relation reads its deduplicated
+	 * childs without unsharing them. get_ref(), modify() and patch() with the handle of the child
+	 * throw, while the slot is shared, because the copy could not be stored in the relations, that
+	 * the handle came from. Childs added through a command_buffer or top level
+	 * components are never shared with existing slots. Inline childs (see inline_childs) are not shared.
+	 */
+	template<typename ComponentType, typename __Specialization=void>
+	struct deduplicate : std::false_type {};
+
+	template<typename ComponentType>
+	inline constexpr bool deduplicate_v = deduplicate<ComponentType>::value;
+
+	/**
+	 * Deduplicated components are referenced as const, because their slot can be shared
+	 */
+	template<typename ComponentType>
+	struct relation_ref_expander<ComponentType, std::enable_if_t<deduplicate_v<ComponentType>>> {
+		using type = const ComponentType&;
+	};
+
+	/**
+	 * The shared slots of a type without deduplicate
+	 */
+	template<typename ComponentType, typename __Specialization=void>
+	class dedup_table {};
+
+	/**
+	 * Maps the hashes of the values in the shareable slots of a type to their array indices. The values
+	 * stay in the storage and are compared there. Like index_table the hash of every slot is kept, so a
+	 * slot is erased, even if its value was written in place since.
+	 */
+	template<typename ComponentType>
+	class dedup_table<ComponentType, std::enable_if_t<deduplicate_v<ComponentType>>> {
+		static_assert(!is_relation_v<ComponentType> && !is_soa_v<ComponentType>, "Only plain components can be deduplicated");
+
+		private:
+			// the hash is the key and the value is the array index, so the values are not copied
+			hash_index<std::uint64_t, ID_TYPE> _map;
+			// the hash of every slot in the table, 0 for the other slots
+			std::vector<std::uint64_t> _slot_hashes;
+
+		public:
+			static std::uint64_t hash(const ComponentType& value) {
+				return mix_hash(std::hash<ComponentType>()(value));
+			}
+
+			/**
+			 * Adds the slot at array_index with the value of the given hash.
+			 */
+			void insert(const ID_TYPE array_index, const std::uint64_t hash) {
+				_map.insert(hash, hash, array_index);
+				if (_slot_hashes.size() <= array_index) {
+					_slot_hashes.resize(array_index + 1, 0);
+				}
+				_slot_hashes[array_index] = hash;
+			}
+
+			/**
+			 * Removes the slot at array_index, if it is in the table.
+			 */
+			void erase(const ID_TYPE array_index) {
+				if (array_index < _slot_hashes.size() && _slot_hashes[array_index] != 0) {
+					_map.erase(_slot_hashes[array_index], array_index);
+					_slot_hashes[array_index] = 0;
+				}
+			}
+
+			/**
+			 * @param equal Called with the array indices of the slots with the given hash, returns whether
+			 * 		  the value of the slot is the searched one
+			 * @returns a slot with the given hash, for which equal returned true, or nullptr
+			 */
+			template<typename Equal>
+			const ID_TYPE* find(const std::uint64_t hash, Equal&& equal) const {
+				const ID_TYPE* found = nullptr;
+				_map.find_all(hash, hash, [&found, &equal](const ID_TYPE& array_index) {
+					if (found == nullptr && equal(array_index)) {
+						found = &array_index;
+					}
+				});
+				return found;
+			}
+
+			void clear() {
+				_map.clear();
+				_slot_hashes.clear();
+			}
+
+			std::size_t size() const {
+				return _map.size();
+			}
+	};
+}
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef __DELTA_CLASS__
+#define __DELTA_CLASS__
+
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "encomsys.hpp"
+
+namespace encom {
+	/**
+	 * Whether the childs of RelationType, that are stored in their own storages, are tracked
+	 */
+	template<typename RelationType, typename ComponentTypes = typename RelationType::__component_types>
+	struct __all_tracked;
+
+	template<typename RelationType, typename ...ComponentTypes>
+	struct __all_tracked<RelationType, std::tuple<ComponentTypes...>>
+		: std::bool_constant<((track_changes_v<ComponentTypes> || is_inline_child_v<RelationType, ComponentTypes>) && ...)> {};
+
+	/**
+	 * The value, that a delta stores for a component: the component itself or the child handles and
+	 * inline childs of a relation.
+	 */
+	template<typename ComponentType, typename __Specialization=void>
+	struct delta_value {
+		using type = ComponentType;
+	};
+
+	template<typename RelationType>
+	struct delta_value<RelationType, std::enable_if_t<is_relation_v<RelationType>>> {
+		using type = stored_childs_t<RelationType>;
+	};
+
+	template<typename ComponentType>
+	using delta_value_t = typename delta_value<ComponentType>::type;
+
+	template<typename Encomsys>
+	class delta;
+
+	/**
+	 * The changes of the tracked types (see track_changes) of an encomsys since a tick: the added,
+	 * the modified and the removed components keyed by their handles. Collecting a delta costs time in
+	 * the number of changes, not in the number of components.
+	 *
+	 * A delta applied to a replica, that holds the state of the source at the tick the delta starts,
+	 * brings the replica to the current state of the source. Components keep their handles, so handles
+	 * of the source are valid in the replica. A typical replication loop is
+	 *
+	 *   encom::delta<ensys> changes(source, last_tick);
+	 *   last_tick = source.advance_tick();
+	 *   changes.apply(replica);
+	 */
+	template<typename ...ComponentTypes>
+	class delta<encomsys<ComponentTypes...>> {
+		public:
+			using encomsys_type = encomsys<ComponentTypes...>;
+
+			template<typename ComponentType>
+			struct entry {
+				handle<ComponentType> target;
+				std::uint32_t number_of_references;
+				delta_value_t<ComponentType> value;
+			};
+
+		private:
+			std::tuple<std::vector<entry<ComponentTypes>>...> _adds;
+			std::tuple<std::vector<entry<ComponentTypes>>...> _updates;
+			std::tuple<std::vector<handle<ComponentTypes>>...> _removes;
+			ID_TYPE _since;
+
+			template<typename ComponentType>
+			void collect(const encomsys_type& source) {
+				if constexpr (track_changes_v<ComponentType>) {
+					if constexpr (is_relation_v<ComponentType>) {
+						static_assert(
+							__all_tracked<ComponentType>::value,
+							"The childs of a relation with track_changes have to be tracked as well"
+						);
+					}
+					const auto& storage = source.template get_components<ComponentType>();
+					source.template for_each_change<ComponentType>(_since, [&](const handle<ComponentType>& target, const change_kind kind) {
+						if (kind == change_kind::removed) {
+							std::get<std::vector<handle<ComponentType>>>(_removes).push_back(target);
+							return;
+						}
+						const auto& wrapper = storage.get_unchecked(target.array_index);
+						std::vector<entry<ComponentType>>& entries = kind == change_kind::added
+							? std::get<std::vector<entry<ComponentType>>>(_adds)
+							: std::get<std::vector<entry<ComponentType>>>(_updates);
+						if constexpr (is_relation_v<ComponentType>) {
+							entries.push_back(entry<ComponentType> {target, wrapper.number_of_references, wrapper._handles});
+						} else {
+							entries.push_back(entry<ComponentType> {target, wrapper.number_of_references, wrapper.get_value()});
+						}
+					});
+				}
+			}
+
+			template<typename ComponentType>
+			void apply_removes(encomsys_type& target) const {
+				for (const handle<ComponentType>& removed : removes<ComponentType>()) {
+					target.__drop(removed);
+				}
+			}
+
+			template<bool Relations, typename ComponentType>
+			static void apply_entries(encomsys_type& target, const std::vector<entry<ComponentType>>& entries) {
+				if constexpr (is_relation_v<ComponentType> == Relations) {
+					for (const entry<ComponentType>& e : entries) {
+						target.__place(e.target, e.number_of_references, e.value);
+					}
+				}
+			}
+
+		public:
+			/**
+			 * Collects the changes of source at or after the tick since.
+			 */
+			delta(const encomsys_type& source, const ID_TYPE since)
+				: _since(since)
+			{
+				(collect<ComponentTypes>(source), ...);
+			}
+
+			/**
+			 * Applies the changes to target. Removed components are dropped, added and modified components
+			 * are put at the slots of their handles. Childs are not added or released, because the
+			 * changes of the childs are part of the delta themselves. Components are placed before
+			 * relations, so the keys of relation indexes (see secondary_index) are read from the new childs.
+			 */
+			void apply(encomsys_type& target) const {
+				(apply_removes<ComponentTypes>(target), ...);
+				(apply_entries<false, ComponentTypes>(target, adds<ComponentTypes>()), ...);
+				(apply_entries<false, ComponentTypes>(target, updates<ComponentTypes>()), ...);
+				(apply_entries<true, ComponentTypes>(target, adds<ComponentTypes>()), ...);
+				(apply_entries<true, ComponentTypes>(target, updates<ComponentTypes>()), ...);
+			}
+
+			template<typename ComponentType>
+			const std::vector<entry<ComponentType>>& adds() const {
+				return std::get<std::vector<entry<ComponentType>>>(_adds);
+			}
+
+			template<typename ComponentType>
+			const std::vector<entry<ComponentType>>& updates() const {
+				return std::get<std::vector<entry<ComponentType>>>(_updates);
+			}
+
+			template<typename ComponentType>
+			const std::vector<handle<ComponentType>>& removes() const {
+				return std::get<std::vector<handle<ComponentType>>>(_removes);
+			}
+
+			/**
+			 * @returns the number of added, modified and removed components
+			 */
+			std::size_t size() const {
+				return (
+					(adds<ComponentTypes>().size() + updates<ComponentTypes>().size() + removes<ComponentTypes>().size())
+					+ ...
+				);
+			}
+
+			bool empty() const {
+				return size() == 0;
+			}
+
+			/**
+			 * @returns the tick, that the delta starts at
+			 */
+			ID_TYPE since() const {
+				return _since;
+			}
+	};
+}
+
+#endif
@@ -1,18 +1,38 @@
 #ifndef __ENCOMSYS_CLASS__
 #define __ENCOMSYS_CLASS__
 
-// #define LOG_PRINTS
-
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <tuple>
+#include <typeinfo>
 #include <functional>
-#ifdef LOG_PRINTS
-#include <iostream>
-#endif
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
-#include "util/index_vector.hpp"
 #include "util/types.hpp"
+#include "util/occupancy_bitmap.hpp"
+#include "util/thread_pool.hpp"
+#include "util/iteration.hpp"
 #include "handle.hpp"
 #include "relation.hpp"
+#include "storage.hpp"
+#include "view.hpp"
+#include "access_path.hpp"
+#include "snapshot.hpp"
+#include "change_log.hpp"
+#include "observer.hpp"
+#include "secondary_index.hpp"
+#include "spatial_index.hpp"
+#include "dedup.hpp"
+#include "interned_string.hpp"
+#include "compaction.hpp"
+#include "stats.hpp"
+#include "tracing.hpp"
 
 namespace encom {
 	template<typename ...ComponentTypes>
@@ -20,7 +40,9 @@ namespace encom {
 
 	template<typename ComponentType, typename __Specialization=void>
 	struct component_wrapper {
-		ID_TYPE consecutive_index;
+		using component_type = ComponentType;
+
+		GENERATION_TYPE consecutive_index;
 		std::uint32_t number_of_references;
 		ComponentType value;
 
@@ -28,31 +50,31 @@ namespace encom {
 			: consecutive_index(consecutive_index), number_of_references(number_of_references), value(value)
 		{ }
 
+		component_wrapper(ID_TYPE consecutive_index, std::uint32_t number_of_references, ComponentType&& value)
+			: consecutive_index(consecutive_index), number_of_references(number_of_references), value(std::move(value))
+		{ }
+
+		/**
+		 * Constructs the wrapped component in place from the given arguments.
+		 */
+		template<typename ...Args>
+		component_wrapper(std::in_place_t, ID_TYPE consecutive_index, std::uint32_t number_of_references, Args&&... args)
+			: consecutive_index(consecutive_index), number_of_references(number_of_references), value(std::forward<Args>(args)...)
+		{ }
+
 		ComponentType& get_value() {
-			#ifdef LOG_PRINTS
-			std::cout << "component_wrapper<" << typeid(ComponentType).name() << ">::get_value()" << std::endl;
-			#endif
 			return value;
 		}
 
 		const ComponentType& get_value() const {
-			#ifdef LOG_PRINTS
-			std::cout << "component_wrapper<" << typeid(ComponentType).name() << ">::get_value() const" << std::endl;
-			#endif
 			return value;
 		}
 
 		ComponentType& get_ref() {
-			#ifdef LOG_PRINTS
-			std::cout << "component_wrapper<" << typeid(ComponentType).name() << ">::get_ref()" << std::endl;
-			#endif
 			return value;
 		}
 
 		const ComponentType& get_ref() const {
-			#ifdef LOG_PRINTS
-			std::cout << "component_wrapper<" << typeid(ComponentType).name() << ">::get_ref() const" << std::endl;
-			#endif
 			return value;
 		}
 
@@ -62,18 +84,22 @@ namespace encom {
 
 	/**
 	 * This specialization contains the relations sub type __component_handles, to point to
-	 * the components locations.
+	 * the components locations. Inline childs (see inline_childs) are stored in _handles themselves.
 	 */
 	template<typename RelationType>
 	struct component_wrapper<RelationType, std::enable_if_t<is_relation_v<RelationType>>> {
-		ID_TYPE consecutive_index;
+		GENERATION_TYPE consecutive_index;
 		std::uint32_t number_of_references;
-		typename RelationType::__component_handles _handles;
+		stored_childs_t<RelationType> _handles;
 
-		component_wrapper(ID_TYPE consecutive_index, std::uint32_t number_of_references, const typename RelationType::__component_handles& handles)
+		component_wrapper(ID_TYPE consecutive_index, std::uint32_t number_of_references, const stored_childs_t<RelationType>& handles)
 			: consecutive_index(consecutive_index), number_of_references(number_of_references), _handles(handles)
 		{}
 
+		component_wrapper(ID_TYPE consecutive_index, std::uint32_t number_of_references, stored_childs_t<RelationType>&& handles)
+			: consecutive_index(consecutive_index), number_of_references(number_of_references), _handles(std::move(handles))
+		{}
+
 		/**
 		 * Helper function for get_value()
 		 * The template argument I counts from 0 to sizeof...(RelationComponentTypes)-1.
@@ -93,11 +119,12 @@ namespace encom {
 			std::tuple<RelationComponentTypes...>* relation,
 			const encomsys<ComponentTypes...>* const encomsys
 		) const {
-			#ifdef LOG_PRINTS
-			std::cout << "relation_get_helper<I=" << I << ", sizeof...(RelationComponentTypes)=" << sizeof...(RelationComponentTypes) << ">()" << std::endl;
-			#endif
 			using current_relation_component_type = std::tuple_element_t<I, std::tuple<RelationComponentTypes...>>;
-			std::get<I>(*relation) = *encomsys->get(std::get<I>(_handles));
+			if constexpr (is_inline_child_v<RelationType, current_relation_component_type>) {
+				std::get<I>(*relation) = std::get<I>(_handles);
+			} else {
+				std::get<I>(*relation) = *encomsys->__get(std::get<I>(_handles));
+			}
 			relation_get_helper<I+1>(relation, encomsys);
 		}
 
@@ -107,9 +134,6 @@ namespace encom {
 		 */
 		template<typename ...ComponentTypes>
 		RelationType get_value(const encomsys<ComponentTypes...>* const encomsys) const {
-			#ifdef LOG_PRINTS
-			std::cout << "component_wrapper<" << typeid(RelationType).name() << ">::get_value()" << std::endl;
-			#endif
 			RelationType relation;
 			relation_get_helper(&relation, encomsys);
 			return relation;
@@ -124,37 +148,65 @@ namespace encom {
 			const handle<RelationComponentType>& handle,
 			encomsys<EncomComponentTypes...>* const encomsys
 		) const {
-			return *encomsys->get_ref(handle);
+			return *encomsys->__get_ref(handle);
+		}
+
+		// handle_to_ref for structure-of-arrays components
+		template<typename RelationComponentType, typename ...EncomComponentTypes>
+		std::enable_if_t<
+			is_soa_v<RelationComponentType>,
+			soa_ref<RelationComponentType>
+		> handle_to_ref(
+			const handle<RelationComponentType>& handle,
+			encomsys<EncomComponentTypes...>* const encomsys
+		) const {
+			return *encomsys->__get_ref(handle);
 		}
 
 		// handle_to_ref for components
 		template<typename RelationComponentType, typename ...EncomComponentTypes>
 		std::enable_if_t<
-			!is_relation_v<RelationComponentType>,
+			!is_relation_v<RelationComponentType> && !is_soa_v<RelationComponentType> && !deduplicate_v<RelationComponentType>,
 			typename std::reference_wrapper<RelationComponentType>
 		> handle_to_ref(
 			const handle<RelationComponentType>& handle,
 			encomsys<EncomComponentTypes...>* const encomsys
 		) const {
-			return std::ref(*encomsys->get_ref(handle));
+			return std::ref(*encomsys->__get_ref(handle));
 		}
 
-		template<size_t ...I, typename ...RelationComponentTypes, typename ...EncomComponentTypes>
-		typename RelationType::as_ref get_ref_helper_impl(
-			[[maybe_unused]] std::index_sequence<I...>,
-			const std::tuple<handle<RelationComponentTypes>...>& handles,
+		// handle_to_ref for deduplicated components, that are only read, because their slot can be
+		// shared. The childs of a present relation are always present.
+		template<typename RelationComponentType, typename ...EncomComponentTypes>
+		std::enable_if_t<
+			deduplicate_v<RelationComponentType>,
+			typename std::reference_wrapper<const RelationComponentType>
+		> handle_to_ref(
+			const handle<RelationComponentType>& handle,
 			encomsys<EncomComponentTypes...>* const encomsys
 		) const {
-			return typename RelationType::as_ref(std::make_tuple(handle_to_ref(std::get<I>(handles), encomsys) ...));
+			return std::cref(encomsys->__resolve_unchecked(handle));
+		}
+
+		/**
+		 * @returns the reference to the I-th child for get_ref(). Inline childs are referenced directly.
+		 */
+		template<size_t I, typename ...EncomComponentTypes>
+		auto child_to_ref(encomsys<EncomComponentTypes...>* const encomsys) {
+			using child_type = std::tuple_element_t<I, typename RelationType::__component_types>;
+			if constexpr (is_inline_child_v<RelationType, child_type>) {
+				return std::ref(std::get<I>(_handles));
+			} else {
+				return handle_to_ref(std::get<I>(_handles), encomsys);
+			}
 		}
 
-		template<typename ...RelationComponentTypes, typename ...EncomComponentTypes>
-		typename RelationType::as_ref get_ref_helper_expand_relation(
-			const std::tuple<handle<RelationComponentTypes>...>& handles,
+		template<size_t ...I, typename ...EncomComponentTypes>
+		typename RelationType::as_ref get_ref_helper_impl(
+			[[maybe_unused]] std::index_sequence<I...>,
 			encomsys<EncomComponentTypes...>* const encomsys
-		) const {
-			constexpr size_t tuple_size = std::tuple_size<std::tuple<RelationComponentTypes...>>::value;
-			return get_ref_helper_impl(std::make_index_sequence<tuple_size>(), handles, encomsys);
+		) {
+			return typename RelationType::as_ref(std::make_tuple(child_to_ref<I>(encomsys) ...));
 		}
 
 		/**
@@ -162,8 +214,68 @@ namespace encom {
 		 * @param encomsys The encomsys to retrieve the components of this relation
 		 */
 		template<typename ...ComponentTypes>
-		typename RelationType::as_ref get_ref(encomsys<ComponentTypes...>* const encomsys) const {
-			return get_ref_helper_expand_relation(_handles, encomsys);
+		typename RelationType::as_ref get_ref(encomsys<ComponentTypes...>* const encomsys) {
+			constexpr size_t tuple_size = std::tuple_size<typename RelationType::__component_types>::value;
+			return get_ref_helper_impl(std::make_index_sequence<tuple_size>(), encomsys);
+		}
+
+		/**
+		 * @returns the reference to the I-th child without validating its handle
+		 */
+		template<size_t I, typename ...EncomComponentTypes>
+		relation_ref_expander_t<std::tuple_element_t<I, typename RelationType::__component_types>> resolve_child_unchecked(
+			encomsys<EncomComponentTypes...>* const encomsys
+		) {
+			using child_type = std::tuple_element_t<I, typename RelationType::__component_types>;
+			if constexpr (is_inline_child_v<RelationType, child_type>) {
+				return std::get<I>(_handles);
+			} else {
+				return encomsys->__resolve_unchecked(std::get<I>(_handles));
+			}
+		}
+
+		template<size_t ...I, typename ...EncomComponentTypes>
+		typename RelationType::as_ref get_ref_unchecked_impl(
+			[[maybe_unused]] std::index_sequence<I...>,
+			encomsys<EncomComponentTypes...>* const encomsys
+		) {
+			return typename RelationType::as_ref(std::tuple<relation_ref_expander_t<std::tuple_element_t<I, typename RelationType::__component_types>>...>(
+				resolve_child_unchecked<I>(encomsys)...
+			));
+		}
+
+		/**
+		 * Returns the relation as their reference type (relation::as_ref) like get_ref(), but resolves the
+		 * child handles without validating them. The childs of a present relation are always present,
+		 * because they can not be removed while they are referenced.
+		 *
+		 * @param encomsys The encomsys to retrieve the components of this relation
+		 */
+		template<typename ...ComponentTypes>
+		typename RelationType::as_ref get_ref_unchecked(encomsys<ComponentTypes...>* const encomsys) {
+			constexpr size_t tuple_size = std::tuple_size<typename RelationType::__component_types>::value;
+			return get_ref_unchecked_impl(std::make_index_sequence<tuple_size>(), encomsys);
+		}
+
+		template<size_t ...I, typename ...ComponentTypes>
+		void prefetch_childs_impl([[maybe_unused]] std::index_sequence<I...>, const encomsys<ComponentTypes...>* const encomsys) const {
+			([this, encomsys]() {
+				if constexpr (!is_inline_child_v<RelationType, std::tuple_element_t<I, typename RelationType::__component_types>>) {
+					encomsys->__prefetch(std::get<I>(_handles));
+				}
+			}(), ...);
+		}
+
+		/**
+		 * Hints the cpu to load the direct child components of this relation into the cache. Inline
+		 * childs are part of the slot and need no prefetch.
+		 *
+		 * @param encomsys The encomsys, that stores the childs
+		 */
+		template<typename ...ComponentTypes>
+		void prefetch_childs(const encomsys<ComponentTypes...>* const encomsys) const {
+			constexpr size_t tuple_size = std::tuple_size<typename RelationType::__component_types>::value;
+			prefetch_childs_impl(std::make_index_sequence<tuple_size>(), encomsys);
 		}
 
 		template<size_t I = 0, typename ...RelationComponentTypes, typename ...ComponentTypes>
@@ -195,332 +307,2403 @@ namespace encom {
 		}
 	};
 
+	/**
+	 * The container type, that stores the wrapped components of type ComponentType.
+	 */
+	template<typename ComponentType>
+	using component_storage_t = typename component_storage<ComponentType>::template type<component_wrapper<ComponentType>>;
+
+	/**
+	 * The position of T in Ts...
+	 */
+	template<typename T, typename ...Ts>
+	struct __type_index;
+
+	template<typename T, typename ...Ts>
+	struct __type_index<T, T, Ts...> : std::integral_constant<std::size_t, 0> {};
+
+	template<typename T, typename U, typename ...Ts>
+	struct __type_index<T, U, Ts...> : std::integral_constant<std::size_t, 1 + __type_index<T, Ts...>::value> {};
+
 	template<typename... ComponentTypes>
 	class encomsys {
+		public:
+			static constexpr std::size_t number_of_component_types = sizeof...(ComponentTypes);
+
+			/**
+			 * The position of ComponentType in the template arguments of this encomsys
+			 */
+			template<typename ComponentType>
+			static constexpr std::size_t component_index = __type_index<ComponentType, ComponentTypes...>::value;
+
 		private:
-			std::tuple<index_vector<component_wrapper<ComponentTypes>>...> _components;
+			// the first consecutive index of handles reserved by __reserve_handle()
+			static constexpr ID_TYPE RESERVED_CONSECUTIVE_INDEX = ID_TYPE(1) << 63;
+
+			// the snapshot, whose memory is used by the storages after load(). Declared first, so it is unmapped last.
+			std::shared_ptr<mapped_file> _snapshot;
+			std::tuple<component_storage_t<ComponentTypes>...> _components;
 			ID_TYPE _next_consecutive_id;
+#ifdef ENCOM_COMPACT_HANDLES
+			// the generation of the next component in every slot, that was freed, per component type
+			std::array<std::vector<GENERATION_TYPE>, number_of_component_types> _generations;
+#endif
+			// the number of indices behind slot_count() per component type, that were handed out by __reserve_handle()
+			std::unique_ptr<std::atomic<ID_TYPE>[]> _reserved_indices;
+			// reserved handles get consecutive indices with the highest bit set, so they never collide with add()
+			std::unique_ptr<std::atomic<ID_TYPE>> _next_reserved_id;
+			// counts the changes, that can invalidate references into the storage, per component type, see epoch()
+			std::array<ID_TYPE, number_of_component_types> _epochs;
+			// the tick, that changes are recorded with, see advance_tick()
+			ID_TYPE _tick;
+			// the changes of every type with track_changes
+			std::array<change_log, number_of_component_types> _change_logs;
+			std::tuple<observer_list<ComponentTypes>...> _observers;
+			observer_id _next_observer_id;
+			// the secondary index of every type with secondary_index
+			std::tuple<index_table<ComponentTypes>...> _indexes;
+			// the spatial index of every type with spatial_index
+			std::tuple<spatial_table<ComponentTypes>...> _spatial_indexes;
+			// the shareable slots of every type with deduplicate
+			std::tuple<dedup_table<ComponentTypes>...> _dedup_tables;
+			// the progress of the running compaction of every type, see compact_step()
+			std::array<compaction_state, number_of_component_types> _compactions;
+			// the components moved by the last compaction of every type, see remap()
+			std::tuple<remap_table<ComponentTypes>...> _remaps;
+			// the component index of the type, that defragment_step() compacts
+			std::size_t _defragment_type;
+#ifndef ENCOM_NO_STATS
+			operation_counters<number_of_component_types> _counters;
+#endif
+			thread_pool* _thread_pool;
+			std::unique_ptr<thread_pool> _owned_thread_pool;
 
-		public:
-			explicit encomsys();
+			/**
+			 * Returns the reference type (see relation_ref_expander) of a stored wrapper.
+			 */
+			template<typename ComponentType, typename WrapperType>
+			relation_ref_expander_t<ComponentType> wrapper_to_ref(WrapperType&& wrapper);
 
+			/**
+			 * Adds the given component or relation with the given consecutive index.
+			 */
 			template<typename ComponentType>
-			void __decrease_number_of_references(const handle<ComponentType>& handle);
+			handle<std::decay_t<ComponentType>> add_with_id(ComponentType&& component, std::uint32_t number_of_references, ID_TYPE consecutive_index);
 
 			/**
-			 * Adds the given component or relation into this encomsys.
-			 * It is assumed that the given component or relation is not references by other relations.
-			 *
-			 * @param component The component to add to this encomsys
-			 * @returns a handle to the added component
+			 * Returns the handle to the component, that was just added at array_index. With compact handles
+			 * the generation of the slot replaces the given consecutive index.
 			 */
 			template<typename ComponentType>
-			handle<ComponentType> add(const ComponentType& component);
+			handle<ComponentType> make_handle(ID_TYPE consecutive_index, ID_TYPE array_index);
 
+#ifdef ENCOM_COMPACT_HANDLES
 			/**
-			 * Adds the given component into this encomsys.
-			 *
-			 * @param component The component to add to this encomsys
-			 * @param number_of_references The number of relations referencing this component
-			 * @returns a handle to the added component
+			 * @returns the generation of the next component in the slot at array_index
 			 */
 			template<typename ComponentType>
-			std::enable_if_t<!is_relation_v<ComponentType>, handle<ComponentType>> add(const ComponentType& component, std::uint32_t number_of_references);
+			GENERATION_TYPE slot_generation(ID_TYPE array_index) const;
 
 			/**
-			 * Adds the given relation into this encomsys.
-			 *
-			 * @param relation_component The relation component to add to this encomsys
-			 * @param number_of_references The number of relations referencing this relation
-			 * @returns a handle to the added relation
+			 * Increases the generation of the slot at array_index, whose component is removed.
 			 */
-			template<typename RelationType>
-			std::enable_if_t<is_relation_v<RelationType>, handle<RelationType>> add(const RelationType& relation_component, std::uint32_t number_of_references);
+			template<typename ComponentType>
+			void retire_slot(ID_TYPE array_index, GENERATION_TYPE generation);
+#endif
 
 			/**
-			 * @param handle The handle to the requested component
-			 * @returns the component referenced by the given handle. If the component could not be found
-			 * 			nullptr is returned.
+			 * Changes the epoch of <ComponentType>, because its storage is about to be reallocated or
+			 * an element is about to be added, removed or moved. Every operation, that can invalidate
+			 * references into the storage, has to call this first, see epoch().
 			 */
 			template<typename ComponentType>
-			std::enable_if_t<!is_relation_v<ComponentType>, std::optional<ComponentType>>
-			get(const handle<ComponentType>&) const;
+			void invalidate_references();
 
 			/**
-			 * @param handle The handle to the requests component
-			 * @returns the component referenced by the given handle. If the component could not be found
-			 * 			nullptr is returned.
+			 * Records a change of the slot at array_index, if changes of <ComponentType> are tracked.
 			 */
-			template<typename RelationType>
-			std::enable_if_t<is_relation_v<RelationType>, std::optional<RelationType>>
-			get(const handle<RelationType>&) const;
+			template<typename ComponentType>
+			void record_change(ID_TYPE array_index, ID_TYPE consecutive_index, change_kind kind);
 
 			/**
-			 * @param handle The handle to the requested component
+			 * Counts an operation on <ComponentType> for stats(). Does nothing with ENCOM_NO_STATS.
 			 */
 			template<typename ComponentType>
-			std::enable_if_t<!is_relation_v<ComponentType>, ComponentType* const>
-			get_ref(const handle<ComponentType>& handle);
+			void count_operation(stats_operation operation) const;
 
 			/**
-			 * @param handle The handle to the requested component
+			 * Notifies the observers of <ComponentType> about an event.
 			 */
-			template<typename RelationType>
-			std::enable_if_t<is_relation_v<RelationType>, std::optional<typename RelationType::as_ref>>
-			get_ref(const handle<RelationType>& handle);
+			template<typename ComponentType>
+			void notify(observer_event event, const handle<ComponentType>& handle);
+
+			template<typename ComponentType, typename Func>
+			observer_id add_observer(observer_event event, Func&& func);
 
 			/**
-			 * @param handle The reference to check
-			 * @returns whether the given handle is present in this encomsys
+			 * @returns the key of the present component or relation at array_index in the secondary index
+			 * of <ComponentType>
 			 */
 			template<typename ComponentType>
-			bool has_element(const handle<ComponentType>&) const;
+			const secondary_index_key_t<ComponentType>& index_key(ID_TYPE array_index);
 
-			template<typename ComponentType>
-			const index_vector<component_wrapper<ComponentType>>& get_components() const;
+			/**
+			 * @returns the array indices of the relations of type <RelationType>, whose key is the field
+			 * 			of the child at child_index. key is the key of the child in the index.
+			 */
+			template<typename RelationType, typename KeyType>
+			std::vector<ID_TYPE> keyed_parents(ID_TYPE child_index, const KeyType& key) const;
 
+			/**
+			 * Replaces the present component at array_index by changed and updates the keys of the
+			 * secondary index of <ComponentType> and of the relations keyed by a field of it.
+			 * Throws and changes nothing, if a new unique key belongs to another component or relation.
+			 */
 			template<typename ComponentType>
-			index_vector<component_wrapper<ComponentType>>& get_components();
+			void replace_keyed(ID_TYPE array_index, ComponentType&& changed);
 
 			/**
-			 * Removes the component given by handle
+			 * Adds the present component at array_index to the secondary and the spatial index of
+			 * <ComponentType>, if there are any. Components of a type with deduplicate, that are
+			 * referenced by relations, become shareable.
 			 *
-			 * @param handle The reference pointing to the component, that should be removed
-			 * @returns true, if the remove was successful, false otherwise
+			 * @returns false, if the index is unique and the key belongs to another component
 			 */
 			template<typename ComponentType>
-			bool remove(const handle<ComponentType>&);
+			bool index_slot(ID_TYPE array_index);
 
 			/**
-			 * Executes func for every component of type <ComponentType>.
-			 *
-			 * @param func The function to execute for every component of type <ComponentType>
+			 * Removes the component at array_index from the secondary and the spatial index and from the
+			 * shareable slots of <ComponentType>.
 			 */
 			template<typename ComponentType>
-			void for_each(void (*func)(const ComponentType&));
+			void unindex_slot(ID_TYPE array_index);
 
 			/**
-			 * Executes func for every component of type <ComponentType>.
-			 *
-			 * @param func The function to execute for every component of type <ComponentType>
+			 * Empties the secondary and the spatial index and the shareable slots of <ComponentType>.
 			 */
 			template<typename ComponentType>
-			void for_each(void (*func)(ComponentType&));
+			void clear_indexes();
 
 			/**
-			 * Executes func for every component of type <ComponentType>.
-			 *
-			 * @param func The function to execute for every component of type <ComponentType>
+			 * Indexes every component of <ComponentType> again, e.g. after load().
 			 */
 			template<typename ComponentType>
-			void for_each(void (*func)(ComponentType&, encomsys&));
+			void rebuild_index();
 
 			/**
-			 * Executes func for every component of type <ComponentType>.
+			 * Moves the present component at array_index from into the empty slot to, updates its indexes
+			 * and records the move in the remap table. The handles in the parents are not patched.
 			 *
-			 * @param func The function to execute for every component of type <ComponentType>
+			 * @returns the new handle of the component
 			 */
 			template<typename ComponentType>
-			void for_each(void (*func)(ComponentType&, const encomsys& encomsys));
+			handle<ComponentType> relocate(ID_TYPE from, ID_TYPE to);
 
 			/**
-			 * Executes func for every component of type <ComponentType>.
+			 * Calls visit(child) for every handle<ComponentType> in the relations, that have a child of
+			 * type <ComponentType>, in their iteration order, starting at the position in state. visit
+			 * can replace the handle and returns whether it did, so the parent is recorded as modified.
+			 * Every visited position costs one unit of budget.
 			 *
-			 * @param func The function to execute for every component of type <ComponentType>
+			 * @returns false, if the budget ran out before all parents were visited
 			 */
-			template<typename ComponentType>
-			void for_each(void (*func)(const ComponentType&, encomsys& encomsys));
+			template<typename ComponentType, typename Visit>
+			bool visit_parents(compaction_state& state, std::size_t& budget, Visit&& visit);
 
 			/**
-			 * Executes func for every component of type <ComponentType>.
+			 * Continues the compaction of <ComponentType> with the given budget and decreases it by the
+			 * work done.
 			 *
-			 * @param func The function to execute for every component of type <ComponentType>
+			 * @returns whether the compaction is finished
 			 */
 			template<typename ComponentType>
-			void for_each(void (*func)(const ComponentType&, const encomsys& encomsys)) const;
-	};
+			bool run_compaction(std::size_t& budget, compaction_order order);
 
-	template<typename... ComponentTypes>
-	encomsys<ComponentTypes...>::encomsys() : _next_consecutive_id(0) {}
-
-	template<typename... ComponentTypes>
-	template<typename ComponentType>
-	void encomsys<ComponentTypes...>::__decrease_number_of_references(const handle<ComponentType>& handle) {
-		if (has_element(handle)) {
-			get_components<ComponentType>().get(handle.array_index).number_of_references--;
-		}
-	}
+			/**
+			 * Counts, records and notifies the removal of the present component at array_index. The
+			 * component is not changed, so observers can still read it and its childs.
+			 */
+			template<typename ComponentType>
+			void announce_removal(ID_TYPE array_index);
 
-	template<typename... ComponentTypes>
-	template<typename ComponentType>
-	std::enable_if_t<!is_relation_v<ComponentType>, handle<ComponentType>> encomsys<ComponentTypes...>::add(const ComponentType& component, std::uint32_t number_of_references) {
-		const component_wrapper<ComponentType> w(_next_consecutive_id, number_of_references, component);
-		const ID_TYPE array_index = get_components<ComponentType>().add(w);
-		return handle<ComponentType>(_next_consecutive_id++, array_index);
-	}
+			/**
+			 * Removes the present component at array_index from its storage and its indexes, after the
+			 * removal was announced.
+			 */
+			template<typename ComponentType>
+			void erase_unchecked(ID_TYPE array_index);
 
-	template<std::size_t I = 0, typename ...RelationComponentTypes, typename ...ComponentTypes>
-	std::enable_if_t<I == sizeof...(RelationComponentTypes)>
-	add_relation_components(
-		const std::tuple<RelationComponentTypes...>&,
-		std::tuple<handle<RelationComponentTypes>...>*,
-		encomsys<ComponentTypes...>*
-	) {}
+			/**
+			 * Removes the present component at array_index from its storage without releasing its childs.
+			 */
+			template<typename ComponentType>
+			void drop_unchecked(ID_TYPE array_index);
 
-	template<std::size_t I = 0, typename ...RelationComponentTypes, typename ...ComponentTypes>
-	std::enable_if_t<I < sizeof...(RelationComponentTypes)>
-	add_relation_components(
-		const std::tuple<RelationComponentTypes...>& relation_components,
-		std::tuple<handle<RelationComponentTypes>...>* handles,
-		encomsys<ComponentTypes...>* encomsys
-	) {
-		using component_type = std::tuple_element_t<I, std::tuple<RelationComponentTypes...>>;
-		handle<component_type> component_handle = encomsys->add(std::get<I>(relation_components), 1);
-		add_relation_components<I+1>(relation_components, handles, encomsys);
-		std::get<handle<component_type>>(*handles) = component_handle;
-	}
+			/**
+			 * Removes the unreferenced component at array_index and releases its childs. The component
+			 * has to be present.
+			 *
+			 * @returns the number of removed components and relations including childs
+			 */
+			template<typename ComponentType>
+			std::size_t remove_unchecked(ID_TYPE array_index);
 
-	template<typename ...RelationComponentTypes, typename ...ComponentTypes>
-	std::tuple<handle<RelationComponentTypes>...> relation_add_helper(const std::tuple<RelationComponentTypes...>& relation_components, encomsys<ComponentTypes...>* encomsys) {
-		std::tuple<handle<RelationComponentTypes>...> handles;
-		add_relation_components(relation_components, &handles, encomsys);
-		return handles;
-	}
+			/**
+			 * Decreases the number of references of every child of the given wrapper and removes the
+			 * childs, that are not referenced anymore. The childs are not validated, because the childs
+			 * of present relations are always present. Inline childs are counted as removed.
+			 *
+			 * @returns the number of removed childs including their childs
+			 */
+			template<typename ComponentType, typename WrapperType>
+			std::size_t release_childs(WrapperType&& wrapper);
 
-	template<typename... ComponentTypes>
-	template<typename ComponentType>
-	handle<ComponentType> encomsys<ComponentTypes...>::add(const ComponentType& component) {
-		return add(component, 0);
-	}
+			template<typename ChildType>
+			std::size_t release_child(const handle<ChildType>& child);
 
-	template<typename... ComponentTypes>
-	template<typename RelationType>
-	std::enable_if_t<is_relation_v<RelationType>, handle<RelationType>> encomsys<ComponentTypes...>::add(const RelationType& relation_component, std::uint32_t number_of_references) {
-		typename RelationType::__component_handles handles = relation_add_helper(relation_component, this);
+			template<typename ChildType>
+			std::size_t release_child(const ChildType& inline_child);
 
-		component_wrapper<RelationType> w(_next_consecutive_id, number_of_references, handles);
+			/**
+			 * Makes the component at array_index unshareable, because it is about to be written. Does
+			 * nothing for types without deduplicate.
+			 */
+			template<typename ComponentType>
+			void unshare_slot(ID_TYPE array_index);
 
-		ID_TYPE array_index = get_components<RelationType>().add(w);
+			/**
+			 * Makes the component at array_index unshareable, because it is written through its handle.
+			 * Throws, if the slot is shared by several relations.
+			 */
+			template<typename ComponentType>
+			void unshare_written_slot(ID_TYPE array_index);
 
-		return handle<RelationType>(_next_consecutive_id++, array_index);
-	}
+			/**
+			 * Replaces child by a copy referenced only once, if it is shared.
+			 *
+			 * @returns whether child was replaced
+			 */
+			template<typename ChildType>
+			bool own_child(handle<ChildType>& child);
 
-	template<typename... ComponentTypes>
-	template<typename ComponentType>
-	std::enable_if_t<!is_relation_v<ComponentType>, std::optional<ComponentType>>
-	encomsys<ComponentTypes...>::get(const handle<ComponentType>& component_handle) const {
-		if (has_element(component_handle)) {
-			return get_components<ComponentType>().get(component_handle.array_index).get_value();
-		}
-		return {};
-	}
+			template<typename ...RelationComponentTypes>
+			void reserve_childs(std::size_t n, std::tuple<RelationComponentTypes...>*);
 
-	template<typename... ComponentTypes>
-	template<typename RelationType>
-	std::enable_if_t<
-		is_relation_v<RelationType>,
-		std::optional<RelationType>
-	>
-	encomsys<ComponentTypes...>::get(const handle<RelationType>& relation_handle) const {
-		if (has_element(relation_handle)) {
-			return std::optional(get_components<RelationType>().get(relation_handle.array_index).get_value(this));
-		}
-		return {};
-	}
+			/**
+			 * Describes the storage of <ComponentType> in the given section and payload for save().
+			 */
+			template<typename ComponentType>
+			void save_section(snapshot_section* section, snapshot_payload* payload) const;
 
-	template<typename ...ComponentTypes>
-	template<typename ComponentType>
-	std::enable_if_t<!is_relation_v<ComponentType>, ComponentType* const>
-	encomsys<ComponentTypes...>::get_ref(const handle<ComponentType>& component_handle) {
-		if (has_element(component_handle)) {
-			return &get_components<ComponentType>().get(component_handle.array_index).get_ref();
-		}
-		return nullptr;
-	}
+		public:
+			explicit encomsys();
 
-	template<typename ...ComponentTypes>
-	template<typename RelationType>
-	std::enable_if_t<is_relation_v<RelationType>, std::optional<typename RelationType::as_ref>>
-	encomsys<ComponentTypes...>::get_ref(const handle<RelationType>& component_handle) {
-		if (has_element(component_handle)) {
-			return std::optional(get_components<RelationType>().get(component_handle.array_index).get_ref(this));
-		}
-		return {};
-	}
+			template<typename ComponentType>
+			void __decrease_number_of_references(const handle<ComponentType>& handle);
 
-	template<typename... ComponentTypes>
-	template<typename ComponentType>
-	bool encomsys<ComponentTypes...>::has_element(const handle<ComponentType>& r) const {
-		// first check, if the array element is present
-		if (get_components<ComponentType>().has_index(r.array_index)) {
-			// second check, if the consecutive indices match
-			return get_components<ComponentType>().get(r.array_index).consecutive_index == r.consecutive_index;
-		}
-		return false;
-	}
+			/**
+			 * Adds the child of a relation, that is referenced once. If the type has deduplicate and an
+			 * equal component is shareable (see deduplicate), its number of references is increased
+			 * and its handle is returned instead.
+			 *
+			 * @returns a handle to the added or shared child
+			 */
+			template<typename ChildType>
+			handle<std::decay_t<ChildType>> __add_child(ChildType&& child);
 
-	template<typename... ComponentTypes>
-	template<typename ComponentType>
-	const index_vector<component_wrapper<ComponentType>>& encomsys<ComponentTypes...>::get_components() const {
-		return std::get<index_vector<component_wrapper<ComponentType>>>(_components);
-	}
+			/**
+			 * Returns the reference type (see relation_ref_expander) of the element given by handle without
+			 * validating the handle. Only use this for handles, that are known to be present.
+			 */
+			template<typename ComponentType>
+			relation_ref_expander_t<ComponentType> __resolve_unchecked(const handle<ComponentType>& handle);
 
-	template<typename... ComponentTypes>
+			/**
+			 * has_element(), get() and get_ref() without counting the operation (see stats()). The childs
+			 * of a relation are read with these, so a read is only counted once for the type, that was
+			 * requested.
+			 */
+			template<typename ComponentType>
+			bool __has_element(const handle<ComponentType>& handle) const;
+
+			template<typename ComponentType>
+			std::enable_if_t<!is_relation_v<ComponentType>, std::optional<ComponentType>>
+			__get(const handle<ComponentType>& handle) const;
+
+			template<typename RelationType>
+			std::enable_if_t<is_relation_v<RelationType>, std::optional<RelationType>>
+			__get(const handle<RelationType>& handle) const;
+
+			template<typename ComponentType>
+			std::enable_if_t<!is_relation_v<ComponentType> && !is_soa_v<ComponentType>, ComponentType* const>
+			__get_ref(const handle<ComponentType>& handle);
+
+			template<typename ComponentType>
+			std::enable_if_t<is_soa_v<ComponentType>, std::optional<soa_ref<ComponentType>>>
+			__get_ref(const handle<ComponentType>& handle);
+
+			template<typename RelationType>
+			std::enable_if_t<is_relation_v<RelationType>, std::optional<typename RelationType::as_ref>>
+			__get_ref(const handle<RelationType>& handle);
+
+			/**
+			 * Hints the cpu to load the element given by handle into the cache. The handle has to be present.
+			 */
+			template<typename ComponentType>
+			void __prefetch(const handle<ComponentType>& handle) const;
+
+			/**
+			 * Returns a number, that changes whenever a component of type <ComponentType> is added,
+			 * removed or moved, or the storage of <ComponentType> is reallocated by reserve(), a
+			 * compaction or load(). References into the storage of <ComponentType>, that were obtained
+			 * at the same epoch, are still valid.
+			 */
+			template<typename ComponentType>
+			ID_TYPE epoch() const;
+
+			/**
+			 * Hands out a handle to a component of type <ComponentType>, that is added later with
+			 * __emplace_reserved(). The reserved indices lie behind the used indices of the storage, so
+			 * this is safe to call from multiple threads, as long as no component is added or removed
+			 * concurrently. Every reserved handle has to be emplaced before the next direct add().
+			 */
+			template<typename ComponentType>
+			handle<ComponentType> __reserve_handle();
+
+			/**
+			 * Constructs the wrapper of a component at the index of a handle returned by __reserve_handle().
+			 * Reserved handles of one type have to be emplaced in ascending order of their array index.
+			 *
+			 * @param handle The reserved handle
+			 * @param args The arguments passed to the constructor of component_wrapper<ComponentType>
+			 * 		  after the consecutive index
+			 */
+			template<typename ComponentType, typename ...Args>
+			void __emplace_reserved(const handle<ComponentType>& handle, Args&&... args);
+
+			/**
+			 * Forgets all reserved handles. Called after all reserved handles are emplaced.
+			 */
+			void __release_reservations();
+
+			/**
+			 * Puts a component with the given handle, number of references and value (the child handles
+			 * for relations) into its storage. A present component with this handle is overwritten,
+			 * another component in the slot of handle is dropped first. Childs are neither added nor
+			 * released. This is used to replicate the storages of another encomsys (see delta).
+			 */
+			template<typename ComponentType, typename ValueType>
+			void __place(const handle<ComponentType>& handle, std::uint32_t number_of_references, ValueType&& value);
+
+			/**
+			 * Removes the component given by handle from its storage without releasing its childs.
+			 *
+			 * @returns true, if the component was present
+			 */
+			template<typename ComponentType>
+			bool __drop(const handle<ComponentType>& handle);
+
+			/**
+			 * @returns the tick, that changes are recorded with
+			 */
+			ID_TYPE tick() const;
+
+			/**
+			 * Starts a new tick. Changes recorded from now on are newer than all changes before.
+			 *
+			 * @returns the new tick
+			 */
+			ID_TYPE advance_tick();
+
+			/**
+			 * Records a write to the component given by handle, that did not go through get_ref(), e.g.
+			 * through a view or for_each(), and moves the component in its spatial index. Does nothing
+			 * for types without change tracking and spatial index.
+			 */
+			template<typename ComponentType>
+			void mark_changed(const handle<ComponentType>& handle);
+
+			/**
+			 * Calls func(handle, kind) for every slot of the tracked type <ComponentType>, that changed at
+			 * or after the given tick, with the change_kind of the last change. For removed slots handle
+			 * is the handle of the removed component. The time depends on the number of changes since
+			 * tick, not on the number of components.
+			 */
+			template<typename ComponentType, typename Func>
+			void for_each_change(ID_TYPE since, Func&& func) const;
+
+			/**
+			 * Forgets the changes of all types before the given tick, to free their memory.
+			 */
+			void discard_changes_before(ID_TYPE tick);
+
+			/**
+			 * Registers an observer, that is notified, when a component or relation of type <ComponentType>
+			 * is added. Observers callable with (const handle<ComponentType>* handles, std::size_t count)
+			 * are batched and get the handles of all events since the last dispatch_events() at once. Other
+			 * observers are called with const handle<ComponentType>& directly after the add and must not add
+			 * or remove components of the observed type or register observers.
+			 *
+			 * @returns an id for remove_observer()
+			 */
+			template<typename ComponentType, typename Func>
+			observer_id on_add(Func&& func);
+
+			/**
+			 * Registers an observer, that is notified, when a component or relation of type <ComponentType>
+			 * is removed, also by the removal of its parent relation. Immediate observers are called before
+			 * the component is removed, so it can still be read. See on_add() for batched observers.
+			 *
+			 * @returns an id for remove_observer()
+			 */
+			template<typename ComponentType, typename Func>
+			observer_id on_remove(Func&& func);
+
+			/**
+			 * Registers an observer, that is notified, when a component of type <ComponentType> is changed
+			 * through modify() or patch(). See on_add() for batched observers.
+			 *
+			 * @returns an id for remove_observer()
+			 */
+			template<typename ComponentType, typename Func>
+			observer_id on_modify(Func&& func);
+
+			/**
+			 * Removes the observer of <ComponentType> with the given id.
+			 *
+			 * @returns whether the observer was registered
+			 */
+			template<typename ComponentType>
+			bool remove_observer(observer_id id);
+
+			/**
+			 * Hands the events collected since the last call to the batched observers of every type. Call
+			 * this once per tick.
+			 */
+			void dispatch_events();
+
+			/**
+			 * Calls func with a reference to the component given by handle (soa_ref<ComponentType> for
+			 * structure-of-arrays components) and notifies the on_modify() observers afterwards. Throws
+			 * for a deduplicated component, that is shared by several relations (see modify_child()).
+			 *
+			 * @returns whether the component was present
+			 */
+			template<typename ComponentType, typename Func>
+			bool modify(const handle<ComponentType>& handle, Func&& func);
+
+			/**
+			 * Overwrites the component given by handle with value and notifies the on_modify() observers.
+			 * Throws like modify() for a shared component.
+			 *
+			 * @returns whether the component was present
+			 */
+			template<typename ComponentType, typename ValueType>
+			bool patch(const handle<ComponentType>& handle, ValueType&& value);
+
+			/**
+			 * Calls func with a reference to the child of type ChildType of the relation given by handle,
+			 * like modify() with the handle of the child. A child, that is shared with other relations
+			 * (see deduplicate), is replaced by a copy of its own first, so the write does not reach them.
+			 *
+			 * @returns whether the relation was present
+			 */
+			template<typename ChildType, typename RelationType, typename Func>
+			bool modify_child(const handle<RelationType>& handle, Func&& func);
+
+			/**
+			 * Finds a component or relation of type <ComponentType> by its key in the secondary index of
+			 * <ComponentType> (see secondary_index) in O(1).
+			 *
+			 * @returns a handle to a component with the given key or std::nullopt, if there is none
+			 */
+			template<typename ComponentType>
+			std::optional<handle<ComponentType>> lookup(const secondary_index_key_t<ComponentType>& key) const;
+
+			/**
+			 * Writes a handle to every component or relation of type <ComponentType> with the given key in
+			 * its secondary index into out, in no particular order.
+			 *
+			 * @returns the output iterator behind the last written handle
+			 */
+			template<typename ComponentType, typename OutputIterator>
+			OutputIterator lookup_all(const secondary_index_key_t<ComponentType>& key, OutputIterator out) const;
+
+			/**
+			 * Writes a handle to every component of type <ComponentType>, whose position lies in the box
+			 * from min to max (both inclusive), into out. Uses the spatial index of <ComponentType> (see
+			 * spatial_index), min and max are positions of the same type.
+			 *
+			 * @returns the output iterator behind the last written handle
+			 */
+			template<typename ComponentType, typename OutputIterator>
+			OutputIterator query_box(const ComponentType& min, const ComponentType& max, OutputIterator out) const;
+
+			/**
+			 * Writes a handle to every component of type <ComponentType>, whose distance to center is at
+			 * most radius, into out. Uses the spatial index of <ComponentType>.
+			 *
+			 * @returns the output iterator behind the last written handle
+			 */
+			template<typename ComponentType, typename OutputIterator>
+			OutputIterator query_radius(const ComponentType& center, float radius, OutputIterator out) const;
+
+			/**
+			 * Writes handles to the k components of type <ComponentType> closest to center into out,
+			 * ordered by distance. Writes fewer handles, if there are fewer components. Uses the spatial
+			 * index of <ComponentType>.
+			 *
+			 * @returns the output iterator behind the last written handle
+			 */
+			template<typename ComponentType, typename OutputIterator>
+			OutputIterator query_nearest(const ComponentType& center, std::size_t k, OutputIterator out) const;
+
+			/**
+			 * Moves the components of type <ComponentType> into the front of their storage, so iteration
+			 * skips fewer holes, and releases the unused memory. The work is split into steps, every
+			 * step visits at most budget components or parent relations, so a compaction can run
+			 * alongside the simulation with bounded work per tick. Between steps components can be added,
+			 * removed and changed as usual.
+			 *
+			 * Moved components get new handles. The handles in relations are patched, handles held
+			 * elsewhere are translated with remap(). Every move is recorded as removal and add in the
+			 * change log and the patched relations as modified, observers are not notified. Childs shared
+			 * by several relations keep their slot. Packed storages (dense_storage, soa_storage) never
+			 * change handles, only their order and capacity. The last step reallocates the storage once.
+			 *
+			 * With compaction_order::parents the exclusively owned childs are first moved behind all
+			 * slots in the iteration order of their parents and then back into the lowest holes, so
+			 * iterating a relation walks its childs front to back. This needs up to twice the memory of
+			 * the storage until the compaction is finished.
+			 *
+			 * No handles from __reserve_handle() may be outstanding, while a compaction runs.
+			 *
+			 * @param budget The maximal number of components and relations to visit
+			 * @param order Whether childs are reordered. Only used, when a new compaction starts.
+			 * @returns whether the compaction is finished. The next call starts a new compaction.
+			 */
+			template<typename ComponentType>
+			bool compact_step(std::size_t budget, compaction_order order = compaction_order::none);
+
+			/**
+			 * Runs or finishes the compaction of <ComponentType> (see compact_step()) at once.
+			 */
+			template<typename ComponentType>
+			void compact(compaction_order order = compaction_order::none);
+
+			/**
+			 * Compacts every component type like compact_step(), one type after the other in the order of
+			 * the template arguments of this encomsys. List relations before their childs, so the childs
+			 * are ordered by the compacted relations.
+			 *
+			 * @returns whether all types are compacted. The next call starts again with the first type.
+			 */
+			bool defragment_step(std::size_t budget, compaction_order order = compaction_order::none);
+
+			/**
+			 * Compacts every component type at once.
+			 */
+			void defragment(compaction_order order = compaction_order::none);
+
+			/**
+			 * Reports the memory used by the storage of <ComponentType> and how often its components were
+			 * added, removed, read with get() and get_ref() and looked up with a stale handle. The
+			 * operations are counted with relaxed per-thread counters, that are summed up here. Define
+			 * ENCOM_NO_STATS to compile the counters out, then only the memory is reported.
+			 */
+			template<typename ComponentType>
+			component_stats stats() const;
+
+			/**
+			 * @returns stats() of every component type in the order of the template arguments
+			 */
+			std::array<component_stats, number_of_component_types> stats() const;
+
+			/**
+			 * Sets the operation counters of all types to 0.
+			 */
+			void reset_stats();
+
+			/**
+			 * Translates a handle, that was taken before the last compaction of <ComponentType>, into the
+			 * current handle of the component. The moves are kept until the next compaction of
+			 * <ComponentType> starts.
+			 *
+			 * @returns the new handle or the given handle, if the component was not moved
+			 */
+			template<typename ComponentType>
+			handle<ComponentType> remap(const handle<ComponentType>& handle) const;
+
+			/**
+			 * Adds the given component or relation into this encomsys.
+			 * It is assumed that the given component or relation is not references by other relations.
+			 * Rvalues are moved into the storage, for relations every child is moved into its own storage.
+			 *
+			 * @param component The component to add to this encomsys
+			 * @returns a handle to the added component
+			 */
+			template<typename ComponentType>
+			handle<std::decay_t<ComponentType>> add(ComponentType&& component);
+
+			/**
+			 * Adds the given component into this encomsys.
+			 *
+			 * @param component The component to add to this encomsys
+			 * @param number_of_references The number of relations referencing this component
+			 * @returns a handle to the added component
+			 */
+			template<typename ComponentType>
+			std::enable_if_t<!is_relation_v<std::decay_t<ComponentType>>, handle<std::decay_t<ComponentType>>>
+			add(ComponentType&& component, std::uint32_t number_of_references);
+
+			/**
+			 * Adds the given relation into this encomsys.
+			 *
+			 * @param relation_component The relation component to add to this encomsys
+			 * @param number_of_references The number of relations referencing this relation
+			 * @returns a handle to the added relation
+			 */
+			template<typename RelationType>
+			std::enable_if_t<is_relation_v<std::decay_t<RelationType>>, handle<std::decay_t<RelationType>>>
+			add(RelationType&& relation_component, std::uint32_t number_of_references);
+
+			/**
+			 * Constructs a component of type <ComponentType> from the given arguments directly in its storage.
+			 * Relations and structure-of-arrays components are constructed once and then moved into their storages.
+			 *
+			 * @param args The arguments passed to the constructor of <ComponentType>
+			 * @returns a handle to the added component
+			 */
+			template<typename ComponentType, typename ...Args>
+			handle<ComponentType> emplace(Args&&... args);
+
+			/**
+			 * Preallocates storage for n more elements of type <ComponentType>. For relations the storages
+			 * of all (nested) child types are reserved as well.
+			 *
+			 * @param n The number of elements, that will be added
+			 */
+			template<typename ComponentType>
+			void reserve(std::size_t n);
+
+			/**
+			 * Adds every component or relation in [first, last) into this encomsys. For forward iterators
+			 * all affected storages are reserved once up front and the added elements get one block of
+			 * consecutive ids. Single pass iterators (e.g. std::istream_iterator) are added one by one.
+			 *
+			 * @param first The first component to add
+			 * @param last The end of the components to add
+			 * @param out Receives a handle<ComponentType> for every added component
+			 * @returns out after the last written handle
+			 */
+			template<typename ComponentType, typename InputIterator, typename OutputIterator>
+			OutputIterator add_bulk(InputIterator first, InputIterator last, OutputIterator out);
+
+			/**
+			 * Adds n copies of the given component or relation into this encomsys like add_bulk().
+			 *
+			 * @param component The component to add
+			 * @param n The number of copies to add
+			 * @param out Receives a handle<ComponentType> for every added component
+			 * @returns out after the last written handle
+			 */
+			template<typename ComponentType, typename OutputIterator>
+			OutputIterator add_n(const ComponentType& component, std::size_t n, OutputIterator out);
+
+			/**
+			 * @param handle The handle to the requested component
+			 * @returns the component referenced by the given handle. If the component could not be found
+			 * 			nullptr is returned.
+			 */
+			template<typename ComponentType>
+			std::enable_if_t<!is_relation_v<ComponentType>, std::optional<ComponentType>>
+			get(const handle<ComponentType>&) const;
+
+			/**
+			 * @param handle The handle to the requests component
+			 * @returns the component referenced by the given handle. If the component could not be found
+			 * 			nullptr is returned.
+			 */
+			template<typename RelationType>
+			std::enable_if_t<is_relation_v<RelationType>, std::optional<RelationType>>
+			get(const handle<RelationType>&) const;
+
+			/**
+			 * Throws for a deduplicated component, that is shared by several relations.
+			 *
+			 * @param handle The handle to the requested component
+			 */
+			template<typename ComponentType>
+			std::enable_if_t<!is_relation_v<ComponentType> && !is_soa_v<ComponentType>, ComponentType* const>
+			get_ref(const handle<ComponentType>& handle);
+
+			/**
+			 * @param handle The handle to the requested structure-of-arrays component
+			 * @returns references to the fields of the component. If the component could not be found
+			 * 			an empty optional is returned.
+			 */
+			template<typename ComponentType>
+			std::enable_if_t<is_soa_v<ComponentType>, std::optional<soa_ref<ComponentType>>>
+			get_ref(const handle<ComponentType>& handle);
+
+			/**
+			 * @param handle The handle to the requested component
+			 */
+			template<typename RelationType>
+			std::enable_if_t<is_relation_v<RelationType>, std::optional<typename RelationType::as_ref>>
+			get_ref(const handle<RelationType>& handle);
+
+			/**
+			 * @param handle The reference to check
+			 * @returns whether the given handle is present in this encomsys
+			 */
+			template<typename ComponentType>
+			bool has_element(const handle<ComponentType>&) const;
+
+			/**
+			 * Returns a view, that iterates over all relations of type <RelationType> and hands them out
+			 * as RelationType::as_ref. Child handles are resolved directly into storage references and the
+			 * childs of upcoming relations are prefetched.
+			 */
+			template<typename RelationType>
+			std::enable_if_t<is_relation_v<RelationType>, relation_view<RelationType, encomsys>> view();
+
+			/**
+			 * Executes func for every relation of type <RelationType>. func is called with RelationType::as_ref.
+			 * This is a shortcut for view<RelationType>().for_each(func).
+			 *
+			 * @param func The function to execute for every relation of type <RelationType>
+			 */
+			template<typename RelationType, typename Func>
+			std::enable_if_t<is_relation_v<RelationType>> query(Func&& func);
+
+			template<typename ComponentType>
+			const component_storage_t<ComponentType>& get_components() const;
+
+			template<typename ComponentType>
+			component_storage_t<ComponentType>& get_components();
+
+			/**
+			 * Removes the component given by handle
+			 *
+			 * @param handle The reference pointing to the component, that should be removed
+			 * @returns true, if the remove was successful, false otherwise
+			 */
+			template<typename ComponentType>
+			bool remove(const handle<ComponentType>&);
+
+			/**
+			 * Removes every component or relation in [first, last) like remove(). The valid handles are
+			 * marked in a bitmap first, so the removals run in slot order: the storage and the storages of
+			 * the childs, which were usually added in the same order, are walked front to back. Childs are
+			 * not validated again, because the childs of present relations are always present.
+			 *
+			 * @param first The first handle<ComponentType> to remove
+			 * @param last The end of the handles to remove
+			 * @returns the number of removed components and relations including childs
+			 */
+			template<typename ComponentType, typename InputIterator>
+			std::size_t remove_bulk(InputIterator first, InputIterator last);
+
+			/**
+			 * Removes all components or relations of type <ComponentType>, that are not referenced by a
+			 * relation, together with their exclusively owned childs. If no component of this type is
+			 * referenced, the storage is replaced by an empty one in linear time.
+			 *
+			 * @returns the number of removed components and relations including childs
+			 */
+			template<typename ComponentType>
+			std::size_t clear();
+
+			/**
+			 * Executes func for every component or relation of type <ComponentType> in storage order. func
+			 * is called with ComponentType& for components, RelationType::as_ref for relations and
+			 * soa_ref<ComponentType> for structure-of-arrays components, followed by this encomsys, if func
+			 * accepts it. Any callable can be passed and is called directly, so lambdas are inlined. If func
+			 * returns bool, the iteration stops at the first false. func must not add or remove elements
+			 * of type <ComponentType>.
+			 *
+			 * @param func The function to execute for every component of type <ComponentType>
+			 * @returns false, if func stopped the iteration
+			 */
+			template<typename ComponentType, typename Func>
+			bool for_each(Func&& func);
+
+			/**
+			 * Executes func for every component of type <ComponentType> like for_each(), but with
+			 * const ComponentType& and const encomsys&. Relations and structure-of-arrays components are
+			 * handed out as references to writable childs and fields, so they can only be iterated on a
+			 * non-const encomsys.
+			 */
+			template<typename ComponentType, typename Func>
+			bool for_each(Func&& func) const;
+
+			/**
+			 * Executes func like for_each() for the elements at the storage positions [begin, end). The
+			 * positions are the slot indices of index_vector and chunked storages and the packed positions
+			 * of dense and structure-of-arrays storages. get_components<ComponentType>().position_count()
+			 * is the end of the storage. This splits an iteration, e.g. over several ticks.
+			 *
+			 * @returns false, if func stopped the iteration
+			 */
+			template<typename ComponentType, typename Func>
+			bool for_each_in(ID_TYPE begin, ID_TYPE end, Func&& func);
+
+			template<typename ComponentType, typename Func>
+			bool for_each_in(ID_TYPE begin, ID_TYPE end, Func&& func) const;
+
+			/**
+			 * Executes func for every component or relation of type <ComponentType> on the thread pool of
+			 * this encomsys. The storage is split into chunks of grain positions. func is called with
+			 * ComponentType& for components, RelationType::as_ref for relations and soa_ref<ComponentType> for
+			 * structure-of-arrays components. func is called concurrently and must not add or remove elements.
+			 *
+			 * @param func The function to execute for every component of type <ComponentType>
+			 * @param grain The number of storage positions per chunk
+			 */
+			template<typename ComponentType, typename Func>
+			void parallel_for_each(Func&& func, std::size_t grain = 4096);
+
+			/**
+			 * Makes parallel_for_each() use the given thread pool. The pool has to outlive this encomsys.
+			 * If no pool is attached, parallel_for_each() creates its own pool with one worker per hardware thread.
+			 */
+			void attach_thread_pool(thread_pool& pool);
+
+			/**
+			 * @returns the thread pool used by parallel_for_each()
+			 */
+			thread_pool& get_thread_pool();
+
+			/**
+			 * Hands the columns of the structure-of-arrays component type <ComponentType> to kernel.
+			 * kernel is called as kernel(count, field_columns...) with one pointer per field declared in
+			 * soa_layout<ComponentType>, each pointing to count contiguous values. The columns are 64 byte
+			 * aligned and contain no holes, so kernels can be auto-vectorized or use SIMD intrinsics.
+			 *
+			 * @param kernel The function to execute for every batch of components
+			 * @param batch_size The maximal number of components per call. 0 processes all components at once.
+			 */
+			template<typename ComponentType, typename Kernel>
+			std::enable_if_t<is_soa_v<ComponentType>> batch_update(Kernel&& kernel, std::size_t batch_size = 0);
+
+			/**
+			 * Writes all components and relations into a binary snapshot file. Every storage is written as
+			 * a 64 byte aligned section. index_vector storages of trivially copyable components and of
+			 * relations are written as raw slots, other components are written element wise and need a
+			 * specialization of encom::serializer, if they are not trivially copyable.
+			 *
+			 * @param path The file to write
+			 */
+			void save(const std::string& path) const;
+
+			/**
+			 * Replaces the content of this encomsys by a snapshot written by save() of the same encomsys
+			 * type and build. The file is mapped into memory and raw sections are used in place, so loading
+			 * does not touch the components and they are paged in on first access. Modified pages are
+			 * copied and never written back to the file. If the snapshot can not be loaded, an exception
+			 * is thrown and this encomsys is not changed.
+			 *
+			 * @param path The file to load
+			 */
+			void load(const std::string& path);
+	};
+
+	template<typename... ComponentTypes>
+	encomsys<ComponentTypes...>::encomsys()
+		: _next_consecutive_id(0),
+		  _reserved_indices(new std::atomic<ID_TYPE>[number_of_component_types]),
+		  _next_reserved_id(new std::atomic<ID_TYPE>(RESERVED_CONSECUTIVE_INDEX)),
+		  _epochs(),
+		  _tick(0),
+		  _next_observer_id(0),
+		  _defragment_type(0),
+		  _thread_pool(nullptr)
+	{
+		__release_reservations();
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	ID_TYPE encomsys<ComponentTypes...>::epoch() const {
+		return _epochs[component_index<ComponentType>];
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	void encomsys<ComponentTypes...>::invalidate_references() {
+		_epochs[component_index<ComponentType>]++;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	void encomsys<ComponentTypes...>::__decrease_number_of_references(const handle<ComponentType>& handle) {
+		if (has_element(handle)) {
+			get_components<ComponentType>().get(handle.array_index).number_of_references--;
+			record_change<ComponentType>(handle.array_index, handle.consecutive_index, change_kind::modified);
+		}
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	relation_ref_expander_t<ComponentType> encomsys<ComponentTypes...>::__resolve_unchecked(const handle<ComponentType>& handle) {
+		return wrapper_to_ref<ComponentType>(get_components<ComponentType>().get_unchecked(handle.array_index));
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	void encomsys<ComponentTypes...>::__prefetch(const handle<ComponentType>& handle) const {
+		get_components<ComponentType>().prefetch(handle.array_index);
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	handle<ComponentType> encomsys<ComponentTypes...>::__reserve_handle() {
+		const ID_TYPE array_index = get_components<ComponentType>().slot_count()
+			+ _reserved_indices[component_index<ComponentType>].fetch_add(1, std::memory_order_relaxed);
+#ifdef ENCOM_COMPACT_HANDLES
+		if (array_index > MAX_HANDLE_INDEX) {
+			throw "Too many components for compact handles";
+		}
+		return handle<ComponentType>(slot_generation<ComponentType>(array_index), array_index);
+#else
+		return handle<ComponentType>(_next_reserved_id->fetch_add(1, std::memory_order_relaxed), array_index);
+#endif
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename ...Args>
+	void encomsys<ComponentTypes...>::__emplace_reserved(const handle<ComponentType>& handle, Args&&... args) {
+		invalidate_references<ComponentType>();
+		get_components<ComponentType>().emplace_at(handle.array_index, ID_TYPE(handle.consecutive_index), std::forward<Args>(args)...);
+		if (!index_slot<ComponentType>(handle.array_index)) {
+			release_childs<ComponentType>(get_components<ComponentType>().get_unchecked(handle.array_index));
+			get_components<ComponentType>().remove(handle.array_index);
+			throw "Duplicate key in unique index";
+		}
+		count_operation<ComponentType>(STATS_ADD);
+		record_change<ComponentType>(handle.array_index, handle.consecutive_index, change_kind::added);
+		notify(OBSERVE_ADD, handle);
+	}
+
+	template<typename... ComponentTypes>
+	void encomsys<ComponentTypes...>::__release_reservations() {
+		for (std::size_t i = 0; i < number_of_component_types; i++) {
+			_reserved_indices[i].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	std::enable_if_t<!is_relation_v<std::decay_t<ComponentType>>, handle<std::decay_t<ComponentType>>>
+	encomsys<ComponentTypes...>::add(ComponentType&& component, std::uint32_t number_of_references) {
+		ENCOM_TRACE_SPAN("encomsys::add");
+		return add_with_id(std::forward<ComponentType>(component), number_of_references, _next_consecutive_id++);
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ChildType>
+	handle<std::decay_t<ChildType>> encomsys<ComponentTypes...>::__add_child(ChildType&& child) {
+		using child_type = std::decay_t<ChildType>;
+		if constexpr (deduplicate_v<child_type>) {
+			const auto& storage = get_components<child_type>();
+			const ID_TYPE* shared = std::get<component_index<child_type>>(_dedup_tables).find(
+				dedup_table<child_type>::hash(child),
+				[&storage, &child](const ID_TYPE array_index) { return storage.get_unchecked(array_index).value == child; }
+			);
+			if (shared != nullptr) {
+				auto&& w = get_components<child_type>().get_unchecked(*shared);
+				w.number_of_references++;
+				record_change<child_type>(*shared, w.consecutive_index, change_kind::modified);
+				return handle<child_type>(w.consecutive_index, *shared);
+			}
+		}
+		return add(std::forward<ChildType>(child), 1);
+	}
+
+	/**
+	 * Adds the I-th child of the given relation and all following childs into the encomsys. Inline
+	 * childs are copied into handles instead, deduplicated childs may be shared. If the relation is an rvalue, the childs are moved out of it.
+	 */
+	template<std::size_t I = 0, typename Relation, typename ...ComponentTypes>
+	void add_relation_components(
+		Relation&& relation_components,
+		stored_childs_t<std::decay_t<Relation>>* handles,
+		encomsys<ComponentTypes...>* encomsys
+	) {
+		using relation_type = std::decay_t<Relation>;
+		if constexpr (I < std::tuple_size_v<typename relation_type::__component_types>) {
+			// every forward only moves the I-th child, so forwarding the relation for each child is fine
+			if constexpr (is_inline_child_v<relation_type, std::tuple_element_t<I, typename relation_type::__component_types>>) {
+				std::get<I>(*handles) = std::get<I>(std::forward<Relation>(relation_components));
+			} else {
+				std::get<I>(*handles) = encomsys->__add_child(std::get<I>(std::forward<Relation>(relation_components)));
+			}
+			add_relation_components<I+1>(std::forward<Relation>(relation_components), handles, encomsys);
+		}
+	}
+
+	template<typename Relation, typename ...ComponentTypes>
+	stored_childs_t<std::decay_t<Relation>> relation_add_helper(Relation&& relation_components, encomsys<ComponentTypes...>* encomsys) {
+		stored_childs_t<std::decay_t<Relation>> handles;
+		add_relation_components(std::forward<Relation>(relation_components), &handles, encomsys);
+		return handles;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	handle<std::decay_t<ComponentType>> encomsys<ComponentTypes...>::add(ComponentType&& component) {
+		return add(std::forward<ComponentType>(component), 0);
+	}
+
+	template<typename... ComponentTypes>
+	template<typename RelationType>
+	std::enable_if_t<is_relation_v<std::decay_t<RelationType>>, handle<std::decay_t<RelationType>>>
+	encomsys<ComponentTypes...>::add(RelationType&& relation_component, std::uint32_t number_of_references) {
+		ENCOM_TRACE_SPAN("encomsys::add");
+		return add_with_id(std::forward<RelationType>(relation_component), number_of_references, _next_consecutive_id++);
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename ...Args>
+	handle<ComponentType> encomsys<ComponentTypes...>::emplace(Args&&... args) {
+		ENCOM_TRACE_SPAN("encomsys::emplace");
+		if constexpr (is_relation_v<ComponentType> || is_soa_v<ComponentType>) {
+			return add_with_id(ComponentType(std::forward<Args>(args)...), 0, _next_consecutive_id++);
+		} else {
+			const ID_TYPE consecutive_index = _next_consecutive_id++;
+			const ID_TYPE array_index = get_components<ComponentType>().emplace(
+				std::in_place, consecutive_index, 0, std::forward<Args>(args)...
+			);
+			return make_handle<ComponentType>(consecutive_index, array_index);
+		}
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	handle<std::decay_t<ComponentType>> encomsys<ComponentTypes...>::add_with_id(
+		ComponentType&& component,
+		std::uint32_t number_of_references,
+		ID_TYPE consecutive_index
+	) {
+		using component_type = std::decay_t<ComponentType>;
+		if constexpr (is_relation_v<component_type>) {
+			const ID_TYPE array_index = get_components<component_type>().emplace(
+				consecutive_index, number_of_references, relation_add_helper(std::forward<ComponentType>(component), this)
+			);
+			return make_handle<component_type>(consecutive_index, array_index);
+		} else {
+			const ID_TYPE array_index = get_components<component_type>().emplace(
+				consecutive_index, number_of_references, std::forward<ComponentType>(component)
+			);
+			return make_handle<component_type>(consecutive_index, array_index);
+		}
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	handle<ComponentType> encomsys<ComponentTypes...>::make_handle(ID_TYPE consecutive_index, ID_TYPE array_index) {
+		invalidate_references<ComponentType>();
+#ifdef ENCOM_COMPACT_HANDLES
+		auto&& w = get_components<ComponentType>().get_unchecked(array_index);
+		if (array_index > MAX_HANDLE_INDEX) {
+			release_childs<ComponentType>(w);
+			get_components<ComponentType>().remove(array_index);
+			throw "Too many components for compact handles";
+		}
+		consecutive_index = slot_generation<ComponentType>(array_index);
+		w.consecutive_index = consecutive_index;
+#endif
+		if (!index_slot<ComponentType>(array_index)) {
+			release_childs<ComponentType>(get_components<ComponentType>().get_unchecked(array_index));
+			get_components<ComponentType>().remove(array_index);
+			throw "Duplicate key in unique index";
+		}
+		count_operation<ComponentType>(STATS_ADD);
+		record_change<ComponentType>(array_index, consecutive_index, change_kind::added);
+		const handle<ComponentType> added(consecutive_index, array_index);
+		notify(OBSERVE_ADD, added);
+		return added;
+	}
+
+#ifdef ENCOM_COMPACT_HANDLES
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	GENERATION_TYPE encomsys<ComponentTypes...>::slot_generation(ID_TYPE array_index) const {
+		const std::vector<GENERATION_TYPE>& generations = _generations[component_index<ComponentType>];
+		return array_index < generations.size() ? generations[array_index] : 0;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	void encomsys<ComponentTypes...>::retire_slot(ID_TYPE array_index, GENERATION_TYPE generation) {
+		std::vector<GENERATION_TYPE>& generations = _generations[component_index<ComponentType>];
+		if (generations.size() <= array_index) {
+			generations.resize(array_index + 1, 0);
+		}
+		generations[array_index] = (generation + 1) & GENERATION_MASK;
+	}
+#endif
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	void encomsys<ComponentTypes...>::reserve(std::size_t n) {
+		auto& storage = get_components<ComponentType>();
+		invalidate_references<ComponentType>();
+		storage.reserve(storage.size() + n);
+		if constexpr (is_relation_v<ComponentType>) {
+			reserve_childs(n, static_cast<typename ComponentType::__component_types*>(nullptr));
+		}
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ...RelationComponentTypes>
+	void encomsys<ComponentTypes...>::reserve_childs(std::size_t n, std::tuple<RelationComponentTypes...>*) {
+		(reserve<RelationComponentTypes>(n), ...);
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename InputIterator, typename OutputIterator>
+	OutputIterator encomsys<ComponentTypes...>::add_bulk(InputIterator first, InputIterator last, OutputIterator out) {
+		ENCOM_TRACE_SPAN("encomsys::add_bulk");
+		if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIterator>::iterator_category>) {
+			const std::size_t count = std::distance(first, last);
+			reserve<ComponentType>(count);
+			ID_TYPE consecutive_index = _next_consecutive_id;
+			_next_consecutive_id += count;
+			for (; first != last; ++first) {
+				*out = add_with_id(*first, 0, consecutive_index++);
+				++out;
+			}
+		} else {
+			// counting would consume a single pass iterator, so the elements are added one by one
+			for (; first != last; ++first) {
+				*out = add_with_id(*first, 0, _next_consecutive_id++);
+				++out;
+			}
+		}
+		return out;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename OutputIterator>
+	OutputIterator encomsys<ComponentTypes...>::add_n(const ComponentType& component, std::size_t n, OutputIterator out) {
+		ENCOM_TRACE_SPAN("encomsys::add_n");
+		reserve<ComponentType>(n);
+		ID_TYPE consecutive_index = _next_consecutive_id;
+		_next_consecutive_id += n;
+		for (std::size_t i = 0; i < n; i++) {
+			*out = add_with_id(component, 0, consecutive_index++);
+			++out;
+		}
+		return out;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	std::enable_if_t<!is_relation_v<ComponentType>, std::optional<ComponentType>>
+	encomsys<ComponentTypes...>::get(const handle<ComponentType>& component_handle) const {
+		ENCOM_TRACE_SPAN("encomsys::get");
+		count_operation<ComponentType>(STATS_GET);
+		auto result = __get(component_handle);
+		if (!result) {
+			count_operation<ComponentType>(STATS_FAILED_HAS_ELEMENT);
+		}
+		return result;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	std::enable_if_t<!is_relation_v<ComponentType>, std::optional<ComponentType>>
+	encomsys<ComponentTypes...>::__get(const handle<ComponentType>& component_handle) const {
+		if (__has_element(component_handle)) {
+			return get_components<ComponentType>().get(component_handle.array_index).get_value();
+		}
+		return {};
+	}
+
+	template<typename... ComponentTypes>
+	template<typename RelationType>
+	std::enable_if_t<
+		is_relation_v<RelationType>,
+		std::optional<RelationType>
+	>
+	encomsys<ComponentTypes...>::get(const handle<RelationType>& relation_handle) const {
+		ENCOM_TRACE_SPAN("encomsys::get");
+		count_operation<RelationType>(STATS_GET);
+		auto result = __get(relation_handle);
+		if (!result) {
+			count_operation<RelationType>(STATS_FAILED_HAS_ELEMENT);
+		}
+		return result;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename RelationType>
+	std::enable_if_t<
+		is_relation_v<RelationType>,
+		std::optional<RelationType>
+	>
+	encomsys<ComponentTypes...>::__get(const handle<RelationType>& relation_handle) const {
+		if (__has_element(relation_handle)) {
+			return std::optional(get_components<RelationType>().get(relation_handle.array_index).get_value(this));
+		}
+		return {};
+	}
+
+	template<typename ...ComponentTypes>
+	template<typename ComponentType>
+	std::enable_if_t<!is_relation_v<ComponentType> && !is_soa_v<ComponentType>, ComponentType* const>
+	encomsys<ComponentTypes...>::get_ref(const handle<ComponentType>& component_handle) {
+		ENCOM_TRACE_SPAN("encomsys::get_ref");
+		count_operation<ComponentType>(STATS_GET_REF);
+		auto result = __get_ref(component_handle);
+		if (!result) {
+			count_operation<ComponentType>(STATS_FAILED_HAS_ELEMENT);
+		}
+		return result;
+	}
+
+	template<typename ...ComponentTypes>
+	template<typename ComponentType>
+	std::enable_if_t<!is_relation_v<ComponentType> && !is_soa_v<ComponentType>, ComponentType* const>
+	encomsys<ComponentTypes...>::__get_ref(const handle<ComponentType>& component_handle) {
+		if (__has_element(component_handle)) {
+			unshare_written_slot<ComponentType>(component_handle.array_index);
+			record_change<ComponentType>(component_handle.array_index, component_handle.consecutive_index, change_kind::modified);
+			return &get_components<ComponentType>().get(component_handle.array_index).get_ref();
+		}
+		return nullptr;
+	}
+
+	template<typename ...ComponentTypes>
+	template<typename ComponentType>
+	std::enable_if_t<is_soa_v<ComponentType>, std::optional<soa_ref<ComponentType>>>
+	encomsys<ComponentTypes...>::get_ref(const handle<ComponentType>& component_handle) {
+		ENCOM_TRACE_SPAN("encomsys::get_ref");
+		count_operation<ComponentType>(STATS_GET_REF);
+		auto result = __get_ref(component_handle);
+		if (!result) {
+			count_operation<ComponentType>(STATS_FAILED_HAS_ELEMENT);
+		}
+		return result;
+	}
+
+	template<typename ...ComponentTypes>
+	template<typename ComponentType>
+	std::enable_if_t<is_soa_v<ComponentType>, std::optional<soa_ref<ComponentType>>>
+	encomsys<ComponentTypes...>::__get_ref(const handle<ComponentType>& component_handle) {
+		if (__has_element(component_handle)) {
+			record_change<ComponentType>(component_handle.array_index, component_handle.consecutive_index, change_kind::modified);
+			return get_components<ComponentType>().get(component_handle.array_index).get_ref();
+		}
+		return {};
+	}
+
+	template<typename ...ComponentTypes>
+	template<typename RelationType>
+	std::enable_if_t<is_relation_v<RelationType>, std::optional<typename RelationType::as_ref>>
+	encomsys<ComponentTypes...>::get_ref(const handle<RelationType>& component_handle) {
+		ENCOM_TRACE_SPAN("encomsys::get_ref");
+		count_operation<RelationType>(STATS_GET_REF);
+		auto result = __get_ref(component_handle);
+		if (!result) {
+			count_operation<RelationType>(STATS_FAILED_HAS_ELEMENT);
+		}
+		return result;
+	}
+
+	template<typename ...ComponentTypes>
+	template<typename RelationType>
+	std::enable_if_t<is_relation_v<RelationType>, std::optional<typename RelationType::as_ref>>
+	encomsys<ComponentTypes...>::__get_ref(const handle<RelationType>& component_handle) {
+		if (__has_element(component_handle)) {
+			if constexpr (inline_childs_v<RelationType>) {
+				// the inline childs can be written through the reference
+				record_change<RelationType>(component_handle.array_index, component_handle.consecutive_index, change_kind::modified);
+			}
+			return std::optional(get_components<RelationType>().get(component_handle.array_index).get_ref(this));
+		}
+		return {};
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	bool encomsys<ComponentTypes...>::has_element(const handle<ComponentType>& r) const {
+		ENCOM_TRACE_SPAN("encomsys::has_element");
+		if (__has_element(r)) {
+			return true;
+		}
+		count_operation<ComponentType>(STATS_FAILED_HAS_ELEMENT);
+		return false;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	bool encomsys<ComponentTypes...>::__has_element(const handle<ComponentType>& r) const {
+		// first check, if the array element is present
+		if (get_components<ComponentType>().has_index(r.array_index)) {
+			// second check, if the consecutive indices match
+			if (get_components<ComponentType>().get(r.array_index).consecutive_index == r.consecutive_index) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename RelationType>
+	std::enable_if_t<is_relation_v<RelationType>, relation_view<RelationType, encomsys<ComponentTypes...>>>
+	encomsys<ComponentTypes...>::view() {
+		return relation_view<RelationType, encomsys>(this);
+	}
+
+	template<typename... ComponentTypes>
+	template<typename RelationType, typename Func>
+	std::enable_if_t<is_relation_v<RelationType>> encomsys<ComponentTypes...>::query(Func&& func) {
+		ENCOM_TRACE_SPAN("encomsys::query");
+		view<RelationType>().for_each(std::forward<Func>(func));
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	const component_storage_t<ComponentType>& encomsys<ComponentTypes...>::get_components() const {
+		return std::get<component_storage_t<ComponentType>>(_components);
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	component_storage_t<ComponentType>& encomsys<ComponentTypes...>::get_components() {
+		return std::get<component_storage_t<ComponentType>>(_components);
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	bool encomsys<ComponentTypes...>::remove(const handle<ComponentType>& h) {
+		ENCOM_TRACE_SPAN("encomsys::remove");
+		if (has_element(h)) {
+			auto&& w = get_components<ComponentType>().get(h.array_index);
+
+			if (w.number_of_references == 0) {
+				remove_unchecked<ComponentType>(h.array_index);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename InputIterator>
+	std::size_t encomsys<ComponentTypes...>::remove_bulk(InputIterator first, InputIterator last) {
+		ENCOM_TRACE_SPAN("encomsys::remove_bulk");
+		auto& storage = get_components<ComponentType>();
+		const ID_TYPE slot_count = storage.slot_count();
+
+		// marking the valid handles in a bitmap sorts them by slot and drops duplicates in linear time
+		occupancy_bitmap marked;
+		marked.resize(slot_count);
+		for (; first != last; ++first) {
+			const handle<ComponentType>& h = *first;
+			if (has_element(h) && storage.get_unchecked(h.array_index).number_of_references == 0) {
+				marked.set(h.array_index);
+			}
+		}
+
+		std::size_t number_of_removed = 0;
+		for (ID_TYPE index = marked.find_next(0, slot_count); index != slot_count; index = marked.find_next(index+1, slot_count)) {
+			number_of_removed += remove_unchecked<ComponentType>(index);
+		}
+		return number_of_removed;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	std::size_t encomsys<ComponentTypes...>::clear() {
+		ENCOM_TRACE_SPAN("encomsys::clear");
+		auto& storage = get_components<ComponentType>();
+		std::vector<ID_TYPE> unreferenced;
+		unreferenced.reserve(storage.size());
+		for (auto iter = storage.begin(); iter != storage.end(); ++iter) {
+			if ((*iter).number_of_references == 0) {
+				unreferenced.push_back(iter.index());
+			}
+		}
+
+		std::size_t number_of_removed = 0;
+		if (unreferenced.size() != storage.size()) {
+			std::sort(unreferenced.begin(), unreferenced.end());
+			for (const ID_TYPE array_index : unreferenced) {
+				number_of_removed += remove_unchecked<ComponentType>(array_index);
+			}
+			return number_of_removed;
+		}
+
+		// nothing references this type, so the storage is dropped as a whole after releasing the childs
+		for (const ID_TYPE array_index : unreferenced) {
+			auto&& w = storage.get_unchecked(array_index);
+#ifdef ENCOM_COMPACT_HANDLES
+			retire_slot<ComponentType>(array_index, w.consecutive_index);
+#endif
+			count_operation<ComponentType>(STATS_REMOVE);
+			record_change<ComponentType>(array_index, w.consecutive_index, change_kind::removed);
+			notify(OBSERVE_REMOVE, handle<ComponentType>(w.consecutive_index, array_index));
+			number_of_removed += 1 + release_childs<ComponentType>(w);
+		}
+		storage = component_storage_t<ComponentType>();
+		clear_indexes<ComponentType>();
+		invalidate_references<ComponentType>();
+		return number_of_removed;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	void encomsys<ComponentTypes...>::record_change(ID_TYPE array_index, ID_TYPE consecutive_index, change_kind kind) {
+		if constexpr (track_changes_v<ComponentType>) {
+			_change_logs[component_index<ComponentType>].record(_tick, array_index, consecutive_index, kind);
+		}
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	void encomsys<ComponentTypes...>::count_operation([[maybe_unused]] stats_operation operation) const {
+#ifndef ENCOM_NO_STATS
+		_counters.count(component_index<ComponentType>, operation);
+#endif
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	void encomsys<ComponentTypes...>::notify(observer_event event, const handle<ComponentType>& h) {
+		std::get<component_index<ComponentType>>(_observers).notify(event, h);
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	void encomsys<ComponentTypes...>::announce_removal(ID_TYPE array_index) {
+		const ID_TYPE consecutive_index = get_components<ComponentType>().get_unchecked(array_index).consecutive_index;
+		count_operation<ComponentType>(STATS_REMOVE);
+		record_change<ComponentType>(array_index, consecutive_index, change_kind::removed);
+		notify(OBSERVE_REMOVE, handle<ComponentType>(consecutive_index, array_index));
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	void encomsys<ComponentTypes...>::erase_unchecked(ID_TYPE array_index) {
+		invalidate_references<ComponentType>();
+#ifdef ENCOM_COMPACT_HANDLES
+		retire_slot<ComponentType>(array_index, get_components<ComponentType>().get_unchecked(array_index).consecutive_index);
+#endif
+		unindex_slot<ComponentType>(array_index);
+		get_components<ComponentType>().remove(array_index);
+	}
+
+	template<typename... ComponentTypes>
 	template<typename ComponentType>
-	index_vector<component_wrapper<ComponentType>>& encomsys<ComponentTypes...>::get_components() {
-		return std::get<index_vector<component_wrapper<ComponentType>>>(_components);
+	void encomsys<ComponentTypes...>::drop_unchecked(ID_TYPE array_index) {
+		announce_removal<ComponentType>(array_index);
+		erase_unchecked<ComponentType>(array_index);
 	}
 
 	template<typename... ComponentTypes>
 	template<typename ComponentType>
-	bool encomsys<ComponentTypes...>::remove(const handle<ComponentType>& h) {
-		if (has_element(h)) {
-			component_wrapper<ComponentType> w = get_components<ComponentType>().get(h.array_index);
+	std::size_t encomsys<ComponentTypes...>::remove_unchecked(ID_TYPE array_index) {
+		// the observers of a relation are notified, before its childs are released
+		announce_removal<ComponentType>(array_index);
+		const std::size_t number_of_removed_childs = release_childs<ComponentType>(get_components<ComponentType>().get_unchecked(array_index));
+		erase_unchecked<ComponentType>(array_index);
+		return 1 + number_of_removed_childs;
+	}
 
-			if (w.number_of_references == 0) {
-				w.remove_childs(this);
-				return get_components<ComponentType>().remove(h.array_index);
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename WrapperType>
+	std::size_t encomsys<ComponentTypes...>::release_childs(WrapperType&& wrapper) {
+		if constexpr (is_relation_v<ComponentType>) {
+			return std::apply([this](const auto& ...childs) { return (release_child(childs) + ...); }, wrapper._handles);
+		} else {
+			return 0;
+		}
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ChildType>
+	std::size_t encomsys<ComponentTypes...>::release_child(const ChildType&) {
+		// inline childs are removed with their relation
+		return 1;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ChildType>
+	std::size_t encomsys<ComponentTypes...>::release_child(const handle<ChildType>& child) {
+		if (--get_components<ChildType>().get_unchecked(child.array_index).number_of_references == 0) {
+			return remove_unchecked<ChildType>(child.array_index);
+		}
+		record_change<ChildType>(child.array_index, child.consecutive_index, change_kind::modified);
+		return 0;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	void encomsys<ComponentTypes...>::unshare_slot([[maybe_unused]] ID_TYPE array_index) {
+		if constexpr (deduplicate_v<ComponentType>) {
+			std::get<component_index<ComponentType>>(_dedup_tables).erase(array_index);
+		}
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	void encomsys<ComponentTypes...>::unshare_written_slot(ID_TYPE array_index) {
+		if constexpr (deduplicate_v<ComponentType>) {
+			if (get_components<ComponentType>().get_unchecked(array_index).number_of_references > 1) {
+				throw "Shared components can not be written through their handle, use modify_child() of a relation";
+			}
+			unshare_slot<ComponentType>(array_index);
+		}
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ChildType>
+	bool encomsys<ComponentTypes...>::own_child(handle<ChildType>& child) {
+		auto&& shared = get_components<ChildType>().get_unchecked(child.array_index);
+		if (shared.number_of_references == 1) {
+			unshare_slot<ChildType>(child.array_index);
+			return false;
+		}
+		// copy first, the add can move the shared component
+		ChildType copy(shared.value);
+		shared.number_of_references--;
+		record_change<ChildType>(child.array_index, child.consecutive_index, change_kind::modified);
+		child = add(std::move(copy), 1);
+		unshare_slot<ChildType>(child.array_index);
+		return true;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename ValueType>
+	void encomsys<ComponentTypes...>::__place(const handle<ComponentType>& h, std::uint32_t number_of_references, ValueType&& value) {
+		auto& storage = get_components<ComponentType>();
+		if (has_element(h)) {
+			auto&& w = storage.get_unchecked(h.array_index);
+			w.number_of_references = number_of_references;
+			unindex_slot<ComponentType>(h.array_index);
+			if constexpr (is_relation_v<ComponentType>) {
+				w._handles = std::forward<ValueType>(value);
+			} else if constexpr (is_soa_v<ComponentType>) {
+				w.get_ref().set_value(value);
+			} else {
+				w.value = std::forward<ValueType>(value);
 			}
+			if (!index_slot<ComponentType>(h.array_index)) {
+				throw "Duplicate key in unique index";
+			}
+			record_change<ComponentType>(h.array_index, h.consecutive_index, change_kind::modified);
+			notify(OBSERVE_MODIFY, h);
+			return;
+		}
+		if (storage.has_index(h.array_index)) {
+			drop_unchecked<ComponentType>(h.array_index);
+		}
+		invalidate_references<ComponentType>();
+		storage.emplace_at(h.array_index, ID_TYPE(h.consecutive_index), number_of_references, std::forward<ValueType>(value));
+		if (!index_slot<ComponentType>(h.array_index)) {
+			storage.remove(h.array_index);
+			throw "Duplicate key in unique index";
+		}
+#ifndef ENCOM_COMPACT_HANDLES
+		// later adds must not reuse the consecutive index. Reserved handles have their own range.
+		if (h.consecutive_index >= _next_consecutive_id && h.consecutive_index < RESERVED_CONSECUTIVE_INDEX) {
+			_next_consecutive_id = h.consecutive_index + 1;
+		}
+#endif
+		count_operation<ComponentType>(STATS_ADD);
+		record_change<ComponentType>(h.array_index, h.consecutive_index, change_kind::added);
+		notify(OBSERVE_ADD, h);
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	bool encomsys<ComponentTypes...>::__drop(const handle<ComponentType>& h) {
+		if (has_element(h)) {
+			drop_unchecked<ComponentType>(h.array_index);
+			return true;
 		}
 		return false;
 	}
 
+	template<typename... ComponentTypes>
+	ID_TYPE encomsys<ComponentTypes...>::tick() const {
+		return _tick;
+	}
+
+	template<typename... ComponentTypes>
+	ID_TYPE encomsys<ComponentTypes...>::advance_tick() {
+		return ++_tick;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	void encomsys<ComponentTypes...>::mark_changed(const handle<ComponentType>& h) {
+		if (has_element(h)) {
+			if constexpr (has_spatial_index_v<ComponentType>) {
+				std::get<component_index<ComponentType>>(_spatial_indexes).move(h.array_index, get_components<ComponentType>().get_unchecked(h.array_index).value);
+			}
+			record_change<ComponentType>(h.array_index, h.consecutive_index, change_kind::modified);
+		}
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename Func>
+	void encomsys<ComponentTypes...>::for_each_change(ID_TYPE since, Func&& func) const {
+		static_assert(track_changes_v<ComponentType>, "Changes of this type are not tracked, specialize encom::track_changes");
+		_change_logs[component_index<ComponentType>].for_each_since(since, [&func](ID_TYPE array_index, ID_TYPE consecutive_index, change_kind kind) {
+			func(handle<ComponentType>(consecutive_index, array_index), kind);
+		});
+	}
+
+	template<typename... ComponentTypes>
+	void encomsys<ComponentTypes...>::discard_changes_before(ID_TYPE tick) {
+		for (change_log& log : _change_logs) {
+			log.discard_before(tick);
+		}
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename Func>
+	observer_id encomsys<ComponentTypes...>::add_observer(observer_event event, Func&& func) {
+		const observer_id id = _next_observer_id++;
+		std::get<component_index<ComponentType>>(_observers).add(event, id, std::forward<Func>(func));
+		return id;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename Func>
+	observer_id encomsys<ComponentTypes...>::on_add(Func&& func) {
+		return add_observer<ComponentType>(OBSERVE_ADD, std::forward<Func>(func));
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename Func>
+	observer_id encomsys<ComponentTypes...>::on_remove(Func&& func) {
+		return add_observer<ComponentType>(OBSERVE_REMOVE, std::forward<Func>(func));
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename Func>
+	observer_id encomsys<ComponentTypes...>::on_modify(Func&& func) {
+		static_assert(!is_relation_v<ComponentType>, "Relations can not be modified, observe their childs instead");
+		return add_observer<ComponentType>(OBSERVE_MODIFY, std::forward<Func>(func));
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	bool encomsys<ComponentTypes...>::remove_observer(observer_id id) {
+		return std::get<component_index<ComponentType>>(_observers).remove(id);
+	}
+
+	template<typename... ComponentTypes>
+	void encomsys<ComponentTypes...>::dispatch_events() {
+		ENCOM_TRACE_SPAN("encomsys::dispatch_events");
+		std::apply([](auto& ...observers) { (observers.dispatch(), ...); }, _observers);
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	const secondary_index_key_t<ComponentType>& encomsys<ComponentTypes...>::index_key(ID_TYPE array_index) {
+		using owner_type = secondary_index_owner_t<ComponentType>;
+		static_assert(!is_soa_v<owner_type> && !is_relation_v<owner_type>, "The key of a secondary index has to be a field of a plain component");
+		constexpr auto member = secondary_index<ComponentType>::member;
+		if constexpr (std::is_same_v<owner_type, ComponentType>) {
+			return get_components<ComponentType>().get_unchecked(array_index).value.*member;
+		} else {
+			static_assert(is_relation_v<ComponentType>, "The key of a secondary index has to be a field of the type or of a direct child");
+			const auto& childs = get_components<ComponentType>().get_unchecked(array_index)._handles;
+			if constexpr (is_inline_child_v<ComponentType, owner_type>) {
+				return std::get<owner_type>(childs).*member;
+			} else {
+				const handle<owner_type>& child = std::get<handle<owner_type>>(childs);
+				return get_components<owner_type>().get_unchecked(child.array_index).value.*member;
+			}
+		}
+	}
+
+	template<typename... ComponentTypes>
+	template<typename RelationType, typename KeyType>
+	std::vector<ID_TYPE> encomsys<ComponentTypes...>::keyed_parents(ID_TYPE child_index, const KeyType& key) const {
+		using child_type = secondary_index_owner_t<RelationType>;
+		std::vector<ID_TYPE> parents;
+		const auto& relations = get_components<RelationType>();
+		std::get<component_index<RelationType>>(_indexes).find_all(key, [&relations, &parents, child_index](ID_TYPE parent) {
+			if (std::get<handle<child_type>>(relations.get_unchecked(parent)._handles).array_index == child_index) {
+				parents.push_back(parent);
+			}
+		});
+		return parents;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	void encomsys<ComponentTypes...>::replace_keyed(ID_TYPE array_index, ComponentType&& changed) {
+		ComponentType& component = get_components<ComponentType>().get_unchecked(array_index).value;
+		const auto key_changes = [&component, &changed](auto member) {
+			return !(changed.*member == component.*member);
+		};
+
+		// check every changed key first, so nothing is changed, if one is taken
+		bool taken = false;
+		if constexpr (has_secondary_index_v<ComponentType>) {
+			constexpr auto member = secondary_index<ComponentType>::member;
+			taken = key_changes(member) && std::get<component_index<ComponentType>>(_indexes).conflicts(array_index, changed.*member);
+		}
+		([&]() {
+			if constexpr (__is_keyed_by<ComponentTypes, ComponentType>::value) {
+				constexpr auto member = secondary_index<ComponentTypes>::member;
+				if (!taken && key_changes(member)) {
+					const auto& index = std::get<component_index<ComponentTypes>>(_indexes);
+					for (const ID_TYPE parent : keyed_parents<ComponentTypes>(array_index, component.*member)) {
+						taken = taken || index.conflicts(parent, changed.*member);
+					}
+				}
+			}
+		}(), ...);
+		if (taken) {
+			throw "Duplicate key in unique index";
+		}
+
+		([&]() {
+			if constexpr (__is_keyed_by<ComponentTypes, ComponentType>::value) {
+				constexpr auto member = secondary_index<ComponentTypes>::member;
+				if (key_changes(member)) {
+					auto& index = std::get<component_index<ComponentTypes>>(_indexes);
+					for (const ID_TYPE parent : keyed_parents<ComponentTypes>(array_index, component.*member)) {
+						index.erase(parent);
+						index.insert(parent, changed.*member);
+					}
+				}
+			}
+		}(), ...);
+		if constexpr (has_secondary_index_v<ComponentType>) {
+			constexpr auto member = secondary_index<ComponentType>::member;
+			if (key_changes(member)) {
+				auto& index = std::get<component_index<ComponentType>>(_indexes);
+				index.erase(array_index);
+				index.insert(array_index, changed.*member);
+			}
+		}
+		component = std::move(changed);
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	bool encomsys<ComponentTypes...>::index_slot(ID_TYPE array_index) {
+		if constexpr (has_secondary_index_v<ComponentType>) {
+			if (!std::get<component_index<ComponentType>>(_indexes).insert(array_index, index_key<ComponentType>(array_index))) {
+				return false;
+			}
+		}
+		if constexpr (has_spatial_index_v<ComponentType>) {
+			static_assert(!is_soa_v<ComponentType> && !is_relation_v<ComponentType>, "Only plain components can have a spatial index");
+			std::get<component_index<ComponentType>>(_spatial_indexes).insert(array_index, get_components<ComponentType>().get_unchecked(array_index).value);
+		}
+		if constexpr (deduplicate_v<ComponentType>) {
+			const auto& w = get_components<ComponentType>().get_unchecked(array_index);
+			if (w.number_of_references > 0) {
+				std::get<component_index<ComponentType>>(_dedup_tables).insert(array_index, dedup_table<ComponentType>::hash(w.value));
+			}
+		}
+		return true;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	void encomsys<ComponentTypes...>::unindex_slot(ID_TYPE array_index) {
+		if constexpr (has_secondary_index_v<ComponentType>) {
+			std::get<component_index<ComponentType>>(_indexes).erase(array_index);
+		}
+		if constexpr (has_spatial_index_v<ComponentType>) {
+			std::get<component_index<ComponentType>>(_spatial_indexes).erase(array_index);
+		}
+		unshare_slot<ComponentType>(array_index);
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	void encomsys<ComponentTypes...>::clear_indexes() {
+		if constexpr (has_secondary_index_v<ComponentType>) {
+			std::get<component_index<ComponentType>>(_indexes).clear();
+		}
+		if constexpr (has_spatial_index_v<ComponentType>) {
+			std::get<component_index<ComponentType>>(_spatial_indexes).clear();
+		}
+		if constexpr (deduplicate_v<ComponentType>) {
+			std::get<component_index<ComponentType>>(_dedup_tables).clear();
+		}
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	void encomsys<ComponentTypes...>::rebuild_index() {
+		if constexpr (has_secondary_index_v<ComponentType> || has_spatial_index_v<ComponentType> || deduplicate_v<ComponentType>) {
+			clear_indexes<ComponentType>();
+			const auto& storage = get_components<ComponentType>();
+			for (auto iter = storage.begin(); iter != storage.end(); ++iter) {
+				index_slot<ComponentType>(iter.index());
+			}
+		}
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	std::optional<handle<ComponentType>> encomsys<ComponentTypes...>::lookup(const secondary_index_key_t<ComponentType>& key) const {
+		ENCOM_TRACE_SPAN("encomsys::lookup");
+		const ID_TYPE* array_index = std::get<component_index<ComponentType>>(_indexes).find(key);
+		if (array_index == nullptr) {
+			return std::nullopt;
+		}
+		return handle<ComponentType>(get_components<ComponentType>().get_unchecked(*array_index).consecutive_index, *array_index);
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename OutputIterator>
+	OutputIterator encomsys<ComponentTypes...>::lookup_all(const secondary_index_key_t<ComponentType>& key, OutputIterator out) const {
+		ENCOM_TRACE_SPAN("encomsys::lookup_all");
+		const auto& storage = get_components<ComponentType>();
+		std::get<component_index<ComponentType>>(_indexes).find_all(key, [&storage, &out](ID_TYPE array_index) {
+			*out++ = handle<ComponentType>(storage.get_unchecked(array_index).consecutive_index, array_index);
+		});
+		return out;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename OutputIterator>
+	OutputIterator encomsys<ComponentTypes...>::query_box(const ComponentType& min, const ComponentType& max, OutputIterator out) const {
+		ENCOM_TRACE_SPAN("encomsys::query_box");
+		using table_type = spatial_table<ComponentType>;
+		const auto& storage = get_components<ComponentType>();
+		std::get<component_index<ComponentType>>(_spatial_indexes).for_each_in_box(table_type::position(min), table_type::position(max), [&storage, &out](ID_TYPE array_index) {
+			*out++ = handle<ComponentType>(storage.get_unchecked(array_index).consecutive_index, array_index);
+		});
+		return out;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename OutputIterator>
+	OutputIterator encomsys<ComponentTypes...>::query_radius(const ComponentType& center, float radius, OutputIterator out) const {
+		ENCOM_TRACE_SPAN("encomsys::query_radius");
+		using table_type = spatial_table<ComponentType>;
+		const auto& storage = get_components<ComponentType>();
+		std::get<component_index<ComponentType>>(_spatial_indexes).for_each_in_radius(table_type::position(center), radius, [&storage, &out](ID_TYPE array_index) {
+			*out++ = handle<ComponentType>(storage.get_unchecked(array_index).consecutive_index, array_index);
+		});
+		return out;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename OutputIterator>
+	OutputIterator encomsys<ComponentTypes...>::query_nearest(const ComponentType& center, std::size_t k, OutputIterator out) const {
+		ENCOM_TRACE_SPAN("encomsys::query_nearest");
+		using table_type = spatial_table<ComponentType>;
+		const auto& storage = get_components<ComponentType>();
+		for (const std::pair<float, ID_TYPE>& nearest : std::get<component_index<ComponentType>>(_spatial_indexes).nearest(table_type::position(center), k)) {
+			*out++ = handle<ComponentType>(storage.get_unchecked(nearest.second).consecutive_index, nearest.second);
+		}
+		return out;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename Func>
+	bool encomsys<ComponentTypes...>::modify(const handle<ComponentType>& h, Func&& func) {
+		ENCOM_TRACE_SPAN("encomsys::modify");
+		static_assert(!is_relation_v<ComponentType>, "Relations can not be modified, modify their childs instead");
+		if (!has_element(h)) {
+			return false;
+		}
+		unshare_written_slot<ComponentType>(h.array_index);
+		if constexpr (has_secondary_index_v<ComponentType> || (__is_keyed_by<ComponentTypes, ComponentType>::value || ...)) {
+			// func changes a copy, so the component stays unchanged, if the new key is taken
+			ComponentType changed(get_components<ComponentType>().get_unchecked(h.array_index).value);
+			func(changed);
+			replace_keyed<ComponentType>(h.array_index, std::move(changed));
+		} else {
+			func(get_components<ComponentType>().get_unchecked(h.array_index).get_ref());
+		}
+		if constexpr (has_spatial_index_v<ComponentType>) {
+			std::get<component_index<ComponentType>>(_spatial_indexes).move(h.array_index, get_components<ComponentType>().get_unchecked(h.array_index).value);
+		}
+		record_change<ComponentType>(h.array_index, h.consecutive_index, change_kind::modified);
+		notify(OBSERVE_MODIFY, h);
+		return true;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename ValueType>
+	bool encomsys<ComponentTypes...>::patch(const handle<ComponentType>& h, ValueType&& value) {
+		ENCOM_TRACE_SPAN("encomsys::patch");
+		return modify(h, [&value](auto&& component) {
+			if constexpr (is_soa_v<ComponentType>) {
+				component.set_value(value);
+			} else {
+				component = std::forward<ValueType>(value);
+			}
+		});
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ChildType, typename RelationType, typename Func>
+	bool encomsys<ComponentTypes...>::modify_child(const handle<RelationType>& h, Func&& func) {
+		ENCOM_TRACE_SPAN("encomsys::modify_child");
+		static_assert(is_relation_v<RelationType>, "modify_child() needs the handle of a relation");
+		static_assert(__is_child_of<typename RelationType::__component_types, ChildType>::value, "ChildType has to be a child of the relation");
+		if (!has_element(h)) {
+			return false;
+		}
+		auto&& w = get_components<RelationType>().get_unchecked(h.array_index);
+		if constexpr (is_inline_child_v<RelationType, ChildType>) {
+			func(std::get<ChildType>(w._handles));
+			record_change<RelationType>(h.array_index, h.consecutive_index, change_kind::modified);
+		} else {
+			if constexpr (deduplicate_v<ChildType>) {
+				if (own_child(std::get<handle<ChildType>>(w._handles))) {
+					record_change<RelationType>(h.array_index, h.consecutive_index, change_kind::modified);
+				}
+			}
+			modify(handle<ChildType>(std::get<handle<ChildType>>(w._handles)), std::forward<Func>(func));
+		}
+		return true;
+	}
+
+	/**
+	 * Calls func of for_each() with element and with encomsys, if func accepts it.
+	 *
+	 * @returns whether the iteration continues
+	 */
+	template<typename Func, typename Element, typename Encomsys>
+	inline bool __for_each_call(Func& func, Element&& element, Encomsys& encomsys) {
+		if constexpr (std::is_invocable_v<Func&, Element, Encomsys&>) {
+			return continue_iteration(func, std::forward<Element>(element), encomsys);
+		} else {
+			return continue_iteration(func, std::forward<Element>(element));
+		}
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename Func>
+	bool encomsys<ComponentTypes...>::for_each(Func&& func) {
+		return for_each_in<ComponentType>(0, get_components<ComponentType>().position_count(), std::forward<Func>(func));
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename Func>
+	bool encomsys<ComponentTypes...>::for_each(Func&& func) const {
+		return for_each_in<ComponentType>(0, get_components<ComponentType>().position_count(), std::forward<Func>(func));
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename Func>
+	bool encomsys<ComponentTypes...>::for_each_in(ID_TYPE begin, ID_TYPE end, Func&& func) {
+		ENCOM_TRACE_SPAN("encomsys::for_each");
+		return get_components<ComponentType>().for_each_in(begin, end, [this, &func](auto&& wrapper) {
+			return __for_each_call(func, wrapper_to_ref<ComponentType>(wrapper), *this);
+		});
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename Func>
+	bool encomsys<ComponentTypes...>::for_each_in(ID_TYPE begin, ID_TYPE end, Func&& func) const {
+		ENCOM_TRACE_SPAN("encomsys::for_each");
+		static_assert(!is_relation_v<ComponentType> && !is_soa_v<ComponentType>, "Relations and structure-of-arrays components can only be iterated on a non-const encomsys");
+		return get_components<ComponentType>().for_each_in(begin, end, [this, &func](const component_wrapper<ComponentType>& wrapper) {
+			return __for_each_call(func, wrapper.value, *this);
+		});
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename Kernel>
+	std::enable_if_t<is_soa_v<ComponentType>> encomsys<ComponentTypes...>::batch_update(Kernel&& kernel, std::size_t batch_size) {
+		ENCOM_TRACE_SPAN("encomsys::batch_update");
+		get_components<ComponentType>().for_each_batch(kernel, batch_size);
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename WrapperType>
+	relation_ref_expander_t<ComponentType> encomsys<ComponentTypes...>::wrapper_to_ref(WrapperType&& wrapper) {
+		if constexpr (is_relation_v<ComponentType>) {
+			return wrapper.get_ref_unchecked(this);
+		} else {
+			return wrapper.get_ref();
+		}
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename Func>
+	void encomsys<ComponentTypes...>::parallel_for_each(Func&& func, std::size_t grain) {
+		ENCOM_TRACE_SPAN("encomsys::parallel_for_each");
+		if (grain == 0) {
+			grain = 1;
+		}
+		auto& storage = get_components<ComponentType>();
+		const std::size_t number_of_chunks = (storage.position_count() + grain - 1) / grain;
+		get_thread_pool().parallel_for(number_of_chunks, [&](const std::size_t chunk) {
+			storage.for_each_in(chunk * grain, (chunk+1) * grain, [&](auto&& wrapper) {
+				func(wrapper_to_ref<ComponentType>(wrapper));
+			});
+		});
+	}
+
 	template<typename... ComponentTypes>
 	template<typename ComponentType>
-	void encomsys<ComponentTypes...>::for_each(void (*func)(const ComponentType&)) {
-		for (const component_wrapper<ComponentType>& t : get_components<ComponentType>()) {
-			func(t.value);
+	void encomsys<ComponentTypes...>::save_section(snapshot_section* section, snapshot_payload* payload) const {
+		section->component_index = component_index<ComponentType>;
+		section->element_size = sizeof(component_wrapper<ComponentType>);
+		storage_snapshot<ComponentType, component_storage_t<ComponentType>>::save(get_components<ComponentType>(), section, payload);
+#ifdef ENCOM_COMPACT_HANDLES
+		const std::vector<GENERATION_TYPE>& generations = _generations[component_index<ComponentType>];
+		section->bytes[SNAPSHOT_GENERATIONS] = generations.size() * sizeof(GENERATION_TYPE);
+		payload->blocks[SNAPSHOT_GENERATIONS] = generations.data();
+#endif
+	}
+
+	template<typename... ComponentTypes>
+	void encomsys<ComponentTypes...>::save(const std::string& path) const {
+		ENCOM_TRACE_SPAN("encomsys::save");
+		std::array<snapshot_section, number_of_component_types> sections {};
+		std::array<snapshot_payload, number_of_component_types> payloads;
+		(save_section<ComponentTypes>(&sections[component_index<ComponentTypes>], &payloads[component_index<ComponentTypes>]), ...);
+		write_snapshot(path, _next_consecutive_id, sections.data(), payloads.data(), number_of_component_types);
+	}
+
+	template<typename... ComponentTypes>
+	void encomsys<ComponentTypes...>::load(const std::string& path) {
+		ENCOM_TRACE_SPAN("encomsys::load");
+		std::shared_ptr<mapped_file> file = std::make_shared<mapped_file>(path);
+		const snapshot_section* sections = read_snapshot_sections(*file, number_of_component_types);
+		for (std::size_t i = 0; i < number_of_component_types; i++) {
+			if (sections[i].component_index != i) {
+				throw "Snapshot does not match the encomsys";
+			}
+		}
+		if (((sections[component_index<ComponentTypes>].element_size != sizeof(component_wrapper<ComponentTypes>)) || ...)) {
+			throw "Snapshot does not match the encomsys";
+		}
+
+		// load into new storages, so this encomsys stays unchanged, if loading fails
+		std::tuple<component_storage_t<ComponentTypes>...> components;
+		(storage_snapshot<ComponentTypes, component_storage_t<ComponentTypes>>::load(
+			*file,
+			sections[component_index<ComponentTypes>],
+			&std::get<component_index<ComponentTypes>>(components)
+		), ...);
+#ifdef ENCOM_COMPACT_HANDLES
+		std::array<std::vector<GENERATION_TYPE>, number_of_component_types> generations;
+		for (std::size_t i = 0; i < number_of_component_types; i++) {
+			const GENERATION_TYPE* first = reinterpret_cast<const GENERATION_TYPE*>(file->data() + sections[i].offsets[SNAPSHOT_GENERATIONS]);
+			generations[i].assign(first, first + sections[i].bytes[SNAPSHOT_GENERATIONS] / sizeof(GENERATION_TYPE));
+		}
+		_generations = std::move(generations);
+#endif
+
+		_components = std::move(components);
+		_next_consecutive_id = reinterpret_cast<const snapshot_header*>(file->data())->next_consecutive_id;
+		(invalidate_references<ComponentTypes>(), ...);
+		__release_reservations();
+		_snapshot = std::move(file);
+		(rebuild_index<ComponentTypes>(), ...);
+		_compactions.fill(compaction_state());
+		std::apply([](auto& ...remaps) { (remaps.clear(), ...); }, _remaps);
+		_defragment_type = 0;
+
+		// every loaded component counts as added
+		for (change_log& log : _change_logs) {
+			log.clear();
 		}
+		([this]() {
+			if constexpr (track_changes_v<ComponentTypes>) {
+				const auto& storage = get_components<ComponentTypes>();
+				for (auto iter = storage.begin(); iter != storage.end(); ++iter) {
+					record_change<ComponentTypes>(iter.index(), (*iter).consecutive_index, change_kind::added);
+				}
+			}
+		}(), ...);
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	handle<ComponentType> encomsys<ComponentTypes...>::relocate(ID_TYPE from, ID_TYPE to) {
+		auto& storage = get_components<ComponentType>();
+		invalidate_references<ComponentType>();
+		const ID_TYPE consecutive_index = storage.get_unchecked(from).consecutive_index;
+		ID_TYPE moved_consecutive_index = consecutive_index;
+		unindex_slot<ComponentType>(from);
+		storage.relocate(from, to);
+#ifdef ENCOM_COMPACT_HANDLES
+		retire_slot<ComponentType>(from, consecutive_index);
+		moved_consecutive_index = slot_generation<ComponentType>(to);
+		storage.get_unchecked(to).consecutive_index = moved_consecutive_index;
+#endif
+		// the key is the same as before, so this can not conflict
+		index_slot<ComponentType>(to);
+		record_change<ComponentType>(from, consecutive_index, change_kind::removed);
+		record_change<ComponentType>(to, moved_consecutive_index, change_kind::added);
+		const handle<ComponentType> moved(moved_consecutive_index, to);
+		std::get<component_index<ComponentType>>(_remaps).record(handle<ComponentType>(consecutive_index, from), moved);
+		return moved;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType, typename Visit>
+	bool encomsys<ComponentTypes...>::visit_parents(compaction_state& state, std::size_t& budget, Visit&& visit) {
+		bool paused = false;
+		([&]() {
+			if constexpr (__is_parent_of<ComponentTypes, ComponentType>::value) {
+				if (paused || state.parent_type > component_index<ComponentTypes>) {
+					return;
+				}
+				auto& parents = get_components<ComponentTypes>();
+				for (; state.cursor < parents.position_count(); state.cursor++) {
+					if (budget == 0) {
+						state.parent_type = component_index<ComponentTypes>;
+						paused = true;
+						return;
+					}
+					budget--;
+					ID_TYPE parent_index = state.cursor;
+					if constexpr (is_packed_storage_v<component_storage_t<ComponentTypes>>) {
+						parent_index = parents.index_at_position(state.cursor);
+					} else if (!parents.has_index(state.cursor)) {
+						continue;
+					}
+					auto&& parent = parents.get_unchecked(parent_index);
+					bool patched = false;
+					std::apply([&visit, &patched](auto& ...childs) {
+						([&visit, &patched](auto& child) {
+							if constexpr (std::is_same_v<std::decay_t<decltype(child)>, handle<ComponentType>>) {
+								patched = visit(child) || patched;
+							}
+						}(childs), ...);
+					}, parent._handles);
+					if (patched) {
+						record_change<ComponentTypes>(parent_index, parent.consecutive_index, change_kind::modified);
+					}
+				}
+				state.parent_type = component_index<ComponentTypes> + 1;
+				state.cursor = 0;
+			}
+		}(), ...);
+		return !paused;
 	}
 
 	template<typename... ComponentTypes>
 	template<typename ComponentType>
-	void encomsys<ComponentTypes...>::for_each(void (*func)(ComponentType&)) {
-		for (component_wrapper<ComponentType>& t : get_components<ComponentType>()) {
-			func(t.get_value());
+	bool encomsys<ComponentTypes...>::run_compaction(std::size_t& budget, compaction_order order) {
+		constexpr bool has_parents = (__is_parent_of<ComponentTypes, ComponentType>::value || ...);
+		compaction_state& state = _compactions[component_index<ComponentType>];
+		auto& storage = get_components<ComponentType>();
+		const auto begin_phase = [&state, &storage](const compaction_phase phase) {
+			state.phase = phase;
+			state.target = storage.size();
+			state.parent_type = 0;
+			state.cursor = phase == compaction_phase::standalone ? state.target : 0;
+			state.hole = 0;
+		};
+		if (state.phase == compaction_phase::idle) {
+			std::get<component_index<ComponentType>>(_remaps).clear();
+			state.end = storage.slot_count();
+			const bool reorder = has_parents && order == compaction_order::parents;
+			if constexpr (is_packed_storage_v<component_storage_t<ComponentType>>) {
+				begin_phase(reorder ? compaction_phase::reorder : compaction_phase::shrink);
+			} else if constexpr (has_parents) {
+				begin_phase(reorder ? compaction_phase::evacuate : compaction_phase::childs);
+			} else {
+				begin_phase(compaction_phase::standalone);
+			}
+		}
+
+		if constexpr (is_packed_storage_v<component_storage_t<ComponentType>>) {
+			if (state.phase == compaction_phase::reorder) {
+				// state.hole is the first position, that is not in the order of the parents yet
+				const bool done = visit_parents<ComponentType>(state, budget, [this, &state, &storage](handle<ComponentType>& child) {
+					const ID_TYPE position = storage.position_of(child.array_index);
+					if (position >= state.hole) {
+						if (position != state.hole) {
+							invalidate_references<ComponentType>();
+							storage.swap_positions(position, state.hole);
+						}
+						state.hole++;
+					}
+					return false;
+				});
+				if (!done) {
+					return false;
+				}
+				begin_phase(compaction_phase::shrink);
+			}
+		} else {
+			if (state.phase == compaction_phase::evacuate) {
+				const bool done = visit_parents<ComponentType>(state, budget, [this, &state, &storage](handle<ComponentType>& child) {
+					if (child.array_index >= state.end || storage.get_unchecked(child.array_index).number_of_references != 1) {
+						return false;
+					}
+#ifdef ENCOM_COMPACT_HANDLES
+					if (storage.slot_count() > MAX_HANDLE_INDEX) {
+						return false;
+					}
+#endif
+					child = relocate<ComponentType>(child.array_index, storage.slot_count());
+					return true;
+				});
+				if (!done) {
+					return false;
+				}
+				begin_phase(compaction_phase::childs);
+			}
+			if (state.phase == compaction_phase::childs) {
+				const bool done = visit_parents<ComponentType>(state, budget, [this, &state, &storage](handle<ComponentType>& child) {
+					if (child.array_index < state.target || storage.get_unchecked(child.array_index).number_of_references != 1) {
+						return false;
+					}
+					state.hole = storage.find_empty(state.hole);
+					if (state.hole >= child.array_index) {
+						return false;
+					}
+					child = relocate<ComponentType>(child.array_index, state.hole++);
+					return true;
+				});
+				if (!done) {
+					return false;
+				}
+				begin_phase(compaction_phase::standalone);
+			}
+			if (state.phase == compaction_phase::standalone) {
+				// childs were moved by their parents, only unreferenced components are left
+				const ID_TYPE slot_count = storage.slot_count();
+				for (ID_TYPE index = storage.occupied().find_next(state.cursor, slot_count); index != slot_count; index = storage.occupied().find_next(index+1, slot_count)) {
+					if (budget == 0) {
+						state.cursor = index;
+						return false;
+					}
+					budget--;
+					if (storage.get_unchecked(index).number_of_references == 0) {
+						state.hole = storage.find_empty(state.hole);
+						if (state.hole < index) {
+							relocate<ComponentType>(index, state.hole++);
+						}
+					}
+				}
+				begin_phase(compaction_phase::shrink);
+			}
 		}
+
+		// the relocations of the other phases changed the epoch already, but shrinking reallocates even without holes
+		invalidate_references<ComponentType>();
+		storage.shrink_to_fit();
+		state.phase = compaction_phase::idle;
+		return true;
+	}
+
+	template<typename... ComponentTypes>
+	template<typename ComponentType>
+	bool encomsys<ComponentTypes...>::compact_step(std::size_t budget, compaction_order order) {
+		ENCOM_TRACE_SPAN("encomsys::compact_step");
+		return run_compaction<ComponentType>(budget, order);
 	}
 
 	template<typename... ComponentTypes>
 	template<typename ComponentType>
-	void encomsys<ComponentTypes...>::for_each(void (*func)(ComponentType&, encomsys& encomsys)) {
-		for (const component_wrapper<ComponentType>& t : get_components<ComponentType>()) {
-			func(t.value, *this);
+	void encomsys<ComponentTypes...>::compact(compaction_order order) {
+		while (!compact_step<ComponentType>(std::numeric_limits<std::size_t>::max(), order)) {}
+	}
+
+	template<typename... ComponentTypes>
+	bool encomsys<ComponentTypes...>::defragment_step(std::size_t budget, compaction_order order) {
+		ENCOM_TRACE_SPAN("encomsys::defragment_step");
+		bool paused = false;
+		([&]() {
+			if (!paused && _defragment_type == component_index<ComponentTypes>) {
+				if (run_compaction<ComponentTypes>(budget, order)) {
+					_defragment_type++;
+				} else {
+					paused = true;
+				}
+			}
+		}(), ...);
+		if (paused) {
+			return false;
 		}
+		_defragment_type = 0;
+		return true;
+	}
+
+	template<typename... ComponentTypes>
+	void encomsys<ComponentTypes...>::defragment(compaction_order order) {
+		while (!defragment_step(std::numeric_limits<std::size_t>::max(), order)) {}
 	}
 
 	template<typename... ComponentTypes>
 	template<typename ComponentType>
-	void encomsys<ComponentTypes...>::for_each(void (*func)(ComponentType&, const encomsys& encomsys)) {
-		for (const component_wrapper<ComponentType>& t : get_components<ComponentType>()) {
-			func(t.value, *this);
+	component_stats encomsys<ComponentTypes...>::stats() const {
+		const auto& storage = get_components<ComponentType>();
+		std::size_t payload_bytes_per_element = 0;
+		std::size_t metadata_bytes_per_element = 0;
+		if constexpr (is_soa_v<ComponentType>) {
+			payload_bytes_per_element = component_storage_t<ComponentType>::payload_bytes_per_element;
+			metadata_bytes_per_element = sizeof(GENERATION_TYPE) + sizeof(std::uint32_t);
+		} else {
+			if constexpr (is_relation_v<ComponentType>) {
+				payload_bytes_per_element = sizeof(stored_childs_t<ComponentType>);
+			} else {
+				payload_bytes_per_element = sizeof(ComponentType);
+			}
+			metadata_bytes_per_element = sizeof(component_wrapper<ComponentType>) - payload_bytes_per_element;
 		}
+
+		component_stats result {};
+		result.name = typeid(ComponentType).name();
+		result.live = storage.size();
+		result.capacity = storage.capacity();
+		result.holes = storage.slot_count() - storage.size();
+		result.payload_bytes = storage.size() * payload_bytes_per_element;
+		result.metadata_bytes = storage.size() * metadata_bytes_per_element;
+		result.allocated_bytes = storage.allocated_bytes();
+#ifndef ENCOM_NO_STATS
+		constexpr std::size_t type = component_index<ComponentType>;
+		result.adds = _counters.total(type, STATS_ADD);
+		result.removes = _counters.total(type, STATS_REMOVE);
+		result.gets = _counters.total(type, STATS_GET);
+		result.get_refs = _counters.total(type, STATS_GET_REF);
+		result.failed_has_element = _counters.total(type, STATS_FAILED_HAS_ELEMENT);
+#endif
+		return result;
+	}
+
+	template<typename... ComponentTypes>
+	std::array<component_stats, encomsys<ComponentTypes...>::number_of_component_types> encomsys<ComponentTypes...>::stats() const {
+		return std::array<component_stats, number_of_component_types> {stats<ComponentTypes>()...};
+	}
+
+	template<typename... ComponentTypes>
+	void encomsys<ComponentTypes...>::reset_stats() {
+#ifndef ENCOM_NO_STATS
+		_counters.reset();
+#endif
 	}
 
 	template<typename... ComponentTypes>
 	template<typename ComponentType>
-	void encomsys<ComponentTypes...>::for_each(void (*func)(const ComponentType&, const encomsys& encomsys)) const {
-		// TODO
+	handle<ComponentType> encomsys<ComponentTypes...>::remap(const handle<ComponentType>& h) const {
+		return std::get<component_index<ComponentType>>(_remaps).find(h);
+	}
+
+	template<typename... ComponentTypes>
+	void encomsys<ComponentTypes...>::attach_thread_pool(thread_pool& pool) {
+		_thread_pool = &pool;
+	}
+
+	template<typename... ComponentTypes>
+	thread_pool& encomsys<ComponentTypes...>::get_thread_pool() {
+		if (_thread_pool == nullptr) {
+			_owned_thread_pool = std::make_unique<thread_pool>();
+			_thread_pool = _owned_thread_pool.get();
+		}
+		return *_thread_pool;
 	}
 }
 
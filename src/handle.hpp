@@ -4,6 +4,26 @@
 #include "util/types.hpp"
 
 namespace encom {
+#ifdef ENCOM_COMPACT_HANDLES
+	/**
+	 * A handle packed into 32 bits. consecutive_index holds the generation of the slot at
+	 * array_index, when the component was added. The generation of a slot is increased, when its
+	 * component is removed, so stale handles are detected, until the generation wraps around.
+	 */
+	template<typename T>
+	struct handle {
+		std::uint32_t consecutive_index : HANDLE_GENERATION_BITS;
+		std::uint32_t array_index : HANDLE_INDEX_BITS;
+
+		handle(ID_TYPE consecutive_index, ID_TYPE array_index)
+			: consecutive_index(consecutive_index & GENERATION_MASK), array_index(array_index & MAX_HANDLE_INDEX)
+		{ }
+
+		handle()
+			: consecutive_index(0), array_index(0)
+		{ }
+	};
+#else
 	template<typename T>
 	struct handle {
 		ID_TYPE consecutive_index;
@@ -17,6 +37,7 @@ namespace encom {
 			: consecutive_index(0), array_index(0)
 		{ }
 	};
+#endif
 }
 
 #endif
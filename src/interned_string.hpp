@@ -0,0 +1,214 @@
+#ifndef __INTERNED_STRING_CLASS__
+#define __INTERNED_STRING_CLASS__
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "util/hash_index.hpp"
+#include "snapshot.hpp"
+
+namespace encom {
+	/**
+	 * Stores every distinct string once for the lifetime of the process. The characters are appended to
+	 * blocks behind their length and followed by a 0. They are never moved or freed, so an interned
+	 * string is a single pointer and two interned strings are equal, if their pointers are equal.
+	 * Interning locks the arena, reading interned strings does not.
+	 */
+	class string_arena {
+		private:
+			static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+			// strings longer than this get a block of their own, so the current block is not abandoned
+			static constexpr std::size_t MAX_SHARED_BLOCK_STRING = BLOCK_SIZE / 4;
+
+			mutable std::mutex _mutex;
+			std::vector<std::unique_ptr<char[]>> _blocks;
+			// the free bytes at the end of the current block
+			char* _cursor;
+			std::size_t _free;
+			std::size_t _allocated_bytes;
+			hash_index<std::string_view, const char*> _strings;
+
+			string_arena()
+				: _cursor(nullptr), _free(0), _allocated_bytes(0)
+			{}
+
+			char* allocate(const std::size_t number_of_bytes) {
+				if (number_of_bytes > MAX_SHARED_BLOCK_STRING) {
+					_blocks.push_back(std::make_unique<char[]>(number_of_bytes));
+					_allocated_bytes += number_of_bytes;
+					return _blocks.back().get();
+				}
+				if (number_of_bytes > _free) {
+					_blocks.push_back(std::make_unique<char[]>(BLOCK_SIZE));
+					_allocated_bytes += BLOCK_SIZE;
+					_cursor = _blocks.back().get();
+					_free = BLOCK_SIZE;
+				}
+				char* bytes = _cursor;
+				_cursor += number_of_bytes;
+				_free -= number_of_bytes;
+				return bytes;
+			}
+
+		public:
+			static string_arena& instance() {
+				static string_arena arena;
+				return arena;
+			}
+
+			/**
+			 * @returns the characters of the interned copy of s or nullptr for the empty string
+			 */
+			const char* intern(const std::string_view s) {
+				if (s.empty()) {
+					return nullptr;
+				}
+				if (s.size() > std::numeric_limits<std::uint32_t>::max()) {
+					throw "String is too long to be interned";
+				}
+				const std::uint64_t hash = hash_index<std::string_view, const char*>::hash_key(s);
+				std::lock_guard<std::mutex> lock(_mutex);
+				const char* const* found = _strings.find(hash, s);
+				if (found != nullptr) {
+					return *found;
+				}
+				const std::uint32_t length = std::uint32_t(s.size());
+				char* entry = allocate(sizeof(length) + s.size() + 1);
+				std::memcpy(entry, &length, sizeof(length));
+				char* chars = entry + sizeof(length);
+				std::memcpy(chars, s.data(), s.size());
+				chars[s.size()] = '\0';
+				_strings.insert(hash, std::string_view(chars, s.size()), chars);
+				return chars;
+			}
+
+			/**
+			 * @returns the length of the interned characters at chars
+			 */
+			static std::size_t length(const char* chars) {
+				std::uint32_t length;
+				std::memcpy(&length, chars - sizeof(length), sizeof(length));
+				return length;
+			}
+
+			/**
+			 * @returns the number of distinct interned strings
+			 */
+			std::size_t size() const {
+				std::lock_guard<std::mutex> lock(_mutex);
+				return _strings.size();
+			}
+
+			/**
+			 * @returns the bytes of all blocks, not counting the lookup table
+			 */
+			std::size_t allocated_bytes() const {
+				std::lock_guard<std::mutex> lock(_mutex);
+				return _allocated_bytes;
+			}
+	};
+
+	/**
+	 * An immutable string, whose characters are stored once in the string_arena. Copying and comparing
+	 * interned strings costs as much as copying and comparing a pointer, so components with repeated
+	 * names can use them instead of std::string, also as keys of a secondary_index or for deduplicate.
+	 */
+	class interned_string {
+		private:
+			// the characters in the string_arena or nullptr for the empty string
+			const char* _chars;
+
+		public:
+			interned_string()
+				: _chars(nullptr)
+			{}
+
+			interned_string(const std::string_view s)
+				: _chars(string_arena::instance().intern(s))
+			{}
+
+			interned_string(const std::string& s)
+				: interned_string(std::string_view(s))
+			{}
+
+			interned_string(const char* s)
+				: interned_string(std::string_view(s))
+			{}
+
+			// the pointer is only valid in this process, so interned strings must not be written to
+			// snapshots as raw bytes. The user provided copies make them not trivially copyable.
+			interned_string(const interned_string& other)
+				: _chars(other._chars)
+			{}
+
+			interned_string& operator=(const interned_string& other) {
+				_chars = other._chars;
+				return *this;
+			}
+
+			std::string_view view() const {
+				if (_chars == nullptr) {
+					return std::string_view();
+				}
+				return std::string_view(_chars, string_arena::length(_chars));
+			}
+
+			std::string str() const {
+				return std::string(view());
+			}
+
+			const char* c_str() const {
+				return _chars == nullptr ? "" : _chars;
+			}
+
+			std::size_t size() const {
+				return view().size();
+			}
+
+			bool empty() const {
+				return _chars == nullptr;
+			}
+
+			bool operator==(const interned_string& other) const {
+				return _chars == other._chars;
+			}
+
+			bool operator!=(const interned_string& other) const {
+				return _chars != other._chars;
+			}
+
+			/**
+			 * @returns the address of the characters, which identifies the string
+			 */
+			const void* id() const {
+				return _chars;
+			}
+	};
+
+	template<>
+	struct serializer<interned_string> {
+		static void write(snapshot_writer& out, const interned_string& s) {
+			out.write_string(s.str());
+		}
+
+		static interned_string read(snapshot_reader& in) {
+			return interned_string(in.read_string());
+		}
+	};
+}
+
+template<>
+struct std::hash<encom::interned_string> {
+	std::size_t operator()(const encom::interned_string& s) const {
+		return std::hash<const void*>()(s.id());
+	}
+};
+
+#endif
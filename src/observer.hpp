@@ -0,0 +1,140 @@
+#ifndef __OBSERVER_CLASS__
+#define __OBSERVER_CLASS__
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "util/types.hpp"
+#include "handle.hpp"
+
+namespace encom {
+	enum observer_event : std::size_t {
+		OBSERVE_ADD = 0,
+		OBSERVE_REMOVE = 1,
+		OBSERVE_MODIFY = 2,
+		NUMBER_OF_OBSERVER_EVENTS = 3,
+	};
+
+	using observer_id = std::uint64_t;
+
+	/**
+	 * The observers of one component type. An observer is either called immediately with the handle of
+	 * every event, or it is batched: the handles are collected and handed to the observer as one array
+	 * by dispatch(). Notifying an event without observers costs a single branch.
+	 */
+	template<typename ComponentType>
+	class observer_list {
+		public:
+			using immediate_observer = std::function<void(const handle<ComponentType>&)>;
+			using batched_observer = std::function<void(const handle<ComponentType>*, std::size_t)>;
+
+		private:
+			template<typename Observer>
+			struct entry {
+				observer_id id;
+				Observer observer;
+			};
+
+			// bit i is set, if there is an observer for the event i
+			unsigned _active;
+			std::array<std::vector<entry<immediate_observer>>, NUMBER_OF_OBSERVER_EVENTS> _immediate;
+			std::array<std::vector<entry<batched_observer>>, NUMBER_OF_OBSERVER_EVENTS> _batched;
+			// the handles of the events, that were not dispatched to the batched observers yet
+			std::array<std::vector<handle<ComponentType>>, NUMBER_OF_OBSERVER_EVENTS> _pending;
+
+			void update_active(const observer_event event) {
+				if (_immediate[event].empty() && _batched[event].empty()) {
+					_active &= ~(1u << event);
+				} else {
+					_active |= 1u << event;
+				}
+			}
+
+			void notify_observers(const observer_event event, const handle<ComponentType>& target) {
+				for (const entry<immediate_observer>& e : _immediate[event]) {
+					e.observer(target);
+				}
+				if (!_batched[event].empty()) {
+					_pending[event].push_back(target);
+				}
+			}
+
+		public:
+			observer_list()
+				: _active(0)
+			{}
+
+			/**
+			 * Adds an observer for the given event. Observers callable with (const handle<ComponentType>*,
+			 * std::size_t) are batched, all other observers are called with const handle<ComponentType>&.
+			 */
+			template<typename Func>
+			void add(const observer_event event, const observer_id id, Func&& func) {
+				if constexpr (std::is_invocable_v<Func&, const handle<ComponentType>*, std::size_t>) {
+					_batched[event].push_back(entry<batched_observer> {id, batched_observer(std::forward<Func>(func))});
+				} else {
+					_immediate[event].push_back(entry<immediate_observer> {id, immediate_observer(std::forward<Func>(func))});
+				}
+				update_active(event);
+			}
+
+			/**
+			 * @returns whether an observer with the given id was removed
+			 */
+			bool remove(const observer_id id) {
+				bool removed = false;
+				for (std::size_t event = 0; event < NUMBER_OF_OBSERVER_EVENTS; event++) {
+					const std::size_t immediate_size = _immediate[event].size();
+					const std::size_t batched_size = _batched[event].size();
+					_immediate[event].erase(
+						std::remove_if(_immediate[event].begin(), _immediate[event].end(), [id](const entry<immediate_observer>& e) { return e.id == id; }),
+						_immediate[event].end()
+					);
+					_batched[event].erase(
+						std::remove_if(_batched[event].begin(), _batched[event].end(), [id](const entry<batched_observer>& e) { return e.id == id; }),
+						_batched[event].end()
+					);
+					removed = removed || immediate_size != _immediate[event].size() || batched_size != _batched[event].size();
+					if (_batched[event].empty()) {
+						_pending[event].clear();
+					}
+					update_active(observer_event(event));
+				}
+				return removed;
+			}
+
+			void notify(const observer_event event, const handle<ComponentType>& target) {
+				if (_active & (1u << event)) {
+					notify_observers(event, target);
+				}
+			}
+
+			/**
+			 * Hands the collected handles of every event to the batched observers.
+			 */
+			void dispatch() {
+				for (std::size_t event = 0; event < NUMBER_OF_OBSERVER_EVENTS; event++) {
+					if (_pending[event].empty()) {
+						continue;
+					}
+					// events caused by the observers are dispatched by the next call
+					std::vector<handle<ComponentType>> handles;
+					std::swap(handles, _pending[event]);
+					for (const entry<batched_observer>& e : _batched[event]) {
+						e.observer(handles.data(), handles.size());
+					}
+					handles.clear();
+					if (_pending[event].empty()) {
+						// keep the memory for the next tick
+						std::swap(handles, _pending[event]);
+					}
+				}
+			}
+	};
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <tuple>
 #include "handle.hpp"
+#include "soa.hpp"
 
 namespace encom {
 	struct __relation_tag {};
@@ -16,7 +17,9 @@ namespace encom {
 	inline constexpr bool is_relation_v = is_relation<T>::value;
 
 	/**
-	 * relation_ref_expander transforms every relation R to R::as_ref and any other type T to T&
+	 * relation_ref_expander transforms every relation R to R::as_ref, every structure-of-arrays
+	 * component S to soa_ref<S> and any other type T to T& (const T& for deduplicated types, see
+	 * dedup.hpp)
 	 */
 	template<typename T, typename S=void>
 	struct relation_ref_expander {
@@ -28,6 +31,11 @@ namespace encom {
 		using type = typename T::as_ref;
 	};
 
+	template<typename T>
+	struct relation_ref_expander<T, std::enable_if_t<is_soa_v<T>>> {
+		using type = soa_ref<T>;
+	};
+
 	template<typename T>
 	using relation_ref_expander_t = typename relation_ref_expander<T>::type;
 
@@ -44,6 +52,7 @@ namespace encom {
 
 		// type definitions
 		using __component_handles = std::tuple<handle<ComponentTypes>...>;
+		using __component_types = std::tuple<ComponentTypes...>;
 
 		struct as_ref : public std::tuple<relation_ref_expander_t<ComponentTypes>...> {
 			as_ref(const std::tuple<relation_ref_expander_t<ComponentTypes>...>& t) : std::tuple<relation_ref_expander_t<ComponentTypes>...>(t) {}
@@ -98,7 +107,7 @@ namespace encom {
 
 		template<typename ...Ts>
 		__last<Ts...>& get() {
-			return const_cast<const relation<ComponentTypes...>&>(*this).get<Ts...>();
+			return const_cast<__last<Ts...>&>(const_cast<const relation<ComponentTypes...>&>(*this).get<Ts...>());
 		}
 
 		template<typename ...Ts>
@@ -107,6 +116,51 @@ namespace encom {
 			return get_helper<0, Ts...>(std::get<CurrentComponentType>(*this));
 		}
 	};
+
+	/**
+	 * Stores the plain child components of a relation type inside the slot of the relation instead of
+	 * in the storages of the child types. Specialize this to enable it, e.g.
+	 *
+	 *   template<> struct encom::inline_childs<player_relation> : std::true_type {};
+	 *
+	 * Reading an inline child costs no handle validation and no access to another storage. Inline
+	 * childs are owned by their relation and are no components of their own: they have no handles,
+	 * are not visited by for_each() of their type, do not notify the observers of their type and are
+	 * not part of the indexes of their type. Relations and structure-of-arrays childs are still stored
+	 * in their own storages and referenced by handles, so they can be shared with other relations.
+	 */
+	template<typename RelationType, typename __Specialization=void>
+	struct inline_childs : std::false_type {};
+
+	template<typename RelationType>
+	inline constexpr bool inline_childs_v = inline_childs<RelationType>::value;
+
+	/**
+	 * Whether the child of type ChildType is stored inside the slot of RelationType
+	 */
+	template<typename RelationType, typename ChildType>
+	inline constexpr bool is_inline_child_v = inline_childs_v<RelationType> && !is_relation_v<ChildType> && !is_soa_v<ChildType>;
+
+	/**
+	 * What the slot of RelationType holds for a child of type ChildType: the child itself, if it is
+	 * inline, otherwise its handle
+	 */
+	template<typename RelationType, typename ChildType>
+	using stored_child_t = std::conditional_t<is_inline_child_v<RelationType, ChildType>, ChildType, handle<ChildType>>;
+
+	template<typename RelationType, typename ComponentTypes = typename RelationType::__component_types>
+	struct __stored_childs;
+
+	template<typename RelationType, typename ...ComponentTypes>
+	struct __stored_childs<RelationType, std::tuple<ComponentTypes...>> {
+		using type = std::tuple<stored_child_t<RelationType, ComponentTypes>...>;
+	};
+
+	/**
+	 * The childs in the slot of a relation. Without inline_childs this is RelationType::__component_handles.
+	 */
+	template<typename RelationType>
+	using stored_childs_t = typename __stored_childs<RelationType>::type;
 }
 
 #endif
@@ -0,0 +1,325 @@
+#ifndef __SCHEDULER_CLASS__
+#define __SCHEDULER_CLASS__
+
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "relation.hpp"
+#include "tracing.hpp"
+#include "util/thread_pool.hpp"
+
+namespace encom {
+	/**
+	 * Lists the component and relation types, that a system reads.
+	 */
+	template<typename ...ComponentTypes>
+	struct reads {};
+
+	/**
+	 * Lists the component and relation types, that a system writes.
+	 */
+	template<typename ...ComponentTypes>
+	struct writes {};
+
+	/**
+	 * The set of component types of an encomsys, that a system accesses.
+	 * Accessing a relation implies accessing all of its child components and relations.
+	 */
+	template<typename Encomsys>
+	struct __access_set {
+		using type = std::bitset<Encomsys::number_of_component_types>;
+
+		template<typename ComponentType>
+		static void expand(type* set) {
+			set->set(Encomsys::template component_index<ComponentType>);
+			if constexpr (is_relation_v<ComponentType>) {
+				expand_tuple(set, static_cast<typename ComponentType::__component_types*>(nullptr));
+			}
+		}
+
+		template<typename ...ComponentTypes>
+		static void expand_tuple(type* set, std::tuple<ComponentTypes...>*) {
+			(expand<ComponentTypes>(set), ...);
+		}
+
+		template<template<typename...> typename List, typename ...ComponentTypes>
+		static type of(List<ComponentTypes...>*) {
+			type set;
+			(expand<ComponentTypes>(&set), ...);
+			return set;
+		}
+	};
+
+	/**
+	 * The measured execution of a system in the last tick.
+	 */
+	struct system_timing {
+		std::string name;
+		// times are relative to the start of the tick
+		double start_ms;
+		double duration_ms;
+		std::size_t worker_index;
+	};
+
+	/**
+	 * Runs systems, that operate on an encomsys. Every system declares the component types it reads
+	 * and writes. Each tick the scheduler builds a dependency graph from these declarations: a system
+	 * depends on an earlier registered system, if one of them writes a type the other one accesses.
+	 * Systems without dependencies between them run concurrently on a thread pool. Idle workers steal
+	 * ready systems from the other workers and sleep, while no system is ready.
+	 */
+	template<typename Encomsys>
+	class scheduler {
+		private:
+			using access_set = typename __access_set<Encomsys>::type;
+
+			struct system {
+				std::string name;
+				std::function<void(Encomsys&)> func;
+				access_set reads;
+				access_set writes;
+#ifdef ENCOM_TRACING
+				// the span name of the system
+				std::uint32_t trace_point;
+#endif
+			};
+
+			struct worker_queue {
+				std::mutex mutex;
+				std::deque<std::size_t> systems;
+			};
+
+			Encomsys* _encomsys;
+			thread_pool* _thread_pool;
+			std::vector<system> _systems;
+			std::vector<std::vector<std::size_t>> _dependents;
+			std::vector<std::size_t> _number_of_dependencies;
+			std::vector<system_timing> _timings;
+
+			bool conflicts(const system& first, const system& second) const {
+				return (first.writes & (second.reads | second.writes)).any() || (second.writes & first.reads).any();
+			}
+
+			void build_graph() {
+				_dependents.assign(_systems.size(), {});
+				_number_of_dependencies.assign(_systems.size(), 0);
+				for (std::size_t later = 0; later < _systems.size(); later++) {
+					for (std::size_t earlier = 0; earlier < later; earlier++) {
+						if (conflicts(_systems[earlier], _systems[later])) {
+							_dependents[earlier].push_back(later);
+							_number_of_dependencies[later]++;
+						}
+					}
+				}
+			}
+
+		public:
+			/**
+			 * @param encomsys The encomsys, that is passed to every system
+			 * @param pool The thread pool to run the systems on. Has to outlive the scheduler.
+			 */
+			scheduler(Encomsys& encomsys, thread_pool& pool)
+				: _encomsys(&encomsys), _thread_pool(&pool)
+			{}
+
+			/**
+			 * Registers a system. Systems, that conflict with each other, run in registration order.
+			 *
+			 * @tparam Reads encom::reads<...> listing the types the system reads
+			 * @tparam Writes encom::writes<...> listing the types the system writes
+			 * @param name The name of the system used in the timings and as span name with ENCOM_TRACING
+			 * @param func The system
+			 * @returns the index of the system
+			 */
+			template<typename Reads = reads<>, typename Writes = writes<>>
+			std::size_t add_system(const std::string& name, std::function<void(Encomsys&)> func) {
+				_systems.push_back(system {
+					name,
+					std::move(func),
+					__access_set<Encomsys>::of(static_cast<Reads*>(nullptr)),
+					__access_set<Encomsys>::of(static_cast<Writes*>(nullptr))
+#ifdef ENCOM_TRACING
+					, tracer::instance().point(name)
+#endif
+				});
+				return _systems.size() - 1;
+			}
+
+			/**
+			 * Runs every registered system once and returns, when all systems are done.
+			 */
+			void run() {
+				build_graph();
+				const std::size_t number_of_systems = _systems.size();
+				_timings.assign(number_of_systems, system_timing {});
+				if (number_of_systems == 0) {
+					return;
+				}
+
+				std::unique_ptr<std::atomic<std::size_t>[]> open_dependencies(new std::atomic<std::size_t>[number_of_systems]);
+				for (std::size_t i = 0; i < number_of_systems; i++) {
+					open_dependencies[i].store(_number_of_dependencies[i], std::memory_order_relaxed);
+				}
+				std::atomic<std::size_t> remaining(number_of_systems);
+
+				const std::size_t number_of_workers = _thread_pool->inside_job() ? 1 : _thread_pool->size();
+				std::unique_ptr<worker_queue[]> queues(new worker_queue[number_of_workers]);
+				std::size_t next_queue = 0;
+				for (std::size_t i = 0; i < number_of_systems; i++) {
+					if (_number_of_dependencies[i] == 0) {
+						queues[next_queue].systems.push_back(i);
+						next_queue = (next_queue + 1) % number_of_workers;
+					}
+				}
+
+				// idle workers wait for a change of wake_epoch, that is increased, whenever systems were queued
+				std::mutex wake_mutex;
+				std::condition_variable wake;
+				std::atomic<std::size_t> wake_epoch(0);
+
+				const auto tick_start = std::chrono::steady_clock::now();
+
+				auto pop = [&](const std::size_t worker_index, std::size_t* system_index) {
+					for (std::size_t offset = 0; offset < number_of_workers; offset++) {
+						const bool own = offset == 0;
+						worker_queue& queue = queues[(worker_index + offset) % number_of_workers];
+						std::lock_guard<std::mutex> lock(queue.mutex);
+						if (!queue.systems.empty()) {
+							// take the newest work from the own queue and the oldest from other queues
+							if (own) {
+								*system_index = queue.systems.back();
+								queue.systems.pop_back();
+							} else {
+								*system_index = queue.systems.front();
+								queue.systems.pop_front();
+							}
+							return true;
+						}
+					}
+					return false;
+				};
+
+				const std::function<void(std::size_t)> job = [&](const std::size_t worker_index) {
+					if (worker_index >= number_of_workers) {
+						return;
+					}
+					std::size_t system_index = 0;
+					while (remaining.load(std::memory_order_acquire) != 0) {
+						// read before searching, so systems queued during the search end the wait
+						const std::size_t seen_epoch = wake_epoch.load(std::memory_order_acquire);
+						if (!pop(worker_index, &system_index)) {
+							std::unique_lock<std::mutex> lock(wake_mutex);
+							wake.wait(lock, [&]() {
+								return wake_epoch.load(std::memory_order_relaxed) != seen_epoch || remaining.load(std::memory_order_acquire) == 0;
+							});
+							continue;
+						}
+
+						const auto start = std::chrono::steady_clock::now();
+						{
+#ifdef ENCOM_TRACING
+							const trace_span span(_systems[system_index].trace_point);
+#endif
+							_systems[system_index].func(*_encomsys);
+						}
+						const auto stop = std::chrono::steady_clock::now();
+						_timings[system_index] = system_timing {
+							_systems[system_index].name,
+							std::chrono::duration<double, std::milli>(start - tick_start).count(),
+							std::chrono::duration<double, std::milli>(stop - start).count(),
+							worker_index
+						};
+
+						std::size_t number_of_ready = 0;
+						for (const std::size_t dependent : _dependents[system_index]) {
+							if (open_dependencies[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+								std::lock_guard<std::mutex> lock(queues[worker_index].mutex);
+								queues[worker_index].systems.push_back(dependent);
+								number_of_ready++;
+							}
+						}
+						const bool last = remaining.fetch_sub(1, std::memory_order_acq_rel) == 1;
+						if (number_of_ready != 0 || last) {
+							{
+								std::lock_guard<std::mutex> lock(wake_mutex);
+								wake_epoch.fetch_add(1, std::memory_order_release);
+							}
+							if (last) {
+								wake.notify_all();
+							} else {
+								// this worker takes one of the ready systems itself
+								for (std::size_t i = 1; i < number_of_ready; i++) {
+									wake.notify_one();
+								}
+							}
+						}
+					}
+				};
+
+				if (number_of_workers == 1) {
+					job(0);
+				} else {
+					_thread_pool->run(job);
+				}
+			}
+
+			/**
+			 * @returns the timings of every system in the last tick, in registration order
+			 */
+			const std::vector<system_timing>& timings() const {
+				return _timings;
+			}
+
+			/**
+			 * @returns the indices of the systems on the longest chain of dependent systems in the last
+			 * 			tick, weighted by their measured duration
+			 */
+			std::vector<std::size_t> critical_path() const {
+				const std::size_t number_of_systems = _timings.size();
+				if (number_of_systems == 0) {
+					return {};
+				}
+				// systems only depend on earlier registered systems, so registration order is a topological order
+				std::vector<double> finish(number_of_systems, 0.0);
+				std::vector<std::size_t> predecessor(number_of_systems, number_of_systems);
+				for (std::size_t i = 0; i < number_of_systems; i++) {
+					finish[i] += _timings[i].duration_ms;
+					for (const std::size_t dependent : _dependents[i]) {
+						if (finish[i] > finish[dependent]) {
+							finish[dependent] = finish[i];
+							predecessor[dependent] = i;
+						}
+					}
+				}
+				std::size_t last = std::max_element(finish.begin(), finish.end()) - finish.begin();
+				std::vector<std::size_t> path;
+				for (std::size_t i = last; i != number_of_systems; i = predecessor[i]) {
+					path.push_back(i);
+				}
+				std::reverse(path.begin(), path.end());
+				return path;
+			}
+
+			/**
+			 * @returns the summed duration of the systems on the critical path of the last tick
+			 */
+			double critical_path_ms() const {
+				double duration = 0.0;
+				for (const std::size_t i : critical_path()) {
+					duration += _timings[i].duration_ms;
+				}
+				return duration;
+			}
+	};
+}
+
+#endif
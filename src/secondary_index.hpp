@@ -0,0 +1,169 @@
+#ifndef __SECONDARY_INDEX_CLASS__
+#define __SECONDARY_INDEX_CLASS__
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "util/types.hpp"
+#include "util/hash_index.hpp"
+#include "relation.hpp"
+
+namespace encom {
+	/**
+	 * Declares a secondary index, that finds the components or relations of a type by the value of a
+	 * field in O(1). Specialize this with unique_key or multi_key, e.g.
+	 *
+	 *   template<> struct encom::secondary_index<player_relation> : encom::unique_key<&player_name_t::name> {};
+	 *
+	 * The field either belongs to the type itself or, for relations, to a direct child. The key of a
+	 * relation is read, when the relation is added. modify() and patch() of a component update its key
+	 * and the keys of the relations, that reference it as key child, and throw without changing
+	 * anything, if a new unique key is taken. Writes to the key through get_ref(), views, for_each() or
+	 * to inline childs are not seen by the index. Types without an index pay nothing.
+	 */
+	template<typename ComponentType, typename __Specialization=void>
+	struct secondary_index {
+		static constexpr bool enabled = false;
+	};
+
+	/**
+	 * An index, in which every key belongs to at most one component. Adding a second component with
+	 * the same key throws.
+	 */
+	template<auto Member>
+	struct unique_key {
+		static constexpr bool enabled = true;
+		static constexpr bool unique = true;
+		static constexpr auto member = Member;
+	};
+
+	/**
+	 * An index, in which a key can belong to any number of components.
+	 */
+	template<auto Member>
+	struct multi_key {
+		static constexpr bool enabled = true;
+		static constexpr bool unique = false;
+		static constexpr auto member = Member;
+	};
+
+	template<typename ComponentType>
+	inline constexpr bool has_secondary_index_v = secondary_index<ComponentType>::enabled;
+
+	template<typename MemberPointer>
+	struct __member_pointer;
+
+	template<typename Class, typename Value>
+	struct __member_pointer<Value Class::*> {
+		using class_type = Class;
+		using value_type = Value;
+	};
+
+	/**
+	 * The type, whose field is the key of the index of ComponentType
+	 */
+	template<typename ComponentType>
+	using secondary_index_owner_t = typename __member_pointer<std::decay_t<decltype(secondary_index<ComponentType>::member)>>::class_type;
+
+	template<typename ComponentType>
+	using secondary_index_key_t = typename __member_pointer<std::decay_t<decltype(secondary_index<ComponentType>::member)>>::value_type;
+
+	/**
+	 * Whether the key of the secondary index of RelationType is a field of ChildType, that is
+	 * referenced by handle, so changing a ChildType through modify() changes the key of the relation.
+	 */
+	template<typename RelationType, typename ChildType, typename __Specialization=void>
+	struct __is_keyed_by : std::false_type {};
+
+	template<typename RelationType, typename ChildType>
+	struct __is_keyed_by<RelationType, ChildType, std::enable_if_t<is_relation_v<RelationType> && has_secondary_index_v<RelationType>>>
+		: std::bool_constant<
+			std::is_same_v<secondary_index_owner_t<RelationType>, ChildType> && !is_inline_child_v<RelationType, ChildType>
+		> {};
+
+	/**
+	 * The index of a type without secondary_index
+	 */
+	template<typename ComponentType, typename __Specialization=void>
+	class index_table {};
+
+	/**
+	 * Maps the keys of the indexed components to their array indices. The hash of every indexed slot
+	 * is kept, so a slot is erased without reading its key again, e.g. after the childs of a relation
+	 * were removed.
+	 */
+	template<typename ComponentType>
+	class index_table<ComponentType, std::enable_if_t<has_secondary_index_v<ComponentType>>> {
+		public:
+			using key_type = secondary_index_key_t<ComponentType>;
+			static constexpr bool unique = secondary_index<ComponentType>::unique;
+
+		private:
+			hash_index<key_type, ID_TYPE> _map;
+			std::vector<std::uint64_t> _slot_hashes;
+
+		public:
+			/**
+			 * Indexes the slot at array_index with key.
+			 *
+			 * @returns false, if the index is unique and key belongs to another slot already
+			 */
+			bool insert(const ID_TYPE array_index, const key_type& key) {
+				const std::uint64_t hash = hash_index<key_type, ID_TYPE>::hash_key(key);
+				if constexpr (unique) {
+					if (_map.find(hash, key) != nullptr) {
+						return false;
+					}
+				}
+				_map.insert(hash, key, array_index);
+				if (_slot_hashes.size() <= array_index) {
+					_slot_hashes.resize(array_index + 1);
+				}
+				_slot_hashes[array_index] = hash;
+				return true;
+			}
+
+			void erase(const ID_TYPE array_index) {
+				_map.erase(_slot_hashes[array_index], array_index);
+			}
+
+			/**
+			 * @returns whether the index is unique and key belongs to another slot than array_index
+			 */
+			bool conflicts(const ID_TYPE array_index, const key_type& key) const {
+				if constexpr (unique) {
+					const ID_TYPE* found = find(key);
+					return found != nullptr && *found != array_index;
+				} else {
+					return false;
+				}
+			}
+
+			/**
+			 * @returns a pointer to the array index of a slot with key or nullptr, if there is no such slot
+			 */
+			const ID_TYPE* find(const key_type& key) const {
+				return _map.find(hash_index<key_type, ID_TYPE>::hash_key(key), key);
+			}
+
+			/**
+			 * Calls func(array_index) for every slot with key.
+			 */
+			template<typename Func>
+			void find_all(const key_type& key, Func&& func) const {
+				_map.find_all(hash_index<key_type, ID_TYPE>::hash_key(key), key, std::forward<Func>(func));
+			}
+
+			void clear() {
+				_map.clear();
+				_slot_hashes.clear();
+			}
+
+			std::size_t size() const {
+				return _map.size();
+			}
+	};
+}
+
+#endif
@@ -0,0 +1,477 @@
+#ifndef __SNAPSHOT_CLASS__
+#define __SNAPSHOT_CLASS__
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "util/types.hpp"
+#include "handle.hpp"
+#include "relation.hpp"
+#include "storage.hpp"
+
+namespace encom {
+	// the version of the snapshot format written by encomsys::save()
+	constexpr std::uint32_t SNAPSHOT_VERSION = 2;
+	// the alignment of every block in a snapshot file
+	constexpr std::uint64_t SNAPSHOT_ALIGNMENT = 64;
+
+	/**
+	 * Appends binary data to a buffer. Passed to serializer<T>::write().
+	 */
+	class snapshot_writer {
+		private:
+			std::vector<char>* _buffer;
+
+		public:
+			explicit snapshot_writer(std::vector<char>* buffer)
+				: _buffer(buffer)
+			{}
+
+			void write_bytes(const void* data, const std::size_t number_of_bytes) {
+				const char* bytes = static_cast<const char*>(data);
+				_buffer->insert(_buffer->end(), bytes, bytes + number_of_bytes);
+			}
+
+			template<typename T>
+			void write(const T& value) {
+				static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be written directly");
+				write_bytes(&value, sizeof(T));
+			}
+
+			/**
+			 * Writes the length of the string followed by its characters.
+			 */
+			void write_string(const std::string& value) {
+				write(std::uint64_t(value.size()));
+				write_bytes(value.data(), value.size());
+			}
+	};
+
+	/**
+	 * Reads binary data written by a snapshot_writer. Passed to serializer<T>::read().
+	 */
+	class snapshot_reader {
+		private:
+			const char* _cursor;
+			const char* _end;
+
+		public:
+			snapshot_reader(const char* begin, const char* end)
+				: _cursor(begin), _end(end)
+			{}
+
+			void read_bytes(void* data, const std::size_t number_of_bytes) {
+				if (number_of_bytes > std::size_t(_end - _cursor)) {
+					throw "Snapshot is truncated";
+				}
+				std::memcpy(data, _cursor, number_of_bytes);
+				_cursor += number_of_bytes;
+			}
+
+			template<typename T>
+			T read() {
+				static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be read directly");
+				alignas(T) unsigned char bytes[sizeof(T)];
+				read_bytes(bytes, sizeof(T));
+				return *std::launder(reinterpret_cast<T*>(bytes));
+			}
+
+			std::string read_string() {
+				const std::uint64_t length = read<std::uint64_t>();
+				if (length > std::uint64_t(_end - _cursor)) {
+					throw "Snapshot is truncated";
+				}
+				std::string value(_cursor, length);
+				_cursor += length;
+				return value;
+			}
+	};
+
+	template<typename T>
+	constexpr bool __always_false_v = false;
+
+	/**
+	 * Writes and reads components, that are not trivially copyable, in snapshots. Specialize this for
+	 * every such component type, e.g.
+	 *
+	 *   template<> struct encom::serializer<player_name_t> {
+	 *       static void write(encom::snapshot_writer& out, const player_name_t& name) { out.write_string(name.name); }
+	 *       static player_name_t read(encom::snapshot_reader& in) { return player_name_t(in.read_string()); }
+	 *   };
+	 */
+	template<typename T, typename __Specialization=void>
+	struct serializer {
+		static_assert(__always_false_v<T>, "Specialize encom::serializer for components, that are not trivially copyable");
+
+		static void write(snapshot_writer&, const T&);
+		static T read(snapshot_reader&);
+	};
+
+	struct snapshot_header {
+		char magic[8];
+		std::uint32_t version;
+		// 0 for 64 bit handles, otherwise the number of index bits of compact handles
+		std::uint32_t handle_index_bits;
+		std::uint64_t number_of_sections;
+		std::uint64_t next_consecutive_id;
+	};
+
+	/**
+	 * How the data block of a section is encoded.
+	 */
+	enum class snapshot_encoding : std::uint32_t {
+		// the raw slots of an index_vector, that are used in place
+		slots = 0,
+		// one record per element: index, consecutive index, number of references and the value
+		records = 1,
+	};
+
+	enum snapshot_block : std::size_t {
+		SNAPSHOT_DATA = 0,
+		SNAPSHOT_OCCUPANCY = 1,
+		SNAPSHOT_GENERATIONS = 2,
+		NUMBER_OF_SNAPSHOT_BLOCKS = 3,
+	};
+
+	/**
+	 * Describes the storage of one component type. The blocks are stored at 64 byte aligned offsets
+	 * behind the section table.
+	 */
+	struct snapshot_section {
+		std::uint32_t component_index;
+		snapshot_encoding encoding;
+		std::uint64_t element_size;
+		std::uint64_t slot_count;
+		std::uint64_t size;
+		std::uint64_t free_head;
+		std::uint64_t offsets[NUMBER_OF_SNAPSHOT_BLOCKS];
+		std::uint64_t bytes[NUMBER_OF_SNAPSHOT_BLOCKS];
+	};
+
+	/**
+	 * The blocks of a section, that are written by write_snapshot(). Record sections own their data.
+	 */
+	struct snapshot_payload {
+		std::array<const void*, NUMBER_OF_SNAPSHOT_BLOCKS> blocks {};
+		std::vector<char> records;
+	};
+
+	/**
+	 * A file mapped copy-on-write into memory. Writes to the mapping are never written back to the file.
+	 * The file must not be modified in place while it is mapped, pages, that were not written yet,
+	 * would see the changes.
+	 */
+	class mapped_file {
+		private:
+			char* _data;
+			std::size_t _size;
+
+		public:
+			explicit mapped_file(const std::string& path)
+				: _data(nullptr), _size(0)
+			{
+				const int fd = ::open(path.c_str(), O_RDONLY);
+				if (fd < 0) {
+					throw "Could not open snapshot";
+				}
+				struct stat status;
+				if (::fstat(fd, &status) != 0 || status.st_size < off_t(sizeof(snapshot_header))) {
+					::close(fd);
+					throw "Snapshot is truncated";
+				}
+				_size = status.st_size;
+				void* data = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+				::close(fd);
+				if (data == MAP_FAILED) {
+					throw "Could not map snapshot";
+				}
+				_data = static_cast<char*>(data);
+			}
+
+			mapped_file(const mapped_file&) = delete;
+			mapped_file& operator=(const mapped_file&) = delete;
+
+			~mapped_file() {
+				::munmap(_data, _size);
+			}
+
+			char* data() const {
+				return _data;
+			}
+
+			std::size_t size() const {
+				return _size;
+			}
+	};
+
+	inline std::uint64_t __snapshot_align(const std::uint64_t offset) {
+		return (offset + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT;
+	}
+
+	/**
+	 * Writes a snapshot file. The offsets of the given sections are assigned here.
+	 */
+	inline void write_snapshot(
+		const std::string& path,
+		const ID_TYPE next_consecutive_id,
+		snapshot_section* sections,
+		const snapshot_payload* payloads,
+		const std::size_t number_of_sections
+	) {
+		std::uint64_t offset = __snapshot_align(sizeof(snapshot_header) + number_of_sections * sizeof(snapshot_section));
+		for (std::size_t i = 0; i < number_of_sections; i++) {
+			for (std::size_t block = 0; block < NUMBER_OF_SNAPSHOT_BLOCKS; block++) {
+				sections[i].offsets[block] = offset;
+				offset = __snapshot_align(offset + sections[i].bytes[block]);
+			}
+		}
+
+		// the file is written next to path and renamed, so encomsyses, that use an older snapshot at
+		// path, keep their mapping of the old file
+		const std::string temporary_path = path + ".tmp";
+		std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+		if (!out) {
+			throw "Could not open snapshot";
+		}
+		snapshot_header header {};
+		std::memcpy(header.magic, "ENCOMSYS", sizeof(header.magic));
+		header.version = SNAPSHOT_VERSION;
+#ifdef ENCOM_COMPACT_HANDLES
+		header.handle_index_bits = HANDLE_INDEX_BITS;
+#else
+		header.handle_index_bits = 0;
+#endif
+		header.number_of_sections = number_of_sections;
+		header.next_consecutive_id = next_consecutive_id;
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(reinterpret_cast<const char*>(sections), number_of_sections * sizeof(snapshot_section));
+
+		static const char padding[SNAPSHOT_ALIGNMENT] = {};
+		std::uint64_t written = sizeof(snapshot_header) + number_of_sections * sizeof(snapshot_section);
+		for (std::size_t i = 0; i < number_of_sections; i++) {
+			for (std::size_t block = 0; block < NUMBER_OF_SNAPSHOT_BLOCKS; block++) {
+				out.write(padding, sections[i].offsets[block] - written);
+				out.write(static_cast<const char*>(payloads[i].blocks[block]), sections[i].bytes[block]);
+				written = sections[i].offsets[block] + sections[i].bytes[block];
+			}
+		}
+		out.write(padding, offset - written);
+		out.close();
+		if (!out || std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+			std::remove(temporary_path.c_str());
+			throw "Could not write snapshot";
+		}
+	}
+
+	/**
+	 * Validates the header and the section table of a mapped snapshot.
+	 *
+	 * @returns the section table
+	 */
+	inline const snapshot_section* read_snapshot_sections(const mapped_file& file, const std::size_t number_of_sections) {
+		const snapshot_header* header = reinterpret_cast<const snapshot_header*>(file.data());
+		if (std::memcmp(header->magic, "ENCOMSYS", sizeof(header->magic)) != 0) {
+			throw "File is not a snapshot";
+		}
+		if (header->version != SNAPSHOT_VERSION) {
+			throw "Unsupported snapshot version";
+		}
+#ifdef ENCOM_COMPACT_HANDLES
+		const std::uint32_t handle_index_bits = HANDLE_INDEX_BITS;
+#else
+		const std::uint32_t handle_index_bits = 0;
+#endif
+		if (header->handle_index_bits != handle_index_bits || header->number_of_sections != number_of_sections) {
+			throw "Snapshot does not match the encomsys";
+		}
+		if (file.size() < sizeof(snapshot_header) + number_of_sections * sizeof(snapshot_section)) {
+			throw "Snapshot is truncated";
+		}
+		const snapshot_section* sections = reinterpret_cast<const snapshot_section*>(file.data() + sizeof(snapshot_header));
+		for (std::size_t i = 0; i < number_of_sections; i++) {
+			for (std::size_t block = 0; block < NUMBER_OF_SNAPSHOT_BLOCKS; block++) {
+				if (sections[i].offsets[block] % SNAPSHOT_ALIGNMENT != 0
+					|| sections[i].offsets[block] > file.size()
+					|| sections[i].bytes[block] > file.size() - sections[i].offsets[block]) {
+					throw "Snapshot is truncated";
+				}
+			}
+		}
+		return sections;
+	}
+
+	/**
+	 * Writes a component or a handle.
+	 */
+	template<typename ValueType>
+	void __write_value(snapshot_writer& out, const ValueType& value) {
+		if constexpr (std::is_trivially_copyable_v<ValueType>) {
+			out.write(value);
+		} else {
+			serializer<ValueType>::write(out, value);
+		}
+	}
+
+	template<typename ValueType>
+	ValueType __read_value(snapshot_reader& in) {
+		if constexpr (std::is_trivially_copyable_v<ValueType>) {
+			return in.read<ValueType>();
+		} else {
+			return serializer<ValueType>::read(in);
+		}
+	}
+
+	/**
+	 * Writes a component, relation or structure-of-arrays value of a record. Relations are written as
+	 * their child handles and inline childs.
+	 */
+	template<typename ComponentType, typename WrapperType>
+	void __write_record_value(snapshot_writer& out, const WrapperType& wrapper) {
+		if constexpr (is_relation_v<ComponentType>) {
+			std::apply([&out](const auto& ...childs) { (__write_value(out, childs), ...); }, wrapper._handles);
+		} else {
+			__write_value<ComponentType>(out, wrapper.get_value());
+		}
+	}
+
+	/**
+	 * Reads the value of a record and emplaces the element at index into storage.
+	 */
+	template<typename ComponentType, typename Storage>
+	void __read_record_value(snapshot_reader& in, Storage* storage, ID_TYPE index, ID_TYPE consecutive_index, std::uint32_t number_of_references) {
+		if constexpr (is_relation_v<ComponentType>) {
+			stored_childs_t<ComponentType> childs;
+			// the assignments in the fold are sequenced, so the childs are read in order
+			std::apply([&in](auto& ...values) { ((values = __read_value<std::decay_t<decltype(values)>>(in)), ...); }, childs);
+			storage->emplace_at(index, consecutive_index, number_of_references, std::move(childs));
+		} else {
+			storage->emplace_at(index, consecutive_index, number_of_references, __read_value<ComponentType>(in));
+		}
+	}
+
+	/**
+	 * Writes every element of a storage as a record, so this works for every storage, but loading has to
+	 * construct each element.
+	 */
+	template<typename ComponentType, typename Storage>
+	struct __record_snapshot {
+		static void save(const Storage& storage, snapshot_section* section, snapshot_payload* payload) {
+			section->encoding = snapshot_encoding::records;
+			section->slot_count = storage.slot_count();
+			section->size = storage.size();
+			snapshot_writer out(&payload->records);
+			for (ID_TYPE index = 0; index < storage.slot_count(); index++) {
+				if (storage.has_index(index)) {
+					const auto& wrapper = storage.get_unchecked(index);
+					out.write(std::uint64_t(index));
+					out.write(std::uint64_t(wrapper.consecutive_index));
+					out.write(std::uint32_t(wrapper.number_of_references));
+					__write_record_value<ComponentType>(out, wrapper);
+				}
+			}
+			section->bytes[SNAPSHOT_DATA] = payload->records.size();
+			payload->blocks[SNAPSHOT_DATA] = payload->records.data();
+		}
+
+		static void load(const mapped_file& file, const snapshot_section& section, Storage* storage) {
+			if (section.encoding != snapshot_encoding::records) {
+				throw "Snapshot does not match the encomsys";
+			}
+			const char* data = file.data() + section.offsets[SNAPSHOT_DATA];
+			snapshot_reader in(data, data + section.bytes[SNAPSHOT_DATA]);
+			storage->reserve(section.size);
+			for (std::uint64_t i = 0; i < section.size; i++) {
+				const ID_TYPE index = in.read<std::uint64_t>();
+				const ID_TYPE consecutive_index = in.read<std::uint64_t>();
+				const std::uint32_t number_of_references = in.read<std::uint32_t>();
+				__read_record_value<ComponentType>(in, storage, index, consecutive_index, number_of_references);
+			}
+		}
+	};
+
+	/**
+	 * Writes and reads the storage of a component type in snapshots. Specialized for storages, that can
+	 * be used in place.
+	 */
+	template<typename ComponentType, typename Storage>
+	struct storage_snapshot : __record_snapshot<ComponentType, Storage> {};
+
+	template<typename Tuple>
+	struct __all_trivially_copyable;
+
+	template<typename ...Ts>
+	struct __all_trivially_copyable<std::tuple<Ts...>> : std::bool_constant<(std::is_trivially_copyable_v<Ts> && ...)> {};
+
+	/**
+	 * Whether the slots of ComponentType can be written and mapped as raw bytes
+	 */
+	template<typename ComponentType, typename __Specialization=void>
+	struct __raw_slots : std::is_trivially_copyable<ComponentType> {};
+
+	template<typename RelationType>
+	struct __raw_slots<RelationType, std::enable_if_t<is_relation_v<RelationType>>>
+		: __all_trivially_copyable<stored_childs_t<RelationType>> {};
+
+	/**
+	 * index_vectors of trivially copyable components and of relations without or with trivially copyable
+	 * inline childs are written as their raw slots and occupancy bitmap. Loading uses the mapped slots in place without touching the elements, so the
+	 * elements are paged in on first access.
+	 */
+	template<typename ComponentType, typename WrapperType>
+	struct storage_snapshot<ComponentType, index_vector<WrapperType>> {
+		using storage_type = index_vector<WrapperType>;
+		using slot_type = index_vector_slot<WrapperType>;
+
+		static constexpr bool raw = __raw_slots<ComponentType>::value;
+
+		static_assert(alignof(slot_type) <= SNAPSHOT_ALIGNMENT, "Over-aligned components can not be mapped from snapshots");
+
+		static void save(const storage_type& storage, snapshot_section* section, snapshot_payload* payload) {
+			if constexpr (raw) {
+				section->encoding = snapshot_encoding::slots;
+				section->slot_count = storage.slot_count();
+				section->size = storage.size();
+				section->free_head = storage.free_head();
+				section->bytes[SNAPSHOT_DATA] = storage.slot_count() * sizeof(slot_type);
+				section->bytes[SNAPSHOT_OCCUPANCY] = (storage.slot_count() + 63) / 64 * sizeof(std::uint64_t);
+				payload->blocks[SNAPSHOT_DATA] = storage.slots();
+				payload->blocks[SNAPSHOT_OCCUPANCY] = storage.occupied().words();
+			} else {
+				__record_snapshot<ComponentType, storage_type>::save(storage, section, payload);
+			}
+		}
+
+		static void load(const mapped_file& file, const snapshot_section& section, storage_type* storage) {
+			if constexpr (raw) {
+				if (section.encoding != snapshot_encoding::slots
+					|| section.bytes[SNAPSHOT_DATA] != section.slot_count * sizeof(slot_type)
+					|| section.bytes[SNAPSHOT_OCCUPANCY] != (section.slot_count + 63) / 64 * sizeof(std::uint64_t)) {
+					throw "Snapshot does not match the encomsys";
+				}
+				storage->adopt(
+					reinterpret_cast<slot_type*>(file.data() + section.offsets[SNAPSHOT_DATA]),
+					section.slot_count,
+					section.size,
+					section.free_head,
+					reinterpret_cast<const std::uint64_t*>(file.data() + section.offsets[SNAPSHOT_OCCUPANCY]),
+					section.bytes[SNAPSHOT_OCCUPANCY] / sizeof(std::uint64_t)
+				);
+			} else {
+				__record_snapshot<ComponentType, storage_type>::load(file, section, storage);
+			}
+		}
+	};
+}
+
+#endif
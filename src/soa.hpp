@@ -0,0 +1,480 @@
+#ifndef __SOA_CLASS__
+#define __SOA_CLASS__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "util/types.hpp"
+#include "util/aligned_allocator.hpp"
+#include "util/sparse_table.hpp"
+#include "util/iteration.hpp"
+
+namespace encom {
+	/**
+	 * A list of member pointers, that describes the fields of a structure-of-arrays component.
+	 */
+	template<auto ...Fields>
+	struct soa_fields {};
+
+	/**
+	 * Specialize this for a component type to store every field of this component in its own column, e.g.
+	 *
+	 *   template<> struct encom::soa_layout<position_t> {
+	 *       using fields = encom::soa_fields<&position_t::x, &position_t::y>;
+	 *   };
+	 *
+	 * The component type has to be default constructible.
+	 */
+	template<typename T, typename __Specialization=void>
+	struct soa_layout {};
+
+	template<typename T, typename __Specialization=void>
+	struct is_soa : std::false_type {};
+
+	template<typename T>
+	struct is_soa<T, std::void_t<typename soa_layout<T>::fields>> : std::true_type {};
+
+	template<typename T>
+	inline constexpr bool is_soa_v = is_soa<T>::value;
+
+	template<typename MemberPointer>
+	struct __member_pointer_traits;
+
+	template<typename ClassType, typename FieldType>
+	struct __member_pointer_traits<FieldType ClassType::*> {
+		using field_type = FieldType;
+	};
+
+	template<auto Field>
+	using soa_field_t = typename __member_pointer_traits<decltype(Field)>::field_type;
+
+	/**
+	 * @returns the position of Field in Fields... or sizeof...(Fields), if Field is not part of Fields...
+	 */
+	template<auto Field, auto First, auto ...Rest>
+	constexpr std::size_t __soa_field_index() {
+		if constexpr (std::is_same_v<decltype(Field), decltype(First)>) {
+			if (Field == First) {
+				return 0;
+			}
+		}
+		if constexpr (sizeof...(Rest) == 0) {
+			return 1;
+		} else {
+			return 1 + __soa_field_index<Field, Rest...>();
+		}
+	}
+
+	/**
+	 * The reference type of a structure-of-arrays component. Holds a reference to every field of
+	 * one component. This is what relation::as_ref contains for structure-of-arrays components.
+	 */
+	template<typename T, typename Fields = typename soa_layout<T>::fields>
+	struct soa_ref;
+
+	template<typename T, auto ...Fields>
+	struct soa_ref<T, soa_fields<Fields...>> : public std::tuple<soa_field_t<Fields>&...> {
+		soa_ref(soa_field_t<Fields>&... fields) : std::tuple<soa_field_t<Fields>&...>(fields...) {}
+
+		/**
+		 * @returns a reference to the given field, e.g. ref.get<&position_t::x>()
+		 */
+		template<auto Field>
+		soa_field_t<Field>& get() const {
+			constexpr std::size_t I = __soa_field_index<Field, Fields...>();
+			static_assert(I < sizeof...(Fields), "Field is not part of the soa_layout");
+			return std::get<I>(*this);
+		}
+
+		/**
+		 * @returns a copy of the referenced component
+		 */
+		T get_value() const {
+			T value;
+			((value.*Fields = get<Fields>()), ...);
+			return value;
+		}
+
+		/**
+		 * Writes every field of the given value into the referenced component.
+		 */
+		void set_value(const T& value) const {
+			((get<Fields>() = value.*Fields), ...);
+		}
+	};
+
+	/**
+	 * Mimics the interface of component_wrapper for one element of a soa_vector.
+	 */
+	template<typename T>
+	struct soa_wrapper_ref {
+		GENERATION_TYPE& consecutive_index;
+		std::uint32_t& number_of_references;
+		soa_ref<T> ref;
+
+		T get_value() const {
+			return ref.get_value();
+		}
+
+		soa_ref<T> get_ref() const {
+			return ref;
+		}
+
+		template<typename Encomsys>
+		inline void remove_childs(Encomsys*) {}
+	};
+
+	template<typename WrapperType, typename T = typename WrapperType::component_type, typename Fields = typename soa_layout<T>::fields>
+	class soa_vector;
+
+	template<typename Vector, typename T>
+	class soa_vector_iterator {
+		private:
+			Vector* _vec;
+			ID_TYPE _position;
+		public:
+			soa_vector_iterator(Vector* vec, ID_TYPE position)
+				: _vec(vec), _position(position)
+			{ }
+
+			void operator++() {
+				++_position;
+			}
+
+			void operator++(int) {
+				++_position;
+			}
+
+			soa_wrapper_ref<T> operator*() const {
+				return _vec->at_position(_position);
+			}
+
+			/**
+			 * @returns the (stable) index of the element this iterator points to
+			 */
+			ID_TYPE index() const {
+				return _vec->index_at_position(_position);
+			}
+
+			bool operator==(const soa_vector_iterator& other) const {
+				return _position == other._position;
+			}
+
+			bool operator!=(const soa_vector_iterator& other) const {
+				return _position != other._position;
+			}
+	};
+
+	/**
+	 * Stores wrapped components column wise. The wrapper metadata (consecutive_index and
+	 * number_of_references) and every field declared by soa_layout<T> live in their own 64 byte aligned
+	 * column. Like dense_vector the columns are kept packed (swap-and-pop on removal), so every column
+	 * can be handed to a batch kernel as one contiguous span.
+	 */
+	template<typename WrapperType, typename T, auto ...Fields>
+	class soa_vector<WrapperType, T, soa_fields<Fields...>> {
+		private:
+			template<typename FieldType>
+			using column = std::vector<FieldType, aligned_allocator<FieldType>>;
+
+			column<GENERATION_TYPE> _consecutive_indices;
+			column<std::uint32_t> _number_of_references;
+			std::tuple<column<soa_field_t<Fields>>...> _columns;
+			std::vector<ID_TYPE> _dense_to_sparse;
+			sparse_table _sparse;
+
+			template<std::size_t ...I>
+			soa_wrapper_ref<T> at_position_impl(std::index_sequence<I...>, const ID_TYPE position) {
+				return soa_wrapper_ref<T> {
+					_consecutive_indices[position],
+					_number_of_references[position],
+					soa_ref<T>(std::get<I>(_columns)[position]...)
+				};
+			}
+
+			template<std::size_t ...I>
+			void move_position(std::index_sequence<I...>, const ID_TYPE from, const ID_TYPE to) {
+				((std::get<I>(_columns)[to] = std::move(std::get<I>(_columns)[from])), ...);
+			}
+
+			template<std::size_t ...I>
+			void swap_position(std::index_sequence<I...>, const ID_TYPE a, const ID_TYPE b) {
+				using std::swap;
+				(swap(std::get<I>(_columns)[a], std::get<I>(_columns)[b]), ...);
+			}
+
+			template<std::size_t ...I>
+			void push_back(std::index_sequence<I...>, T& value) {
+				constexpr auto fields = std::make_tuple(Fields...);
+				(std::get<I>(_columns).push_back(std::move(value.*std::get<I>(fields))), ...);
+			}
+
+			void push_back(const ID_TYPE index, WrapperType& w) {
+				_consecutive_indices.push_back(w.consecutive_index);
+				_number_of_references.push_back(w.number_of_references);
+				push_back(field_indices(), w.value);
+				_dense_to_sparse.push_back(index);
+			}
+
+			template<std::size_t ...I>
+			void pop_back(std::index_sequence<I...>) {
+				(std::get<I>(_columns).pop_back(), ...);
+			}
+
+			template<typename Kernel, std::size_t ...I>
+			void batch_impl(std::index_sequence<I...>, Kernel& kernel, const std::size_t begin, const std::size_t count) {
+				kernel(count, (std::get<I>(_columns).data() + begin)...);
+			}
+
+			using field_indices = std::make_index_sequence<sizeof...(Fields)>;
+
+		public:
+			using iterator = soa_vector_iterator<soa_vector, T>;
+			using const_iterator = soa_vector_iterator<soa_vector, T>;
+
+			ID_TYPE add(const WrapperType& w) {
+				return emplace(w.consecutive_index, w.number_of_references, w.value);
+			}
+
+			/**
+			 * Constructs a wrapper from the given arguments and distributes it into the columns.
+			 *
+			 * @returns The stable index of the new element
+			 */
+			template<typename ...Args>
+			ID_TYPE emplace(Args&&... args) {
+				WrapperType w(std::forward<Args>(args)...);
+				const ID_TYPE index = _sparse.acquire(_consecutive_indices.size());
+				push_back(index, w);
+				return index;
+			}
+
+			/**
+			 * Like emplace(), but uses the given unused stable index (see sparse_table::acquire_at()).
+			 */
+			template<typename ...Args>
+			void emplace_at(const ID_TYPE index, Args&&... args) {
+				if (_sparse.contains(index)) {
+					throw "Tried to emplace at used index";
+				}
+				WrapperType w(std::forward<Args>(args)...);
+				_sparse.acquire_at(index, _consecutive_indices.size());
+				push_back(index, w);
+			}
+
+			bool has_index(const ID_TYPE index) const {
+				return _sparse.contains(index);
+			}
+
+			/**
+			 * Allocates every column, so that this vector can hold number_of_elements elements without
+			 * reallocating.
+			 */
+			void reserve(const size_t number_of_elements) {
+				_consecutive_indices.reserve(number_of_elements);
+				_number_of_references.reserve(number_of_elements);
+				std::apply([number_of_elements](auto& ...columns) { (columns.reserve(number_of_elements), ...); }, _columns);
+				_dense_to_sparse.reserve(number_of_elements);
+				_sparse.reserve(number_of_elements);
+			}
+
+			/**
+			 * Removes the element at the given index by moving the last element into its place.
+			 *
+			 * @returns true, if there was an element at the specified index, otherwise false
+			 */
+			bool remove(const ID_TYPE index) {
+				if (!has_index(index)) {
+					return false;
+				}
+				const ID_TYPE position = _sparse.position(index);
+				const ID_TYPE last = _consecutive_indices.size() - 1;
+				if (position != last) {
+					_consecutive_indices[position] = _consecutive_indices[last];
+					_number_of_references[position] = _number_of_references[last];
+					move_position(field_indices(), last, position);
+					_dense_to_sparse[position] = _dense_to_sparse[last];
+					_sparse.set_position(_dense_to_sparse[position], position);
+				}
+				_consecutive_indices.pop_back();
+				_number_of_references.pop_back();
+				pop_back(field_indices());
+				_dense_to_sparse.pop_back();
+				_sparse.release(index);
+				return true;
+			}
+
+			/**
+			 * Returns a proxy to the element at the specified index. If there is no element at the
+			 * specified index an exception is thrown.
+			 */
+			soa_wrapper_ref<T> get(const ID_TYPE index) const {
+				if (has_index(index)) {
+					return const_cast<soa_vector*>(this)->at_position(_sparse.position(index));
+				} else {
+					throw "Tried to get invalid index";
+				}
+			}
+
+			/**
+			 * Returns a proxy to the element at the specified index without checking, whether the index is valid.
+			 */
+			soa_wrapper_ref<T> get_unchecked(const ID_TYPE index) const {
+				return const_cast<soa_vector*>(this)->at_position(_sparse.position(index));
+			}
+
+			/**
+			 * Hints the cpu to load the first field of the element at the given index into the cache.
+			 */
+			void prefetch(const ID_TYPE index) const {
+				__builtin_prefetch(std::get<0>(_columns).data() + _sparse.position(index));
+			}
+
+			soa_wrapper_ref<T> at_position(const ID_TYPE position) {
+				return at_position_impl(field_indices(), position);
+			}
+
+			ID_TYPE index_at_position(const ID_TYPE position) const {
+				return _dense_to_sparse[position];
+			}
+
+			/**
+			 * @returns the packed position of the element at the given index
+			 */
+			ID_TYPE position_of(const ID_TYPE index) const {
+				return _sparse.position(index);
+			}
+
+			/**
+			 * Exchanges the elements at two packed positions in every column. Their indices stay the same.
+			 */
+			void swap_positions(const ID_TYPE a, const ID_TYPE b) {
+				std::swap(_consecutive_indices[a], _consecutive_indices[b]);
+				std::swap(_number_of_references[a], _number_of_references[b]);
+				swap_position(field_indices(), a, b);
+				std::swap(_dense_to_sparse[a], _dense_to_sparse[b]);
+				_sparse.set_position(_dense_to_sparse[a], a);
+				_sparse.set_position(_dense_to_sparse[b], b);
+			}
+
+			/**
+			 * Releases the capacity of every column, that is not used by the elements.
+			 */
+			void shrink_to_fit() {
+				_consecutive_indices.shrink_to_fit();
+				_number_of_references.shrink_to_fit();
+				std::apply([](auto& ...columns) { (columns.shrink_to_fit(), ...); }, _columns);
+				_dense_to_sparse.shrink_to_fit();
+				_sparse.shrink_to_fit();
+			}
+
+			/**
+			 * @returns a pointer to the column of the given field. There are size() elements.
+			 */
+			template<auto Field>
+			soa_field_t<Field>* column_data() {
+				constexpr std::size_t I = __soa_field_index<Field, Fields...>();
+				static_assert(I < sizeof...(Fields), "Field is not part of the soa_layout");
+				return std::get<I>(_columns).data();
+			}
+
+			template<auto Field>
+			const soa_field_t<Field>* column_data() const {
+				return const_cast<soa_vector*>(this)->template column_data<Field>();
+			}
+
+			/**
+			 * Calls kernel(count, field_columns...) for consecutive batches of at most batch_size elements.
+			 * Every column pointer points to count contiguous values, one column per field in the order
+			 * of soa_layout<T>::fields. A batch_size of 0 processes all elements in one batch.
+			 */
+			template<typename Kernel>
+			void for_each_batch(Kernel&& kernel, std::size_t batch_size = 0) {
+				const std::size_t number_of_elements = size();
+				if (batch_size == 0) {
+					batch_size = number_of_elements;
+				}
+				for (std::size_t begin = 0; begin < number_of_elements; begin += batch_size) {
+					const std::size_t count = std::min(batch_size, number_of_elements - begin);
+					batch_impl(field_indices(), kernel, begin, count);
+				}
+			}
+
+			/**
+			 * @returns the number of positions, that for_each_in() accepts
+			 */
+			ID_TYPE position_count() const {
+				return size();
+			}
+
+			/**
+			 * Executes func for a proxy of every element at the packed positions [begin, end), until func
+			 * returns false.
+			 *
+			 * @returns false, if func stopped the iteration
+			 */
+			template<typename Func>
+			bool for_each_in(ID_TYPE begin, ID_TYPE end, Func&& func) const {
+				end = end < size() ? end : size();
+				for (ID_TYPE position = begin; position < end; position++) {
+					if (!continue_iteration(func, const_cast<soa_vector*>(this)->at_position(position))) {
+						return false;
+					}
+				}
+				return true;
+			}
+
+			iterator begin() const {
+				return iterator(const_cast<soa_vector*>(this), 0);
+			}
+
+			iterator end() const {
+				return iterator(const_cast<soa_vector*>(this), size());
+			}
+
+			size_t size() const {
+				return _consecutive_indices.size();
+			}
+
+			ID_TYPE slot_count() const {
+				return _sparse.size();
+			}
+
+			/**
+			 * @returns the number of elements, that fit into the columns without reallocating
+			 */
+			size_t capacity() const {
+				return _consecutive_indices.capacity();
+			}
+
+			/**
+			 * @returns the bytes allocated for all columns and the index tables
+			 */
+			size_t allocated_bytes() const {
+				size_t bytes = _consecutive_indices.capacity() * sizeof(GENERATION_TYPE) + _number_of_references.capacity() * sizeof(std::uint32_t);
+				std::apply([&bytes](const auto& ...columns) {
+					((bytes += columns.capacity() * sizeof(typename std::decay_t<decltype(columns)>::value_type)), ...);
+				}, _columns);
+				return bytes + _dense_to_sparse.capacity() * sizeof(ID_TYPE) + _sparse.allocated_bytes();
+			}
+
+			/**
+			 * The bytes of the fields of one element
+			 */
+			static constexpr size_t payload_bytes_per_element = (sizeof(soa_field_t<Fields>) + ... + 0);
+	};
+
+	/**
+	 * Stores the components in a soa_vector. This is the default storage of components with a soa_layout.
+	 */
+	struct soa_storage {
+		template<typename WrapperType>
+		using type = soa_vector<WrapperType>;
+	};
+}
+
+#endif
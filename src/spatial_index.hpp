@@ -0,0 +1,84 @@
+#ifndef __SPATIAL_INDEX_CLASS__
+#define __SPATIAL_INDEX_CLASS__
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include "util/types.hpp"
+#include "util/spatial_grid.hpp"
+
+namespace encom {
+	/**
+	 * Declares a spatial index for a position like component type, that answers box, radius and nearest
+	 * neighbour queries without scanning all components. Specialize this with uniform_grid and the fields
+	 * holding the coordinates, e.g.
+	 *
+	 *   template<> struct encom::spatial_index<position_t> : encom::uniform_grid<&position_t::x, &position_t::y> {
+	 *   	static constexpr float cell_size = 16.f;
+	 *   };
+	 *
+	 * Positions are updated by modify(), patch() and mark_changed(). Writes through get_ref(), views or
+	 * for_each() have to be followed by mark_changed(), otherwise queries see the old positions. Types
+	 * without a spatial index pay nothing.
+	 */
+	template<typename ComponentType, typename __Specialization=void>
+	struct spatial_index {
+		static constexpr bool enabled = false;
+	};
+
+	/**
+	 * Indexes the components in a spatial_grid. The cell size should be about the radius of typical
+	 * queries: smaller cells visit more cells per query, larger cells compare more positions.
+	 */
+	template<auto... Members>
+	struct uniform_grid {
+		static_assert(sizeof...(Members) >= 1, "A uniform grid needs at least one coordinate");
+
+		static constexpr bool enabled = true;
+		static constexpr std::size_t dimensions = sizeof...(Members);
+		static constexpr float cell_size = 1.f;
+
+		template<typename ComponentType>
+		static std::array<float, dimensions> position(const ComponentType& component) {
+			return std::array<float, dimensions> {float(component.*Members)...};
+		}
+	};
+
+	template<typename ComponentType>
+	inline constexpr bool has_spatial_index_v = spatial_index<ComponentType>::enabled;
+
+	/**
+	 * The spatial index of a type without spatial_index
+	 */
+	template<typename ComponentType, typename __Specialization=void>
+	class spatial_table {};
+
+	/**
+	 * The spatial_grid of an indexed component type, that takes the components instead of points.
+	 */
+	template<typename ComponentType>
+	class spatial_table<ComponentType, std::enable_if_t<has_spatial_index_v<ComponentType>>>
+		: public spatial_grid<spatial_index<ComponentType>::dimensions>
+	{
+		public:
+			using grid_type = spatial_grid<spatial_index<ComponentType>::dimensions>;
+
+			spatial_table()
+				: grid_type(spatial_index<ComponentType>::cell_size)
+			{}
+
+			static typename grid_type::point position(const ComponentType& component) {
+				return spatial_index<ComponentType>::position(component);
+			}
+
+			void insert(const ID_TYPE array_index, const ComponentType& component) {
+				grid_type::insert(array_index, position(component));
+			}
+
+			void move(const ID_TYPE array_index, const ComponentType& component) {
+				grid_type::move(array_index, position(component));
+			}
+	};
+}
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef __STATS_CLASS__
+#define __STATS_CLASS__
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "util/types.hpp"
+
+namespace encom {
+	enum stats_operation : std::size_t {
+		STATS_ADD = 0,
+		STATS_REMOVE = 1,
+		STATS_GET = 2,
+		STATS_GET_REF = 3,
+		STATS_FAILED_HAS_ELEMENT = 4,
+		NUMBER_OF_STATS_OPERATIONS = 5,
+	};
+
+	/**
+	 * The memory and the operations of one component type, see encomsys::stats().
+	 */
+	struct component_stats {
+		// the (mangled) name of the component type
+		const char* name;
+		// the number of components
+		std::size_t live;
+		// the number of components, that fit into the storage without growing it
+		std::size_t capacity;
+		// the unused indices below the largest used index. For index storages these are the empty slots.
+		std::size_t holes;
+		// the bytes of the live components. For relations these are the child handles.
+		std::size_t payload_bytes;
+		// the bytes of the consecutive indices, reference counts and padding of the live components
+		std::size_t metadata_bytes;
+		// the bytes allocated by the storage including unused capacity and index tables
+		std::size_t allocated_bytes;
+		// the operations since the encomsys was created or reset_stats() was called. Reading a relation only
+		// counts the relation, not the childs read with it. Always 0 with ENCOM_NO_STATS.
+		std::uint64_t adds;
+		std::uint64_t removes;
+		std::uint64_t gets;
+		std::uint64_t get_refs;
+		std::uint64_t failed_has_element;
+
+		/**
+		 * @returns the share of holes among all indices below the largest used index
+		 */
+		double fragmentation() const {
+			return live + holes == 0 ? 0.0 : double(holes) / double(live + holes);
+		}
+	};
+
+	/**
+	 * Counts the operations per component type. The counters are split into shards on separate cache
+	 * lines. The first NUMBER_OF_SHARDS - 1 threads, that count, own a shard each and increment it with a
+	 * relaxed load and store, which is as cheap as a plain increment. All further threads share the last
+	 * shard and increment it with relaxed atomic additions. Reading sums up all shards.
+	 */
+	template<std::size_t NumberOfTypes>
+	class operation_counters {
+		private:
+			static constexpr std::size_t NUMBER_OF_SHARDS = 16;
+			static constexpr std::size_t SHARED_SHARD = NUMBER_OF_SHARDS - 1;
+			static constexpr std::size_t NO_SHARD = ~std::size_t(0);
+
+			struct alignas(64) shard {
+				std::array<std::array<std::atomic<std::uint64_t>, NUMBER_OF_STATS_OPERATIONS>, NumberOfTypes> counts;
+			};
+
+			std::unique_ptr<shard[]> _shards;
+
+			/**
+			 * @returns the shard of the calling thread. Threads get the shards in the order they first count.
+			 */
+			static std::size_t thread_shard() {
+				static std::atomic<std::size_t> next_shard(0);
+				thread_local std::size_t own_shard = NO_SHARD;
+				if (own_shard == NO_SHARD) {
+					const std::size_t next = next_shard.fetch_add(1, std::memory_order_relaxed);
+					own_shard = next < SHARED_SHARD ? next : SHARED_SHARD;
+				}
+				return own_shard;
+			}
+
+		public:
+			operation_counters()
+				: _shards(new shard[NUMBER_OF_SHARDS])
+			{
+				reset();
+			}
+
+			void count(const std::size_t type, const stats_operation operation) const {
+				const std::size_t own_shard = thread_shard();
+				std::atomic<std::uint64_t>& counter = _shards[own_shard].counts[type][operation];
+				if (own_shard == SHARED_SHARD) {
+					counter.fetch_add(1, std::memory_order_relaxed);
+				} else {
+					counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+				}
+			}
+
+			/**
+			 * @returns the sum of the counters of all threads. Counts of concurrent operations may be missing.
+			 */
+			std::uint64_t total(const std::size_t type, const stats_operation operation) const {
+				std::uint64_t sum = 0;
+				for (std::size_t i = 0; i < NUMBER_OF_SHARDS; i++) {
+					sum += _shards[i].counts[type][operation].load(std::memory_order_relaxed);
+				}
+				return sum;
+			}
+
+			void reset() {
+				for (std::size_t i = 0; i < NUMBER_OF_SHARDS; i++) {
+					for (auto& counts : _shards[i].counts) {
+						for (std::atomic<std::uint64_t>& counter : counts) {
+							counter.store(0, std::memory_order_relaxed);
+						}
+					}
+				}
+			}
+	};
+}
+
+#endif
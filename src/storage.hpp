@@ -0,0 +1,63 @@
+#ifndef __STORAGE_CLASS__
+#define __STORAGE_CLASS__
+
+#include "util/index_vector.hpp"
+#include "util/dense_vector.hpp"
+#include "util/chunked_vector.hpp"
+#include "util/huge_page_allocator.hpp"
+#include "soa.hpp"
+
+namespace encom {
+	/**
+	 * Stores the components in an index_vector. Removing leaves a hole, that is reused by the next add.
+	 */
+	struct indexed_storage {
+		template<typename WrapperType>
+		using type = index_vector<WrapperType>;
+	};
+
+	/**
+	 * Stores the components packed in a dense_vector. Removing moves the last component into the
+	 * freed position, so iterating never visits holes.
+	 */
+	struct dense_storage {
+		template<typename WrapperType>
+		using type = dense_vector<WrapperType>;
+	};
+
+	/**
+	 * Stores the components in a chunked_vector. Adding never moves existing components, so references
+	 * returned by get_ref() stay valid until the component is removed.
+	 *
+	 * @tparam Allocator The allocator template for the chunks, e.g. std::allocator or huge_page_allocator
+	 * @tparam ChunkSize The number of components per chunk. 0 selects the preferred chunk size of the allocator.
+	 */
+	template<template<typename> typename Allocator = std::allocator, std::size_t ChunkSize = 0>
+	struct chunked_storage {
+		template<typename WrapperType>
+		using type = chunked_vector<
+			WrapperType,
+			Allocator<WrapperType>,
+			ChunkSize == 0
+				? default_chunk_size<index_vector_slot<WrapperType>, preferred_chunk_bytes<Allocator<WrapperType>>::value>()
+				: ChunkSize
+		>;
+	};
+
+	/**
+	 * Selects the container, that holds the components of type ComponentType in an encomsys.
+	 * Specialize this for a component or relation type to change its storage, e.g.
+	 *
+	 *   template<> struct encom::component_storage<position_t> : encom::dense_storage {};
+	 */
+	template<typename ComponentType, typename __Specialization=void>
+	struct component_storage : indexed_storage {};
+
+	/**
+	 * Components with a soa_layout are stored column wise by default.
+	 */
+	template<typename ComponentType>
+	struct component_storage<ComponentType, std::enable_if_t<is_soa_v<ComponentType>>> : soa_storage {};
+}
+
+#endif
@@ -0,0 +1,432 @@
+#ifndef __TRACING_CLASS__
+#define __TRACING_CLASS__
+
+#include "util/types.hpp"
+
+/*
+ * Scoped spans around the operations of the encomsys and user code:
+ *
+ *   void movement_system(ensys& ensys) {
+ *       ENCOM_TRACE_SPAN("movement_system");
+ *       ...
+ *   }
+ *
+ * Without ENCOM_TRACING, ENCOM_TRACE_SPAN() expands to nothing. Define ENCOM_TRACE_SPAN(name) before
+ * including encomsys.hpp to forward the spans to another profiler instead.
+ */
+#ifndef ENCOM_TRACE_SPAN
+#ifdef ENCOM_TRACING
+#define __ENCOM_TRACE_CONCAT_IMPL(a, b) a##b
+#define __ENCOM_TRACE_CONCAT(a, b) __ENCOM_TRACE_CONCAT_IMPL(a, b)
+#define ENCOM_TRACE_SPAN(name) \
+	static const std::uint32_t __ENCOM_TRACE_CONCAT(__encom_trace_point_, __LINE__) = ::encom::tracer::instance().point(name); \
+	const ::encom::trace_span __ENCOM_TRACE_CONCAT(__encom_trace_span_, __LINE__)(__ENCOM_TRACE_CONCAT(__encom_trace_point_, __LINE__))
+#else
+#define ENCOM_TRACE_SPAN(name) do {} while (false)
+#endif
+#endif
+
+#ifdef ENCOM_TRACING
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// the number of spans every thread keeps for write_chrome_trace(). Older spans are overwritten.
+#ifndef ENCOM_TRACE_RING_CAPACITY
+#define ENCOM_TRACE_RING_CAPACITY 65536
+#endif
+
+namespace encom {
+	static_assert((ENCOM_TRACE_RING_CAPACITY & (ENCOM_TRACE_RING_CAPACITY - 1)) == 0, "ENCOM_TRACE_RING_CAPACITY has to be a power of 2");
+
+	// the number of different span names
+	constexpr std::size_t MAX_TRACE_POINTS = 256;
+
+	/**
+	 * The latencies of one span name, see tracer::latencies().
+	 */
+	struct latency_summary {
+		std::string name;
+		std::uint64_t count;
+		std::uint64_t p50_ns;
+		std::uint64_t p99_ns;
+		std::uint64_t max_ns;
+	};
+
+	/**
+	 * Counts durations in log-linear buckets: every power of 2 is split into 8 buckets, so a
+	 * percentile is off by at most 12.5%. Only the owning thread records, so the counters are
+	 * incremented with relaxed loads and stores.
+	 */
+	class latency_histogram {
+		private:
+			static constexpr unsigned SUB_BUCKET_BITS = 3;
+			static constexpr std::uint64_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+		public:
+			static constexpr std::size_t NUMBER_OF_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+		private:
+			std::array<std::atomic<std::uint64_t>, NUMBER_OF_BUCKETS> _buckets;
+			std::atomic<std::uint64_t> _max;
+
+		public:
+			latency_histogram() {
+				reset();
+			}
+
+			static std::size_t bucket_of(const std::uint64_t ns) {
+				if (ns < SUB_BUCKETS) {
+					return std::size_t(ns);
+				}
+				const unsigned exponent = 63 - __builtin_clzll(ns);
+				const std::uint64_t sub_bucket = (ns >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+				return std::size_t((exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub_bucket);
+			}
+
+			/**
+			 * @returns the largest duration, that is counted in the given bucket
+			 */
+			static std::uint64_t bucket_limit(const std::size_t bucket) {
+				if (bucket < SUB_BUCKETS) {
+					return bucket;
+				}
+				const unsigned exponent = unsigned(bucket / SUB_BUCKETS) + SUB_BUCKET_BITS - 1;
+				const std::uint64_t lower = (SUB_BUCKETS + bucket % SUB_BUCKETS) << (exponent - SUB_BUCKET_BITS);
+				return lower + (std::uint64_t(1) << (exponent - SUB_BUCKET_BITS)) - 1;
+			}
+
+			void record(const std::uint64_t ns) {
+				std::atomic<std::uint64_t>& bucket = _buckets[bucket_of(ns)];
+				bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+				if (ns > _max.load(std::memory_order_relaxed)) {
+					_max.store(ns, std::memory_order_relaxed);
+				}
+			}
+
+			/**
+			 * Adds the counters of this histogram to buckets and max.
+			 */
+			void merge_into(std::array<std::uint64_t, NUMBER_OF_BUCKETS>* buckets, std::uint64_t* max) const {
+				for (std::size_t i = 0; i < NUMBER_OF_BUCKETS; i++) {
+					(*buckets)[i] += _buckets[i].load(std::memory_order_relaxed);
+				}
+				*max = std::max(*max, _max.load(std::memory_order_relaxed));
+			}
+
+			void reset() {
+				for (std::atomic<std::uint64_t>& bucket : _buckets) {
+					bucket.store(0, std::memory_order_relaxed);
+				}
+				_max.store(0, std::memory_order_relaxed);
+			}
+	};
+
+	/**
+	 * The spans and histograms of one thread. The owning thread writes the spans into a ring buffer
+	 * and publishes them by advancing the head. Readers take the spans between the tail and the head
+	 * and drop the ones, that were overwritten while reading. No locks are taken.
+	 */
+	class trace_buffer {
+		private:
+			struct event {
+				std::atomic<std::uint32_t> point;
+				std::atomic<std::uint64_t> start_ns;
+				std::atomic<std::uint64_t> duration_ns;
+			};
+
+			std::unique_ptr<event[]> _events;
+			std::atomic<std::uint64_t> _head;
+			// the spans before the tail were reset
+			std::atomic<std::uint64_t> _tail;
+			std::array<std::atomic<latency_histogram*>, MAX_TRACE_POINTS> _histograms;
+			std::uint32_t _thread_id;
+
+		public:
+			explicit trace_buffer(std::uint32_t thread_id)
+				: _events(new event[ENCOM_TRACE_RING_CAPACITY]), _head(0), _tail(0), _thread_id(thread_id)
+			{
+				for (std::atomic<latency_histogram*>& histogram : _histograms) {
+					histogram.store(nullptr, std::memory_order_relaxed);
+				}
+			}
+
+			trace_buffer(const trace_buffer&) = delete;
+			trace_buffer& operator=(const trace_buffer&) = delete;
+
+			~trace_buffer() {
+				for (std::atomic<latency_histogram*>& histogram : _histograms) {
+					delete histogram.load(std::memory_order_relaxed);
+				}
+			}
+
+			std::uint32_t thread_id() const {
+				return _thread_id;
+			}
+
+			void record(const std::uint32_t point, const std::uint64_t start_ns, const std::uint64_t duration_ns) {
+				const std::uint64_t head = _head.load(std::memory_order_relaxed);
+				event& e = _events[head & (ENCOM_TRACE_RING_CAPACITY - 1)];
+				e.point.store(point, std::memory_order_relaxed);
+				e.start_ns.store(start_ns, std::memory_order_relaxed);
+				e.duration_ns.store(duration_ns, std::memory_order_relaxed);
+				_head.store(head + 1, std::memory_order_release);
+
+				latency_histogram* histogram = _histograms[point].load(std::memory_order_relaxed);
+				if (histogram == nullptr) {
+					histogram = new latency_histogram();
+					_histograms[point].store(histogram, std::memory_order_release);
+				}
+				histogram->record(duration_ns);
+			}
+
+			/**
+			 * Calls func(point, start_ns, duration_ns) for every span in the buffer, oldest first.
+			 */
+			template<typename Func>
+			void for_each_event(Func&& func) const {
+				const std::uint64_t head = _head.load(std::memory_order_acquire);
+				const std::uint64_t tail = _tail.load(std::memory_order_relaxed);
+				std::uint64_t first = head > ENCOM_TRACE_RING_CAPACITY ? head - ENCOM_TRACE_RING_CAPACITY : 0;
+				first = std::max(first, tail);
+
+				struct copied_event {
+					std::uint32_t point;
+					std::uint64_t start_ns;
+					std::uint64_t duration_ns;
+				};
+				std::vector<copied_event> copied;
+				copied.reserve(head - first);
+				for (std::uint64_t i = first; i < head; i++) {
+					const event& e = _events[i & (ENCOM_TRACE_RING_CAPACITY - 1)];
+					copied.push_back(copied_event {
+						e.point.load(std::memory_order_relaxed),
+						e.start_ns.load(std::memory_order_relaxed),
+						e.duration_ns.load(std::memory_order_relaxed)
+					});
+				}
+
+				// the spans, that the owner overwrote in the meantime, may be torn
+				std::atomic_thread_fence(std::memory_order_acquire);
+				const std::uint64_t head_after = _head.load(std::memory_order_relaxed);
+				const std::uint64_t valid = head_after > ENCOM_TRACE_RING_CAPACITY ? head_after - ENCOM_TRACE_RING_CAPACITY : 0;
+				for (std::uint64_t i = std::max(first, valid); i < head; i++) {
+					const copied_event& e = copied[i - first];
+					func(e.point, e.start_ns, e.duration_ns);
+				}
+			}
+
+			/**
+			 * @returns the histogram of the given point or nullptr, if the thread never recorded it
+			 */
+			const latency_histogram* histogram(const std::uint32_t point) const {
+				return _histograms[point].load(std::memory_order_acquire);
+			}
+
+			void reset() {
+				_tail.store(_head.load(std::memory_order_acquire), std::memory_order_relaxed);
+				for (std::atomic<latency_histogram*>& histogram : _histograms) {
+					latency_histogram* h = histogram.load(std::memory_order_acquire);
+					if (h != nullptr) {
+						h->reset();
+					}
+				}
+			}
+	};
+
+	/**
+	 * Collects the spans of all threads. Span names are registered once with point() and identified by
+	 * their index afterwards. Every thread gets its own trace_buffer on its first span. The buffers
+	 * outlive their threads, so the spans of finished threads are exported too.
+	 */
+	class tracer {
+		private:
+			mutable std::mutex _mutex;
+			std::vector<std::string> _names;
+			std::vector<std::shared_ptr<trace_buffer>> _buffers;
+			const std::chrono::steady_clock::time_point _start;
+
+			tracer()
+				: _start(std::chrono::steady_clock::now())
+			{}
+
+			std::shared_ptr<trace_buffer> register_thread() {
+				std::lock_guard<std::mutex> lock(_mutex);
+				_buffers.push_back(std::make_shared<trace_buffer>(std::uint32_t(_buffers.size())));
+				return _buffers.back();
+			}
+
+			std::vector<std::shared_ptr<trace_buffer>> buffers() const {
+				std::lock_guard<std::mutex> lock(_mutex);
+				return _buffers;
+			}
+
+			static void write_json_string(std::ostream& out, const std::string& s) {
+				out << '"';
+				for (const char c : s) {
+					if (c == '"' || c == '\\') {
+						out << '\\' << c;
+					} else if (static_cast<unsigned char>(c) < 0x20) {
+						out << ' ';
+					} else {
+						out << c;
+					}
+				}
+				out << '"';
+			}
+
+		public:
+			static tracer& instance() {
+				static tracer t;
+				return t;
+			}
+
+			/**
+			 * @returns the index of the span name. Every name is registered once.
+			 */
+			std::uint32_t point(const std::string& name) {
+				std::lock_guard<std::mutex> lock(_mutex);
+				for (std::size_t i = 0; i < _names.size(); i++) {
+					if (_names[i] == name) {
+						return std::uint32_t(i);
+					}
+				}
+				if (_names.size() == MAX_TRACE_POINTS) {
+					throw "tracer: too many span names";
+				}
+				_names.push_back(name);
+				return std::uint32_t(_names.size() - 1);
+			}
+
+			/**
+			 * @returns the nanoseconds since the tracer was created
+			 */
+			std::uint64_t now_ns() const {
+				return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count());
+			}
+
+			trace_buffer& thread_buffer() {
+				thread_local const std::shared_ptr<trace_buffer> buffer = register_thread();
+				return *buffer;
+			}
+
+			/**
+			 * Writes the recorded spans as complete events ("ph": "X") of the Chrome trace event format,
+			 * which chrome://tracing and Perfetto open.
+			 */
+			void write_chrome_trace(std::ostream& out) const {
+				const std::vector<std::shared_ptr<trace_buffer>> all_buffers = buffers();
+				std::vector<std::string> names;
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					names = _names;
+				}
+
+				out << "{\"traceEvents\":[";
+				bool first = true;
+				for (const std::shared_ptr<trace_buffer>& buffer : all_buffers) {
+					buffer->for_each_event([&](const std::uint32_t point, const std::uint64_t start_ns, const std::uint64_t duration_ns) {
+						out << (first ? "\n" : ",\n") << "{\"name\":";
+						write_json_string(out, names[point]);
+						out << ",\"cat\":\"encom\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_id()
+							<< ",\"ts\":" << double(start_ns) / 1000.0 << ",\"dur\":" << double(duration_ns) / 1000.0 << "}";
+						first = false;
+					});
+				}
+				out << "\n],\"displayTimeUnit\":\"ns\"}" << std::endl;
+			}
+
+			/**
+			 * @returns the latencies of every span name, that was recorded since the last reset(), merged
+			 * over all threads
+			 */
+			std::vector<latency_summary> latencies() const {
+				const std::vector<std::shared_ptr<trace_buffer>> all_buffers = buffers();
+				std::vector<std::string> names;
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					names = _names;
+				}
+
+				std::vector<latency_summary> result;
+				for (std::size_t point = 0; point < names.size(); point++) {
+					std::array<std::uint64_t, latency_histogram::NUMBER_OF_BUCKETS> buckets {};
+					std::uint64_t max = 0;
+					for (const std::shared_ptr<trace_buffer>& buffer : all_buffers) {
+						const latency_histogram* histogram = buffer->histogram(std::uint32_t(point));
+						if (histogram != nullptr) {
+							histogram->merge_into(&buckets, &max);
+						}
+					}
+
+					std::uint64_t count = 0;
+					for (const std::uint64_t bucket : buckets) {
+						count += bucket;
+					}
+					if (count == 0) {
+						continue;
+					}
+
+					const auto percentile = [&](const double p) {
+						const std::uint64_t rank = std::max<std::uint64_t>(1, std::uint64_t(p * double(count) + 0.5));
+						std::uint64_t seen = 0;
+						for (std::size_t i = 0; i < buckets.size(); i++) {
+							seen += buckets[i];
+							if (seen >= rank) {
+								return std::min(latency_histogram::bucket_limit(i), max);
+							}
+						}
+						return max;
+					};
+					result.push_back(latency_summary {names[point], count, percentile(0.5), percentile(0.99), max});
+				}
+				return result;
+			}
+
+			/**
+			 * Forgets all spans and latencies. Spans, that are recorded concurrently, may survive.
+			 */
+			void reset() {
+				for (const std::shared_ptr<trace_buffer>& buffer : buffers()) {
+					buffer->reset();
+				}
+			}
+	};
+
+	/**
+	 * Records the time from its construction to its destruction into the buffer of the current
+	 * thread. Use ENCOM_TRACE_SPAN() instead of constructing spans directly.
+	 */
+	class trace_span {
+		private:
+			std::uint32_t _point;
+			std::uint64_t _start_ns;
+
+		public:
+			explicit trace_span(const std::uint32_t point)
+				: _point(point), _start_ns(tracer::instance().now_ns())
+			{}
+
+			trace_span(const trace_span&) = delete;
+			trace_span& operator=(const trace_span&) = delete;
+
+			~trace_span() {
+				tracer& t = tracer::instance();
+				const std::uint64_t stop_ns = t.now_ns();
+				t.thread_buffer().record(_point, _start_ns, stop_ns - _start_ns);
+			}
+	};
+}
+
+#endif
+
+#endif
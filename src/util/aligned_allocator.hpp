@@ -0,0 +1,46 @@
+#ifndef __ALIGNED_ALLOCATOR_CLASS__
+#define __ALIGNED_ALLOCATOR_CLASS__
+
+#include <cstddef>
+#include <new>
+
+namespace encom {
+	/**
+	 * An allocator, that aligns every allocation to Alignment bytes. Used for columns, that are
+	 * processed with SIMD instructions.
+	 */
+	template<typename T, std::size_t Alignment = 64>
+	struct aligned_allocator {
+		using value_type = T;
+
+		template<typename U>
+		struct rebind {
+			using other = aligned_allocator<U, Alignment>;
+		};
+
+		aligned_allocator() = default;
+
+		template<typename U>
+		aligned_allocator(const aligned_allocator<U, Alignment>&) {}
+
+		T* allocate(const std::size_t n) {
+			return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+		}
+
+		void deallocate(T* p, std::size_t) {
+			::operator delete(p, std::align_val_t(Alignment));
+		}
+
+		template<typename U>
+		bool operator==(const aligned_allocator<U, Alignment>&) const {
+			return true;
+		}
+
+		template<typename U>
+		bool operator!=(const aligned_allocator<U, Alignment>&) const {
+			return false;
+		}
+	};
+}
+
+#endif
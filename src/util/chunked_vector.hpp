@@ -0,0 +1,467 @@
+#ifndef __CHUNKED_VECTOR_CLASS__
+#define __CHUNKED_VECTOR_CLASS__
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "types.hpp"
+#include "occupancy_bitmap.hpp"
+#include "iteration.hpp"
+#include "index_vector.hpp"
+
+namespace encom {
+	/**
+	 * The number of bytes per chunk, that an allocator prefers, e.g. the size of a huge page.
+	 * Allocators can define a static member preferred_chunk_bytes, otherwise this is 0.
+	 */
+	template<typename Allocator, typename __Specialization=void>
+	struct preferred_chunk_bytes : std::integral_constant<std::size_t, 0> {};
+
+	template<typename Allocator>
+	struct preferred_chunk_bytes<Allocator, std::void_t<decltype(Allocator::preferred_chunk_bytes)>>
+		: std::integral_constant<std::size_t, Allocator::preferred_chunk_bytes> {};
+
+	/**
+	 * The default number of slots per chunk. With a preferred number of chunk_bytes a chunk has as many
+	 * slots as fit into them, so no page of the chunk is used only partially. Otherwise it is the
+	 * smallest power of two, so that a chunk has at least 64 KiB, and indices are split with shifts.
+	 */
+	template<typename T, std::size_t chunk_bytes = 0>
+	constexpr std::size_t default_chunk_size() {
+		if constexpr (chunk_bytes != 0) {
+			return chunk_bytes / sizeof(T) > 0 ? chunk_bytes / sizeof(T) : 1;
+		} else {
+			std::size_t chunk_size = 1;
+			while (chunk_size * sizeof(T) < 65536) {
+				chunk_size *= 2;
+			}
+			return chunk_size;
+		}
+	}
+
+	template<typename Vector, typename ValueType>
+	class chunked_vector_iterator {
+		private:
+			ID_TYPE _index;
+			ID_TYPE _end;
+			Vector* _vec;
+		public:
+			chunked_vector_iterator(ID_TYPE index, ID_TYPE end, Vector* vec)
+				: _index(vec->occupied().find_next(index, end)), _end(end), _vec(vec)
+			{ }
+
+			bool next() {
+				if (_index != _end) {
+					_index = _vec->occupied().find_next(_index+1, _end);
+				}
+				return _index != _end;
+			}
+
+			void operator++() {
+				next();
+			}
+
+			void operator++(int) {
+				next();
+			}
+
+			ValueType& operator*() const {
+				return _vec->get_unchecked(_index);
+			}
+
+			ValueType* operator->() const {
+				return &_vec->get_unchecked(_index);
+			}
+
+			/**
+			 * @returns the index of the element this iterator points to
+			 */
+			ID_TYPE index() const {
+				return _index;
+			}
+
+			bool operator==(const chunked_vector_iterator& other) const {
+				return _index == other._index;
+			}
+
+			bool operator!=(const chunked_vector_iterator& other) const {
+				return _index != other._index;
+			}
+	};
+
+	/**
+	 * A container with the same interface as index_vector, that stores its slots in fixed-size chunks.
+	 * Growing allocates a new chunk and never moves existing elements, so references and pointers to
+	 * elements stay valid until the element is removed. Chunks are kept until the vector is destroyed
+	 * and their slots are reused through the free list.
+	 *
+	 * @tparam T The element type
+	 * @tparam Allocator The allocator used to allocate the chunks. It is rebound to the slot type.
+	 * @tparam ChunkSize The number of slots per chunk. Powers of two split indices with shifts.
+	 * 		   Defaults to the preferred chunk size of the allocator.
+	 */
+	template<
+		typename T,
+		typename Allocator = std::allocator<T>,
+		std::size_t ChunkSize = default_chunk_size<index_vector_slot<T>, preferred_chunk_bytes<Allocator>::value>()
+	>
+	class chunked_vector {
+		private:
+			using slot = index_vector_slot<T>;
+			using slot_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<slot>;
+			using slot_allocator_traits = std::allocator_traits<slot_allocator>;
+
+			static_assert(ChunkSize != 0, "ChunkSize has to be positive");
+
+			static constexpr ID_TYPE NO_SLOT = ~ID_TYPE(0);
+
+			size_t _size;
+			std::vector<slot*> _chunks;
+			ID_TYPE _slot_count;
+			ID_TYPE _free_head;
+			occupancy_bitmap _occupied;
+			slot_allocator _allocator;
+
+			slot& slot_at(const ID_TYPE index) const {
+				return _chunks[index / ChunkSize][index % ChunkSize];
+			}
+
+			void add_chunk() {
+				_chunks.push_back(slot_allocator_traits::allocate(_allocator, ChunkSize));
+				_occupied.resize(_chunks.size() * ChunkSize);
+			}
+
+			/**
+			 * Returns an empty slot and marks it as occupied. The value of the slot is not constructed.
+			 */
+			ID_TYPE acquire_slot() {
+				ID_TYPE index = 0;
+				if (_free_head != NO_SLOT) {
+					index = _free_head;
+					unlink_free_slot(index);
+				} else {
+					if (_slot_count == _chunks.size() * ChunkSize) {
+						add_chunk();
+					}
+					index = _slot_count++;
+				}
+				_occupied.set(index);
+				_size++;
+				return index;
+			}
+
+			/**
+			 * Removes the empty slot at index from the free list.
+			 */
+			void unlink_free_slot(const ID_TYPE index) {
+				const free_slot_links links = slot_at(index).links;
+				if (links.previous == NO_SLOT) {
+					_free_head = links.next;
+				} else {
+					slot_at(links.previous).links.next = links.next;
+				}
+				if (links.next != NO_SLOT) {
+					slot_at(links.next).links.previous = links.previous;
+				}
+			}
+
+			/**
+			 * Puts the empty slot at index at the front of the free list.
+			 */
+			void push_free_slot(const ID_TYPE index) {
+				slot_at(index).links = free_slot_links {_free_head, NO_SLOT};
+				if (_free_head != NO_SLOT) {
+					slot_at(_free_head).links.previous = index;
+				}
+				_free_head = index;
+			}
+
+		public:
+			using iterator = chunked_vector_iterator<chunked_vector, T>;
+			using const_iterator = chunked_vector_iterator<const chunked_vector, const T>;
+
+			static constexpr std::size_t chunk_size = ChunkSize;
+
+			explicit chunked_vector(const Allocator& allocator = Allocator())
+				: _size(0), _slot_count(0), _free_head(NO_SLOT), _allocator(allocator)
+			{}
+
+			chunked_vector(const chunked_vector& other)
+				: chunked_vector(other._allocator)
+			{
+				reserve(other._slot_count);
+				for (ID_TYPE index = 0; index < other._slot_count; ++index) {
+					if (other._occupied.test(index)) {
+						new (&slot_at(index).value) T(other.slot_at(index).value);
+					} else {
+						slot_at(index).links = other.slot_at(index).links;
+					}
+				}
+				_size = other._size;
+				_slot_count = other._slot_count;
+				_free_head = other._free_head;
+				_occupied = other._occupied;
+				_occupied.resize(_chunks.size() * ChunkSize);
+			}
+
+			chunked_vector(chunked_vector&& other) noexcept
+				: _size(other._size), _chunks(std::move(other._chunks)), _slot_count(other._slot_count),
+				  _free_head(other._free_head), _occupied(std::move(other._occupied)), _allocator(other._allocator)
+			{
+				other._chunks.clear();
+				other._size = 0;
+				other._slot_count = 0;
+				other._free_head = NO_SLOT;
+				other._occupied = occupancy_bitmap();
+			}
+
+			chunked_vector& operator=(const chunked_vector& other) {
+				if (this != &other) {
+					chunked_vector copy(other);
+					*this = std::move(copy);
+				}
+				return *this;
+			}
+
+			chunked_vector& operator=(chunked_vector&& other) noexcept {
+				if (this != &other) {
+					std::swap(_size, other._size);
+					std::swap(_chunks, other._chunks);
+					std::swap(_slot_count, other._slot_count);
+					std::swap(_free_head, other._free_head);
+					std::swap(_occupied, other._occupied);
+					std::swap(_allocator, other._allocator);
+				}
+				return *this;
+			}
+
+			~chunked_vector() {
+				for (ID_TYPE index = _occupied.find_next(0, _slot_count); index != _slot_count; index = _occupied.find_next(index+1, _slot_count)) {
+					slot_at(index).value.~T();
+				}
+				for (slot* chunk : _chunks) {
+					slot_allocator_traits::deallocate(_allocator, chunk, ChunkSize);
+				}
+			}
+
+			/**
+			 * Adds the given t into this vector. If there is an empty slot this slot is used.
+			 *
+			 * @param t The instance to add to this vector
+			 * @returns The index where the given instance is added
+			 */
+			ID_TYPE add(const T& t) {
+				return emplace(t);
+			}
+
+			ID_TYPE add(T&& t) {
+				return emplace(std::move(t));
+			}
+
+			/**
+			 * Constructs a new element from the given arguments directly in an empty slot.
+			 *
+			 * @returns The index where the new instance is constructed
+			 */
+			template<typename ...Args>
+			ID_TYPE emplace(Args&&... args) {
+				const ID_TYPE newpos = acquire_slot();
+				new (&slot_at(newpos).value) T(std::forward<Args>(args)...);
+				return newpos;
+			}
+
+			/**
+			 * Constructs a new element at the given index, that has to be empty. The slots skipped behind
+			 * slot_count() become empty slots.
+			 */
+			template<typename ...Args>
+			void emplace_at(const ID_TYPE index, Args&&... args) {
+				if (index < _slot_count) {
+					if (_occupied.test(index)) {
+						throw "Tried to emplace at used index";
+					}
+					unlink_free_slot(index);
+					new (&slot_at(index).value) T(std::forward<Args>(args)...);
+					_occupied.set(index);
+					_size++;
+					return;
+				}
+				reserve(index + 1);
+				for (; _slot_count < index; ++_slot_count) {
+					push_free_slot(_slot_count);
+				}
+				new (&slot_at(index).value) T(std::forward<Args>(args)...);
+				_slot_count = index + 1;
+				_occupied.set(index);
+				_size++;
+			}
+
+			/**
+			 * Moves the element at from into the empty slot to, which can lie behind slot_count() like in
+			 * emplace_at(). The slot from becomes empty.
+			 */
+			void relocate(const ID_TYPE from, const ID_TYPE to) {
+				emplace_at(to, std::move(slot_at(from).value));
+				remove(from);
+			}
+
+			/**
+			 * @returns the first empty slot at or after begin or slot_count(), if there is none
+			 */
+			ID_TYPE find_empty(const ID_TYPE begin) const {
+				return _occupied.find_next_empty(begin, _slot_count);
+			}
+
+			/**
+			 * Drops the empty slots behind the last element and frees the chunks, that are not used
+			 * anymore. Elements are never moved.
+			 */
+			void shrink_to_fit() {
+				while (_slot_count != 0 && !_occupied.test(_slot_count - 1)) {
+					unlink_free_slot(_slot_count - 1);
+					_slot_count--;
+				}
+				const std::size_t number_of_chunks = (_slot_count + ChunkSize - 1) / ChunkSize;
+				while (_chunks.size() > number_of_chunks) {
+					slot_allocator_traits::deallocate(_allocator, _chunks.back(), ChunkSize);
+					_chunks.pop_back();
+				}
+				_occupied.resize(_chunks.size() * ChunkSize);
+			}
+
+			/**
+			 * Allocates enough chunks, so that this vector can hold number_of_elements elements.
+			 */
+			void reserve(const size_t number_of_elements) {
+				while (_chunks.size() * ChunkSize < number_of_elements) {
+					add_chunk();
+				}
+			}
+
+			bool has_index(const ID_TYPE index) const {
+				return (index < _slot_count) && _occupied.test(index);
+			}
+
+			/**
+			 * Removes the object at the given index. If there is no element at the specified index,
+			 * nothing happens and false is returned.
+			 *
+			 * @returns true, if there was an element at the specified index, otherwise false
+			 */
+			bool remove(const ID_TYPE index) {
+				if (has_index(index)) {
+					slot& s = slot_at(index);
+					s.value.~T();
+					push_free_slot(index);
+					_occupied.reset(index);
+					--_size;
+					return true;
+				}
+				return false;
+			}
+
+			/**
+			 * Returns the element at the specified index. If there is no element at the
+			 * specified index an exception is thrown.
+			 */
+			const T& get(const ID_TYPE index) const {
+				if (has_index(index)) {
+					return slot_at(index).value;
+				} else {
+					throw "Tried to get invalid index";
+				}
+			}
+
+			T& get(const ID_TYPE index) {
+				if (has_index(index)) {
+					return slot_at(index).value;
+				} else {
+					throw "Tried to get invalid index";
+				}
+			}
+
+			const T& get_unchecked(const ID_TYPE index) const {
+				return slot_at(index).value;
+			}
+
+			T& get_unchecked(const ID_TYPE index) {
+				return slot_at(index).value;
+			}
+
+			void prefetch(const ID_TYPE index) const {
+				__builtin_prefetch(&slot_at(index));
+			}
+
+			ID_TYPE position_count() const {
+				return _slot_count;
+			}
+
+			/**
+			 * Executes func for every element in the slots [begin, end), until func returns false.
+			 *
+			 * @returns false, if func stopped the iteration
+			 */
+			template<typename Func>
+			bool for_each_in(ID_TYPE begin, ID_TYPE end, Func&& func) {
+				end = end < _slot_count ? end : _slot_count;
+				return _occupied.for_each_set(begin, end, [this, &func](ID_TYPE index) {
+					return continue_iteration(func, slot_at(index).value);
+				});
+			}
+
+			template<typename Func>
+			bool for_each_in(ID_TYPE begin, ID_TYPE end, Func&& func) const {
+				end = end < _slot_count ? end : _slot_count;
+				return _occupied.for_each_set(begin, end, [this, &func](ID_TYPE index) {
+					return continue_iteration(func, static_cast<const T&>(slot_at(index).value));
+				});
+			}
+
+			const occupancy_bitmap& occupied() const {
+				return _occupied;
+			}
+
+			iterator begin() {
+				return iterator(0, _slot_count, this);
+			}
+
+			iterator end() {
+				return iterator(_slot_count, _slot_count, this);
+			}
+
+			const_iterator begin() const {
+				return const_iterator(0, _slot_count, this);
+			}
+
+			const_iterator end() const {
+				return const_iterator(_slot_count, _slot_count, this);
+			}
+
+			size_t size() const {
+				return _size;
+			}
+
+			ID_TYPE slot_count() const {
+				return _slot_count;
+			}
+
+			/**
+			 * @returns the number of slots in all chunks
+			 */
+			ID_TYPE capacity() const {
+				return _chunks.size() * ChunkSize;
+			}
+
+			/**
+			 * @returns the bytes allocated for the chunks and the occupancy bitmap
+			 */
+			size_t allocated_bytes() const {
+				return _chunks.size() * ChunkSize * sizeof(slot) + _occupied.number_of_words() * sizeof(std::uint64_t);
+			}
+	};
+}
+
+#endif
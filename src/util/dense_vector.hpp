@@ -0,0 +1,342 @@
+#ifndef __DENSE_VECTOR_CLASS__
+#define __DENSE_VECTOR_CLASS__
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "types.hpp"
+#include "sparse_table.hpp"
+#include "iteration.hpp"
+
+namespace encom {
+	template<typename T, typename DenseT>
+	class dense_vector_iterator {
+		private:
+			DenseT* _element;
+			const encom::ID_TYPE* _sparse_index;
+		public:
+			dense_vector_iterator(DenseT* element, const encom::ID_TYPE* sparse_index)
+				: _element(element), _sparse_index(sparse_index)
+			{ }
+
+			void operator++() {
+				++_element;
+				++_sparse_index;
+			}
+
+			void operator++(int) {
+				++_element;
+				++_sparse_index;
+			}
+
+			DenseT& operator*() const {
+				return *_element;
+			}
+
+			DenseT* operator->() const {
+				return _element;
+			}
+
+			/**
+			 * @returns the (stable) index of the element this iterator points to
+			 */
+			encom::ID_TYPE index() const {
+				return *_sparse_index;
+			}
+
+			bool operator==(const dense_vector_iterator& other) const {
+				return _element == other._element;
+			}
+
+			bool operator!=(const dense_vector_iterator& other) const {
+				return _element != other._element;
+			}
+	};
+
+	/**
+	 * A sparse set with the same interface as index_vector. The elements are kept packed in one
+	 * contiguous array, so iterating is a linear scan without hole checks. Removing an element
+	 * moves the last element into its place (swap-and-pop).
+	 *
+	 * The indices handed out by add() are stable. They point into a sparse table, that maps
+	 * them to the current position in the dense array.
+	 */
+	template<typename T>
+	class dense_vector {
+		private:
+			std::vector<T> _dense;
+			std::vector<ID_TYPE> _dense_to_sparse;
+			sparse_table _sparse;
+
+		public:
+			using iterator = dense_vector_iterator<T, T>;
+			using const_iterator = dense_vector_iterator<T, const T>;
+
+			/**
+			 * Constructs a new dense vector with no elements.
+			 */
+			dense_vector() = default;
+
+			/**
+			 * Adds the given t at the end of the dense array.
+			 *
+			 * @param t The instance to add to this vector
+			 * @returns The stable index of the added instance
+			 */
+			encom::ID_TYPE add(const T& t) {
+				return emplace(t);
+			}
+
+			/**
+			 * Moves the given t to the end of the dense array.
+			 *
+			 * @param t The instance to move into this vector
+			 * @returns The stable index of the added instance
+			 */
+			encom::ID_TYPE add(T&& t) {
+				return emplace(std::move(t));
+			}
+
+			/**
+			 * Constructs a new element from the given arguments at the end of the dense array.
+			 *
+			 * @param args The arguments passed to the constructor of T
+			 * @returns The stable index of the new instance
+			 */
+			template<typename ...Args>
+			encom::ID_TYPE emplace(Args&&... args) {
+				const ID_TYPE index = _sparse.acquire(_dense.size());
+				_dense.emplace_back(std::forward<Args>(args)...);
+				_dense_to_sparse.push_back(index);
+				return index;
+			}
+
+			/**
+			 * Constructs a new element with the given unused stable index (see sparse_table::acquire_at()).
+			 */
+			template<typename ...Args>
+			void emplace_at(const encom::ID_TYPE index, Args&&... args) {
+				if (_sparse.contains(index)) {
+					throw "Tried to emplace at used index";
+				}
+				_sparse.acquire_at(index, _dense.size());
+				_dense.emplace_back(std::forward<Args>(args)...);
+				_dense_to_sparse.push_back(index);
+			}
+
+			/**
+			 * Allocates enough memory, so that this vector can hold number_of_elements elements without
+			 * reallocating.
+			 */
+			void reserve(const size_t number_of_elements) {
+				_dense.reserve(number_of_elements);
+				_dense_to_sparse.reserve(number_of_elements);
+				_sparse.reserve(number_of_elements);
+			}
+
+			/**
+			 * @param index The index to check
+			 * @returns true, if there is an element at the specified index, otherwise false
+			 */
+			bool has_index(const encom::ID_TYPE index) const {
+				return _sparse.contains(index);
+			}
+
+			/**
+			 * Removes the object at the given index by moving the last element into its place.
+			 * If there is no element at the specified index, nothing happens and false is returned.
+			 *
+			 * @param index The index where to remove the element
+			 * @returns true, if there was an element at the specified index, otherwise false
+			 */
+			bool remove(encom::ID_TYPE index) {
+				if (!has_index(index)) {
+					return false;
+				}
+				const ID_TYPE position = _sparse.position(index);
+				const ID_TYPE last = _dense.size() - 1;
+				if (position != last) {
+					_dense[position] = std::move(_dense[last]);
+					_dense_to_sparse[position] = _dense_to_sparse[last];
+					_sparse.set_position(_dense_to_sparse[position], position);
+				}
+				_dense.pop_back();
+				_dense_to_sparse.pop_back();
+				_sparse.release(index);
+				return true;
+			}
+
+			/**
+			 * Returns the element at the specified index. If there is no element at the
+			 * specified index an exception is thrown.
+			 *
+			 * @param index The index specifying the element to get
+			 * @returns The element at the given index
+			 */
+			const T& get(const encom::ID_TYPE index) const {
+				if (has_index(index)) {
+					return _dense[_sparse.position(index)];
+				} else {
+					throw "Tried to get invalid index";
+				}
+			}
+
+			/**
+			 * Returns the element at the specified index. If there is no element at the
+			 * specified index an exception is thrown.
+			 *
+			 * @param index The index specifying the element to get
+			 * @returns The element at the given index
+			 */
+			T& get(const encom::ID_TYPE index) {
+				if (has_index(index)) {
+					return _dense[_sparse.position(index)];
+				} else {
+					throw "Tried to get invalid index";
+				}
+			}
+
+			/**
+			 * Returns the element at the specified index without checking, whether the index is valid.
+			 */
+			const T& get_unchecked(const encom::ID_TYPE index) const {
+				return _dense[_sparse.position(index)];
+			}
+
+			T& get_unchecked(const encom::ID_TYPE index) {
+				return _dense[_sparse.position(index)];
+			}
+
+			/**
+			 * Hints the cpu to load the element at the given index into the cache.
+			 */
+			void prefetch(const encom::ID_TYPE index) const {
+				__builtin_prefetch(&_dense[_sparse.position(index)]);
+			}
+
+			/**
+			 * @returns the position of the element at the given index in the dense array
+			 */
+			encom::ID_TYPE position_of(const encom::ID_TYPE index) const {
+				return _sparse.position(index);
+			}
+
+			/**
+			 * @returns the index of the element at the given position in the dense array
+			 */
+			encom::ID_TYPE index_at_position(const encom::ID_TYPE position) const {
+				return _dense_to_sparse[position];
+			}
+
+			/**
+			 * Exchanges the elements at two positions in the dense array. Their indices stay the same.
+			 */
+			void swap_positions(const encom::ID_TYPE a, const encom::ID_TYPE b) {
+				std::swap(_dense[a], _dense[b]);
+				std::swap(_dense_to_sparse[a], _dense_to_sparse[b]);
+				_sparse.set_position(_dense_to_sparse[a], a);
+				_sparse.set_position(_dense_to_sparse[b], b);
+			}
+
+			/**
+			 * Releases the capacity, that is not used by the elements.
+			 */
+			void shrink_to_fit() {
+				_dense.shrink_to_fit();
+				_dense_to_sparse.shrink_to_fit();
+				_sparse.shrink_to_fit();
+			}
+
+			/**
+			 * @returns the number of positions, that for_each_in() accepts. For a dense_vector the
+			 * 			positions are the positions in the dense array.
+			 */
+			encom::ID_TYPE position_count() const {
+				return _dense.size();
+			}
+
+			/**
+			 * Executes func for every element at the dense positions [begin, end), until func returns false.
+			 *
+			 * @returns false, if func stopped the iteration
+			 */
+			template<typename Func>
+			bool for_each_in(encom::ID_TYPE begin, encom::ID_TYPE end, Func&& func) {
+				end = end < _dense.size() ? end : _dense.size();
+				for (encom::ID_TYPE position = begin; position < end; position++) {
+					if (!encom::continue_iteration(func, _dense[position])) {
+						return false;
+					}
+				}
+				return true;
+			}
+
+			template<typename Func>
+			bool for_each_in(encom::ID_TYPE begin, encom::ID_TYPE end, Func&& func) const {
+				end = end < _dense.size() ? end : _dense.size();
+				for (encom::ID_TYPE position = begin; position < end; position++) {
+					if (!encom::continue_iteration(func, static_cast<const T&>(_dense[position]))) {
+						return false;
+					}
+				}
+				return true;
+			}
+
+			iterator begin() {
+				return iterator(_dense.data(), _dense_to_sparse.data());
+			}
+
+			iterator end() {
+				return iterator(_dense.data() + _dense.size(), _dense_to_sparse.data() + _dense.size());
+			}
+
+			const_iterator begin() const {
+				return const_iterator(_dense.data(), _dense_to_sparse.data());
+			}
+
+			const_iterator end() const {
+				return const_iterator(_dense.data() + _dense.size(), _dense_to_sparse.data() + _dense.size());
+			}
+
+			/**
+			 * @returns the number of elements in this vector
+			 */
+			size_t size() const {
+				return _dense.size();
+			}
+
+			/**
+			 * @returns the number of entries in the sparse table. Every valid index is smaller than this.
+			 */
+			encom::ID_TYPE slot_count() const {
+				return _sparse.size();
+			}
+
+			/**
+			 * @returns the number of elements, that fit into the dense array without reallocating
+			 */
+			size_t capacity() const {
+				return _dense.capacity();
+			}
+
+			/**
+			 * @returns the bytes allocated for the dense array and the index tables
+			 */
+			size_t allocated_bytes() const {
+				return _dense.capacity() * sizeof(T) + _dense_to_sparse.capacity() * sizeof(ID_TYPE) + _sparse.allocated_bytes();
+			}
+
+			/**
+			 * @returns a pointer to the packed elements. There are size() elements.
+			 */
+			T* data() {
+				return _dense.data();
+			}
+
+			const T* data() const {
+				return _dense.data();
+			}
+	};
+}
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef __HASH_INDEX_CLASS__
+#define __HASH_INDEX_CLASS__
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "types.hpp"
+
+namespace encom {
+	/**
+	 * @returns the well mixed hash, that is never 0 (the empty entry of hash_index)
+	 */
+	inline std::uint64_t mix_hash(std::uint64_t hash) {
+		hash ^= hash >> 33;
+		hash *= 0xff51afd7ed558ccdULL;
+		hash ^= hash >> 33;
+		hash *= 0xc4ceb9fe1a85ec53ULL;
+		hash ^= hash >> 33;
+		return hash | (std::uint64_t(1) << 63);
+	}
+
+	/**
+	 * An open addressing hash map from keys to values with linear probing, that can hold multiple
+	 * values per key. Every entry stores the hash of its key, so probing compares keys only on equal
+	 * hashes and entries can be erased by hash and value without the key. Erasing shifts the following
+	 * entries back, so there are no tombstones.
+	 *
+	 * The hashes passed in have to come from hash_key().
+	 */
+	template<typename Key, typename Value>
+	class hash_index {
+		private:
+			static constexpr std::uint64_t EMPTY = 0;
+			static constexpr std::size_t MIN_CAPACITY = 16;
+
+			struct entry {
+				std::uint64_t hash;
+				Key key;
+				Value value;
+			};
+
+			std::vector<entry> _entries;
+			std::size_t _size;
+			std::size_t _mask;
+
+			std::size_t home(const std::uint64_t hash) const {
+				return hash & _mask;
+			}
+
+			void grow() {
+				std::vector<entry> old_entries(_entries.empty() ? MIN_CAPACITY : _entries.size() * 2);
+				std::swap(old_entries, _entries);
+				_mask = _entries.size() - 1;
+				for (entry& e : old_entries) {
+					if (e.hash != EMPTY) {
+						std::size_t position = home(e.hash);
+						while (_entries[position].hash != EMPTY) {
+							position = (position + 1) & _mask;
+						}
+						_entries[position] = std::move(e);
+					}
+				}
+			}
+
+		public:
+			hash_index()
+				: _size(0), _mask(0)
+			{}
+
+			/**
+			 * @returns the well mixed hash of key, that is never EMPTY
+			 */
+			static std::uint64_t hash_key(const Key& key) {
+				return mix_hash(std::hash<Key>()(key));
+			}
+
+			void insert(const std::uint64_t hash, const Key& key, const Value& value) {
+				// keep the load factor at most 3/4
+				if ((_size + 1) * 4 > _entries.size() * 3) {
+					grow();
+				}
+				std::size_t position = home(hash);
+				while (_entries[position].hash != EMPTY) {
+					position = (position + 1) & _mask;
+				}
+				_entries[position] = entry {hash, key, value};
+				_size++;
+			}
+
+			/**
+			 * @returns a pointer to a value of key or nullptr, if there is no such value
+			 */
+			const Value* find(const std::uint64_t hash, const Key& key) const {
+				if (_size == 0) {
+					return nullptr;
+				}
+				for (std::size_t position = home(hash); _entries[position].hash != EMPTY; position = (position + 1) & _mask) {
+					if (_entries[position].hash == hash && _entries[position].key == key) {
+						return &_entries[position].value;
+					}
+				}
+				return nullptr;
+			}
+
+			/**
+			 * Calls func(value) for every value of key.
+			 */
+			template<typename Func>
+			void find_all(const std::uint64_t hash, const Key& key, Func&& func) const {
+				if (_size == 0) {
+					return;
+				}
+				for (std::size_t position = home(hash); _entries[position].hash != EMPTY; position = (position + 1) & _mask) {
+					if (_entries[position].hash == hash && _entries[position].key == key) {
+						func(_entries[position].value);
+					}
+				}
+			}
+
+			/**
+			 * Erases the entry with the given hash and value.
+			 *
+			 * @returns whether there was such an entry
+			 */
+			bool erase(const std::uint64_t hash, const Value& value) {
+				if (_size == 0) {
+					return false;
+				}
+				std::size_t position = home(hash);
+				while (!(_entries[position].hash == hash && _entries[position].value == value)) {
+					if (_entries[position].hash == EMPTY) {
+						return false;
+					}
+					position = (position + 1) & _mask;
+				}
+				// shift back every following entry, that may be stored at the freed position
+				for (std::size_t next = (position + 1) & _mask; _entries[next].hash != EMPTY; next = (next + 1) & _mask) {
+					if (((next - home(_entries[next].hash)) & _mask) >= ((next - position) & _mask)) {
+						_entries[position] = std::move(_entries[next]);
+						position = next;
+					}
+				}
+				_entries[position] = entry {EMPTY, Key(), Value()};
+				_size--;
+				return true;
+			}
+
+			void clear() {
+				_entries.clear();
+				_size = 0;
+				_mask = 0;
+			}
+
+			std::size_t size() const {
+				return _size;
+			}
+	};
+}
+
+#endif
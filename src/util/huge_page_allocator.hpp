@@ -0,0 +1,90 @@
+#ifndef __HUGE_PAGE_ALLOCATOR_CLASS__
+#define __HUGE_PAGE_ALLOCATOR_CLASS__
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace encom {
+	/**
+	 * An allocator, that maps large allocations directly from the kernel and asks for transparent huge
+	 * pages with madvise(MADV_HUGEPAGE). This reduces TLB misses when iterating over large chunks of
+	 * big component types. The mappings are aligned to HUGE_PAGE_SIZE, so the kernel can back them with
+	 * huge pages from the first byte. Allocations smaller than half a huge page, and allocations on
+	 * systems without madvise, use operator new.
+	 */
+	template<typename T>
+	struct huge_page_allocator {
+		using value_type = T;
+
+		static constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+		// containers, that allocate in chunks, use chunks of one huge page
+		static constexpr std::size_t preferred_chunk_bytes = HUGE_PAGE_SIZE;
+		// smaller allocations would waste more than half of their huge page
+		static constexpr std::size_t MIN_MAPPED_SIZE = HUGE_PAGE_SIZE / 2;
+
+		template<typename U>
+		struct rebind {
+			using other = huge_page_allocator<U>;
+		};
+
+		huge_page_allocator() = default;
+
+		template<typename U>
+		huge_page_allocator(const huge_page_allocator<U>&) {}
+
+		static std::size_t mapped_size(const std::size_t n) {
+			return (n * sizeof(T) + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+		}
+
+		T* allocate(const std::size_t n) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+			if (n * sizeof(T) >= MIN_MAPPED_SIZE) {
+				// mmap only aligns to normal pages, so one huge page more is mapped and the slack around
+				// the aligned range is unmapped again
+				const std::size_t size = mapped_size(n);
+				void* memory = mmap(nullptr, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				if (memory == MAP_FAILED) {
+					throw std::bad_alloc();
+				}
+				char* const begin = static_cast<char*>(memory);
+				char* const aligned = begin + (HUGE_PAGE_SIZE - reinterpret_cast<std::uintptr_t>(begin) % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+				if (aligned != begin) {
+					munmap(begin, aligned - begin);
+				}
+				munmap(aligned + size, begin + HUGE_PAGE_SIZE - aligned);
+				// only a hint: without transparent huge pages the memory is backed by normal pages
+				madvise(aligned, size, MADV_HUGEPAGE);
+				return reinterpret_cast<T*>(aligned);
+			}
+#endif
+			return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+		}
+
+		void deallocate(T* p, const std::size_t n) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+			if (n * sizeof(T) >= MIN_MAPPED_SIZE) {
+				munmap(p, mapped_size(n));
+				return;
+			}
+#endif
+			::operator delete(p, std::align_val_t(alignof(T)));
+		}
+
+		template<typename U>
+		bool operator==(const huge_page_allocator<U>&) const {
+			return true;
+		}
+
+		template<typename U>
+		bool operator!=(const huge_page_allocator<U>&) const {
+			return false;
+		}
+	};
+}
+
+#endif
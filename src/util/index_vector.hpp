@@ -1,45 +1,60 @@
 #ifndef __INDEX_VECTOR_CLASS__
 #define __INDEX_VECTOR_CLASS__
 
-#include <vector>
-#include <unordered_set>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include "types.hpp"
+#include "occupancy_bitmap.hpp"
+#include "iteration.hpp"
 
 namespace encom {
+	/**
+	 * The neighbours of an empty slot in the free list
+	 */
+	struct free_slot_links {
+		ID_TYPE next;
+		ID_TYPE previous;
+	};
+
+	/**
+	 * A slot of an index_vector. An occupied slot holds a value, an empty slot holds the indices of
+	 * its neighbours in the free list (intrusive doubly linked list).
+	 */
+	template<typename T>
+	union index_vector_slot {
+		T value;
+		free_slot_links links;
+
+		index_vector_slot() {}
+		~index_vector_slot() {}
+	};
+
 	template<typename T>
 	class index_vector_iterator {
 		private:
 			encom::ID_TYPE _index;
 			encom::ID_TYPE _end;
-			std::vector<T>* const _vec;
-			const std::unordered_set<encom::ID_TYPE>* const _holes;
+			index_vector_slot<T>* _slots;
+			const occupancy_bitmap* _occupied;
 		public:
 			index_vector_iterator(
 					encom::ID_TYPE index,
 					encom::ID_TYPE end,
-					std::vector<T>* vec,
-					const std::unordered_set<encom::ID_TYPE>* const holes
+					index_vector_slot<T>* slots,
+					const occupancy_bitmap* occupied
 			)
-				: _index(index), _vec(vec), _end(end), _holes(holes)
-			{
-				// make sure to not start with a hole
-				if (points_to_hole()) {
-					next();
-				}
-			}
-
-			bool points_to_hole() const {
-				return _holes->find(_index) != _holes->end();
-			}
+				: _index(occupied->find_next(index, end)), _end(end), _slots(slots), _occupied(occupied)
+			{ }
 
 			bool next() {
-				while (_index != _end) {
-					++_index;
-					if (!points_to_hole()) {
-						return true;
-					}
+				if (_index != _end) {
+					_index = _occupied->find_next(_index+1, _end);
 				}
-				return false;
+				return _index != _end;
 			}
 
 			void operator++() {
@@ -50,8 +65,19 @@ namespace encom {
 				next();
 			}
 
-			T& operator*() {
-				return (*_vec)[_index];
+			T& operator*() const {
+				return _slots[_index].value;
+			}
+
+			T* operator->() const {
+				return &_slots[_index].value;
+			}
+
+			/**
+			 * @returns the index of the element this iterator points to
+			 */
+			encom::ID_TYPE index() const {
+				return _index;
 			}
 
 			bool operator==(const index_vector_iterator& other) const {
@@ -68,51 +94,47 @@ namespace encom {
 		private:
 			encom::ID_TYPE _index;
 			encom::ID_TYPE _end;
-			const std::vector<T>* const _vec;
-			const std::unordered_set<encom::ID_TYPE>* const _holes;
+			const index_vector_slot<T>* _slots;
+			const occupancy_bitmap* _occupied;
 
 		public:
 			const_index_vector_iterator(
 					encom::ID_TYPE index,
 					encom::ID_TYPE end,
-					const std::vector<T>* const vec,
-					const std::unordered_set<encom::ID_TYPE>* const holes
+					const index_vector_slot<T>* slots,
+					const occupancy_bitmap* occupied
 			)
-				: _index(index), _vec(vec), _end(end), _holes(holes)
-			{
-				// make sure to not start with a hole
-				if (points_to_hole()) {
-					next();
-				}
-			}
-
-			bool points_to_hole() const {
-				return _holes->find(_index) != _holes->end();
-			}
+				: _index(occupied->find_next(index, end)), _end(end), _slots(slots), _occupied(occupied)
+			{ }
 
 			bool next() {
-				while (_index != _end) {
-					++_index;
-					if (!points_to_hole()) {
-						return true;
-					}
+				if (_index != _end) {
+					_index = _occupied->find_next(_index+1, _end);
 				}
-				return false;
+				return _index != _end;
 			}
 
-			const T& operator++() {
+			void operator++() {
 				next();
-				return (*_vec)[_index];
 			}
 
-			const T& operator++(int) {
-				T* last = &(*_vec)[_index];
+			void operator++(int) {
 				next();
-				return *last;
 			}
 
 			const T& operator*() const {
-				return (*_vec)[_index];
+				return _slots[_index].value;
+			}
+
+			const T* operator->() const {
+				return &_slots[_index].value;
+			}
+
+			/**
+			 * @returns the index of the element this iterator points to
+			 */
+			encom::ID_TYPE index() const {
+				return _index;
 			}
 
 			bool operator==(const const_index_vector_iterator& other) const {
@@ -129,13 +151,152 @@ namespace encom {
 	 * is not changing, even if elements before this element are removed. If
 	 * an element is removed it leaves an empty slot. New elements are inserted
 	 * at these empty slots.
+	 *
+	 * Empty slots are chained into an intrusive doubly linked free list, so the most recently freed
+	 * slot is reused first and any empty slot can be taken in O(1). Which slots are occupied is
+	 * tracked by an occupancy bitmap, so checking an index and iterating over the elements never
+	 * touches empty slots.
 	 */
 	template<typename T>
 	class index_vector {
 		private:
+			using slot = index_vector_slot<T>;
+
+			static constexpr ID_TYPE NO_SLOT = ~ID_TYPE(0);
+			static constexpr ID_TYPE MIN_CAPACITY = 8;
+
 			size_t _size;
-			std::vector<T> _instances;
-			std::unordered_set<encom::ID_TYPE> _holes;
+			slot* _slots;
+			ID_TYPE _capacity;
+			ID_TYPE _slot_count;
+			ID_TYPE _free_head;
+			occupancy_bitmap _occupied;
+			// whether _slots belongs to someone else, see adopt()
+			bool _borrowed;
+
+			/**
+			 * Zeroes the bytes of n slots. Slots of trivially copyable types are written to snapshots as
+			 * raw bytes (see storage_snapshot), so their padding and the empty slots have to be defined.
+			 * Values keep the padding bytes, that they are constructed with.
+			 */
+			static void zero_slots([[maybe_unused]] slot* slots, [[maybe_unused]] const ID_TYPE n) {
+				if constexpr (std::is_trivially_copyable_v<T>) {
+					std::memset(static_cast<void*>(slots), 0, n * sizeof(slot));
+				}
+			}
+
+			/**
+			 * Moves all slots into a new allocation with the given capacity.
+			 */
+			void reallocate(const ID_TYPE new_capacity) {
+				reallocate(new_capacity, [](slot*) {});
+			}
+
+			/**
+			 * Like reallocate(), but calls construct with the new allocation before the slots are moved,
+			 * so a new element can be constructed from arguments, that reference an element of this vector.
+			 */
+			template<typename Construct>
+			void reallocate(const ID_TYPE new_capacity, Construct&& construct) {
+				std::allocator<slot> allocator;
+				slot* new_slots = allocator.allocate(new_capacity);
+				zero_slots(new_slots, new_capacity);
+				try {
+					construct(new_slots);
+				} catch (...) {
+					allocator.deallocate(new_slots, new_capacity);
+					throw;
+				}
+				for (ID_TYPE index = 0; index < _slot_count; ++index) {
+					if (_occupied.test(index)) {
+						new (&new_slots[index].value) T(std::move(_slots[index].value));
+						_slots[index].value.~T();
+					} else {
+						new_slots[index].links = _slots[index].links;
+					}
+				}
+				if (_slots != nullptr && !_borrowed) {
+					allocator.deallocate(_slots, _capacity);
+				}
+				_slots = new_slots;
+				_capacity = new_capacity;
+				_borrowed = false;
+				_occupied.resize(new_capacity);
+			}
+
+			/**
+			 * Returns an empty slot and marks it as occupied. The value of the slot is not constructed.
+			 */
+			ID_TYPE acquire_slot() {
+				ID_TYPE index = 0;
+				if (_free_head != NO_SLOT) {
+					index = _free_head;
+					unlink_free_slot(index);
+				} else {
+					if (_slot_count == _capacity) {
+						reallocate(grown_capacity(_capacity));
+					}
+					index = _slot_count++;
+				}
+				_occupied.set(index);
+				_size++;
+				return index;
+			}
+
+			/**
+			 * @returns the capacity to grow to, so that the slot at index fits
+			 */
+			ID_TYPE grown_capacity(const ID_TYPE index) const {
+				const ID_TYPE doubled = _capacity < MIN_CAPACITY ? MIN_CAPACITY : _capacity * 2;
+				return index < doubled ? doubled : index + 1;
+			}
+
+			/**
+			 * Removes the empty slot at index from the free list.
+			 */
+			void unlink_free_slot(const ID_TYPE index) {
+				const free_slot_links links = _slots[index].links;
+				if (links.previous == NO_SLOT) {
+					_free_head = links.next;
+				} else {
+					_slots[links.previous].links.next = links.next;
+				}
+				if (links.next != NO_SLOT) {
+					_slots[links.next].links.previous = links.previous;
+				}
+				if constexpr (std::is_trivially_copyable_v<T>) {
+					// the rest of the slot was zeroed, when it became empty
+					_slots[index].links = free_slot_links {0, 0};
+				}
+			}
+
+			/**
+			 * Puts the empty slot at index at the front of the free list.
+			 */
+			void push_free_slot(const ID_TYPE index) {
+				_slots[index].links = free_slot_links {_free_head, NO_SLOT};
+				if (_free_head != NO_SLOT) {
+					_slots[_free_head].links.previous = index;
+				}
+				_free_head = index;
+			}
+
+			void destroy_all() {
+				for (ID_TYPE index = _occupied.find_next(0, _slot_count); index != _slot_count; index = _occupied.find_next(index+1, _slot_count)) {
+					_slots[index].value.~T();
+				}
+				if (_slots != nullptr && !_borrowed) {
+					std::allocator<slot>().deallocate(_slots, _capacity);
+				}
+				_slots = nullptr;
+				_borrowed = false;
+				_capacity = 0;
+				_slot_count = 0;
+				_size = 0;
+				_free_head = NO_SLOT;
+				_occupied = occupancy_bitmap();
+			}
+
 		public:
 			using iterator = index_vector_iterator<T>;
 			using const_iterator = const_index_vector_iterator<T>;
@@ -143,7 +304,66 @@ namespace encom {
 			/**
 			 * Constructs a new index vector with no elements.
 			 */
-			index_vector() : _size(0) {}
+			index_vector()
+				: _size(0), _slots(nullptr), _capacity(0), _slot_count(0), _free_head(NO_SLOT), _borrowed(false)
+			{}
+
+			index_vector(const index_vector& other)
+				: _size(other._size), _slots(nullptr), _capacity(0), _slot_count(other._slot_count),
+				  _free_head(other._free_head), _occupied(other._occupied), _borrowed(false)
+			{
+				if (other._capacity != 0) {
+					_slots = std::allocator<slot>().allocate(other._capacity);
+					_capacity = other._capacity;
+					zero_slots(_slots, _capacity);
+				}
+				for (ID_TYPE index = 0; index < _slot_count; ++index) {
+					if (_occupied.test(index)) {
+						new (&_slots[index].value) T(other._slots[index].value);
+					} else {
+						_slots[index].links = other._slots[index].links;
+					}
+				}
+			}
+
+			index_vector(index_vector&& other) noexcept
+				: _size(other._size), _slots(other._slots), _capacity(other._capacity), _slot_count(other._slot_count),
+				  _free_head(other._free_head), _occupied(std::move(other._occupied)), _borrowed(other._borrowed)
+			{
+				other._slots = nullptr;
+				other._borrowed = false;
+				other._capacity = 0;
+				other._slot_count = 0;
+				other._size = 0;
+				other._free_head = NO_SLOT;
+				other._occupied = occupancy_bitmap();
+			}
+
+			index_vector& operator=(const index_vector& other) {
+				if (this != &other) {
+					index_vector copy(other);
+					*this = std::move(copy);
+				}
+				return *this;
+			}
+
+			index_vector& operator=(index_vector&& other) noexcept {
+				if (this != &other) {
+					destroy_all();
+					std::swap(_size, other._size);
+					std::swap(_slots, other._slots);
+					std::swap(_capacity, other._capacity);
+					std::swap(_slot_count, other._slot_count);
+					std::swap(_free_head, other._free_head);
+					std::swap(_occupied, other._occupied);
+					std::swap(_borrowed, other._borrowed);
+				}
+				return *this;
+			}
+
+			~index_vector() {
+				destroy_all();
+			}
 
 			/**
 			 * Adds the given t into this vector. If there is an empty slot
@@ -153,18 +373,164 @@ namespace encom {
 			 * @returns The index where the given instance is added
 			 */
 			encom::ID_TYPE add(const T& t) {
-				encom::ID_TYPE newpos = 0;
-				if (_holes.empty()) {
-					_instances.push_back(t);
-					newpos = _instances.size() - 1;
+				return emplace(t);
+			}
+
+			/**
+			 * Moves the given t into this vector. If there is an empty slot this slot is used.
+			 *
+			 * @param t The instance to move into this vector
+			 * @returns The index where the given instance is added
+			 */
+			encom::ID_TYPE add(T&& t) {
+				return emplace(std::move(t));
+			}
+
+			/**
+			 * Constructs a new element from the given arguments directly in an empty slot. The arguments
+			 * can reference an element of this vector.
+			 *
+			 * @param args The arguments passed to the constructor of T
+			 * @returns The index where the new instance is constructed
+			 */
+			template<typename ...Args>
+			encom::ID_TYPE emplace(Args&&... args) {
+				if (_free_head == NO_SLOT && _slot_count == _capacity) {
+					const encom::ID_TYPE newpos = _slot_count;
+					emplace_at(newpos, std::forward<Args>(args)...);
+					return newpos;
+				}
+				const encom::ID_TYPE newpos = acquire_slot();
+				new (&_slots[newpos].value) T(std::forward<Args>(args)...);
+				return newpos;
+			}
+
+			/**
+			 * Constructs a new element at the given index, that has to be empty. Indices behind
+			 * slot_count() are used to fill indices, that were handed out in advance, the skipped slots
+			 * become empty slots.
+			 *
+			 * @param index The index of the new element
+			 * @param args The arguments passed to the constructor of T
+			 */
+			template<typename ...Args>
+			void emplace_at(const encom::ID_TYPE index, Args&&... args) {
+				if (index < _slot_count) {
+					if (_occupied.test(index)) {
+						throw "Tried to emplace at used index";
+					}
+					unlink_free_slot(index);
+					new (&_slots[index].value) T(std::forward<Args>(args)...);
+					_occupied.set(index);
+					_size++;
+					return;
+				}
+				if (index >= _capacity) {
+					// constructed before the old slots are moved, because args can reference one of them
+					reallocate(grown_capacity(index), [&](slot* new_slots) {
+						new (&new_slots[index].value) T(std::forward<Args>(args)...);
+					});
 				} else {
-					const std::unordered_set<encom::ID_TYPE>::const_iterator b = _holes.begin();
-					newpos = *b;
-					_instances[newpos] = t;
-					_holes.erase(b);
+					new (&_slots[index].value) T(std::forward<Args>(args)...);
+				}
+				for (; _slot_count < index; ++_slot_count) {
+					push_free_slot(_slot_count);
 				}
+				_slot_count = index + 1;
+				_occupied.set(index);
 				_size++;
-				return newpos;
+			}
+
+			/**
+			 * Moves the element at from into the empty slot to, which can lie behind slot_count() like in
+			 * emplace_at(). The slot from becomes empty.
+			 */
+			void relocate(const encom::ID_TYPE from, const encom::ID_TYPE to) {
+				emplace_at(to, std::move(_slots[from].value));
+				remove(from);
+			}
+
+			/**
+			 * @returns the first empty slot at or after begin or slot_count(), if there is none
+			 */
+			encom::ID_TYPE find_empty(const encom::ID_TYPE begin) const {
+				return _occupied.find_next_empty(begin, _slot_count);
+			}
+
+			/**
+			 * Drops the empty slots behind the last element and releases the unused capacity. Unless the
+			 * capacity already fits, the elements are moved into a new allocation.
+			 */
+			void shrink_to_fit() {
+				while (_slot_count != 0 && !_occupied.test(_slot_count - 1)) {
+					unlink_free_slot(_slot_count - 1);
+					_slot_count--;
+				}
+				if (_slot_count == 0) {
+					destroy_all();
+				} else if (_capacity != _slot_count) {
+					reallocate(_slot_count);
+				}
+			}
+
+			/**
+			 * Replaces the content of this vector by slots, that live in memory owned by someone else,
+			 * e.g. a mapped snapshot file. The slots are used in place and never freed by this vector. The
+			 * first add, that needs more slots, moves them into an own allocation. The memory has to stay
+			 * valid and writable as long as this vector uses it.
+			 *
+			 * @param slots The slots, whose values and free list links are valid
+			 * @param slot_count The number of slots
+			 * @param size The number of occupied slots
+			 * @param free_head The first empty slot of the free list
+			 * @param occupancy_words The occupancy bitmap of the slots (see occupancy_bitmap::words())
+			 * @param number_of_words The number of occupancy words
+			 */
+			void adopt(
+				index_vector_slot<T>* slots,
+				const ID_TYPE slot_count,
+				const size_t size,
+				const ID_TYPE free_head,
+				const std::uint64_t* occupancy_words,
+				const std::size_t number_of_words
+			) {
+				destroy_all();
+				_slots = slot_count != 0 ? slots : nullptr;
+				_capacity = slot_count;
+				_slot_count = slot_count;
+				_size = size;
+				_free_head = free_head;
+				_borrowed = true;
+				_occupied.assign(occupancy_words, number_of_words);
+				_occupied.resize(slot_count);
+			}
+
+			/**
+			 * @returns the slots [0, slot_count()). Empty slots hold the link of the free list.
+			 */
+			const index_vector_slot<T>* slots() const {
+				return _slots;
+			}
+
+			/**
+			 * @returns the first empty slot of the free list
+			 */
+			ID_TYPE free_head() const {
+				return _free_head;
+			}
+
+			const occupancy_bitmap& occupied() const {
+				return _occupied;
+			}
+
+			/**
+			 * Allocates enough slots, so that this vector can hold number_of_elements elements without
+			 * reallocating.
+			 */
+			void reserve(const size_t number_of_elements) {
+				if (number_of_elements > _capacity) {
+					reallocate(number_of_elements);
+				}
 			}
 
 			/**
@@ -173,7 +539,7 @@ namespace encom {
 			 * @returns true, if there is an element at the specified index, otherwise false
 			 */
 			bool has_index(const encom::ID_TYPE index) const {
-				return (index < _instances.size()) && (_holes.find(index) == _holes.end());
+				return (index < _slot_count) && _occupied.test(index);
 			}
 
 			/**
@@ -185,13 +551,13 @@ namespace encom {
 			 * @returns true, if there was an element at the specified index, otherwise false
 			 */
 			bool remove(encom::ID_TYPE index) {
-				if (index < _instances.size()) {
-					// if index is not in holes
-					if (_holes.find(index) == _holes.end()) {
-						_holes.insert(index);
-						--_size;
-						return true;
-					}
+				if (has_index(index)) {
+					_slots[index].value.~T();
+					zero_slots(&_slots[index], 1);
+					push_free_slot(index);
+					_occupied.reset(index);
+					--_size;
+					return true;
 				}
 				return false;
 			}
@@ -205,7 +571,7 @@ namespace encom {
 			 */
 			const T& get(const encom::ID_TYPE index) const {
 				if (has_index(index)) {
-					return _instances[index];
+					return _slots[index].value;
 				} else {
 					throw "Tried to get invalid index";
 				}
@@ -220,38 +586,85 @@ namespace encom {
 			 */
 			T& get(const encom::ID_TYPE index) {
 				if (has_index(index)) {
-					return _instances[index];
+					return _slots[index].value;
 				} else {
 					throw "Tried to get invalid index";
 				}
 			}
 
+			/**
+			 * Returns the element at the specified position without checking, whether the index is valid.
+			 */
+			const T& get_unchecked(const encom::ID_TYPE index) const {
+				return _slots[index].value;
+			}
+
+			T& get_unchecked(const encom::ID_TYPE index) {
+				return _slots[index].value;
+			}
+
+			/**
+			 * Hints the cpu to load the slot at the given index into the cache.
+			 */
+			void prefetch(const encom::ID_TYPE index) const {
+				__builtin_prefetch(&_slots[index]);
+			}
+
+			/**
+			 * @returns the number of positions, that for_each_in() accepts. For an index_vector the
+			 * 			positions are the slot indices.
+			 */
+			encom::ID_TYPE position_count() const {
+				return _slot_count;
+			}
+
+			/**
+			 * Executes func for every element in the slots [begin, end), until func returns false.
+			 *
+			 * @returns false, if func stopped the iteration
+			 */
+			template<typename Func>
+			bool for_each_in(encom::ID_TYPE begin, encom::ID_TYPE end, Func&& func) {
+				end = end < _slot_count ? end : _slot_count;
+				return _occupied.for_each_set(begin, end, [this, &func](encom::ID_TYPE index) {
+					return encom::continue_iteration(func, _slots[index].value);
+				});
+			}
+
+			template<typename Func>
+			bool for_each_in(encom::ID_TYPE begin, encom::ID_TYPE end, Func&& func) const {
+				end = end < _slot_count ? end : _slot_count;
+				return _occupied.for_each_set(begin, end, [this, &func](encom::ID_TYPE index) {
+					return encom::continue_iteration(func, static_cast<const T&>(_slots[index].value));
+				});
+			}
+
 			/**
 			 * @returns an read/write iterator pointing to the start of this index_vector.
 			 */
 			iterator begin() {
-				return index_vector_iterator<T>(0, _instances.size(), &_instances, &_holes);
+				return index_vector_iterator<T>(0, _slot_count, _slots, &_occupied);
 			}
 
 			/**
 			 * @returns an read/write iterator pointing to the end of this index_vector.
 			 */
 			iterator end() {
-				return index_vector_iterator<T>(_instances.size(), _instances.size(), &_instances, &_holes);
+				return index_vector_iterator<T>(_slot_count, _slot_count, _slots, &_occupied);
 			}
 
 			/**
 			 * @returns an read-only iterator pointing to the start of this index_vector.
 			 */
 			const_iterator begin() const {
-				return const_index_vector_iterator<T>(0, _instances.size(), &_instances, &_holes);
+				return const_index_vector_iterator<T>(0, _slot_count, _slots, &_occupied);
 			}
 
 			/**
 			 * @returns an read-only iterator pointing to the end of this index_vector.
 			 */
 			const_iterator end() const {
-				return const_index_vector_iterator<T>(_instances.size(), _instances.size(), &_instances, &_holes);
+				return const_index_vector_iterator<T>(_slot_count, _slot_count, _slots, &_occupied);
 			}
 
 			/**
@@ -261,6 +674,27 @@ namespace encom {
 			size_t size() const {
 				return _size;
 			}
+
+			/**
+			 * @returns the number of slots (occupied or empty) in this vector. Every valid index is smaller than this.
+			 */
+			encom::ID_TYPE slot_count() const {
+				return _slot_count;
+			}
+
+			/**
+			 * @returns the number of slots, that are allocated
+			 */
+			encom::ID_TYPE capacity() const {
+				return _capacity;
+			}
+
+			/**
+			 * @returns the bytes allocated for the slots and the occupancy bitmap
+			 */
+			size_t allocated_bytes() const {
+				return _capacity * sizeof(slot) + _occupied.number_of_words() * sizeof(std::uint64_t);
+			}
 	};
 }
 
@@ -0,0 +1,25 @@
+#ifndef __ITERATION_CLASS__
+#define __ITERATION_CLASS__
+
+#include <type_traits>
+#include <utility>
+
+namespace encom {
+	/**
+	 * Calls func with args for one element of an iteration. func may return void or a value convertible
+	 * to bool, then false stops the iteration.
+	 *
+	 * @returns whether the iteration continues
+	 */
+	template<typename Func, typename ...Args>
+	inline bool continue_iteration(Func& func, Args&&... args) {
+		if constexpr (std::is_void_v<std::invoke_result_t<Func&, Args...>>) {
+			func(std::forward<Args>(args)...);
+			return true;
+		} else {
+			return static_cast<bool>(func(std::forward<Args>(args)...));
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef __OCCUPANCY_BITMAP_CLASS__
+#define __OCCUPANCY_BITMAP_CLASS__
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "types.hpp"
+#include "iteration.hpp"
+
+namespace encom {
+	/**
+	 * A growable set of bits, that is used to mark which slots of a container are occupied.
+	 * Searching for the next occupied slot skips empty 64-bit words at once and uses
+	 * count-trailing-zeros inside a word.
+	 */
+	class occupancy_bitmap {
+		private:
+			std::vector<std::uint64_t> _words;
+
+			static constexpr ID_TYPE WORD_BITS = 64;
+
+		public:
+			/**
+			 * Makes sure that the bits [0, number_of_bits) can be accessed. New bits are unset.
+			 */
+			void resize(const ID_TYPE number_of_bits) {
+				_words.resize((number_of_bits + WORD_BITS - 1) / WORD_BITS, 0);
+			}
+
+			void set(const ID_TYPE index) {
+				_words[index / WORD_BITS] |= std::uint64_t(1) << (index % WORD_BITS);
+			}
+
+			void reset(const ID_TYPE index) {
+				_words[index / WORD_BITS] &= ~(std::uint64_t(1) << (index % WORD_BITS));
+			}
+
+			bool test(const ID_TYPE index) const {
+				return (_words[index / WORD_BITS] >> (index % WORD_BITS)) & 1;
+			}
+
+			/**
+			 * Unsets all bits, without changing the number of bits.
+			 */
+			void clear() {
+				std::fill(_words.begin(), _words.end(), 0);
+			}
+
+			/**
+			 * @param index The first index to inspect
+			 * @param end The index after the last index to inspect
+			 * @returns the first set bit in [index, end) or end, if there is no such bit
+			 */
+			ID_TYPE find_next(ID_TYPE index, const ID_TYPE end) const {
+				if (index >= end) {
+					return end;
+				}
+				ID_TYPE word_index = index / WORD_BITS;
+				std::uint64_t word = _words[word_index] & (~std::uint64_t(0) << (index % WORD_BITS));
+				const ID_TYPE last_word = (end - 1) / WORD_BITS;
+				while (word == 0) {
+					if (++word_index > last_word) {
+						return end;
+					}
+					word = _words[word_index];
+				}
+				const ID_TYPE found = word_index * WORD_BITS + __builtin_ctzll(word);
+				return found < end ? found : end;
+			}
+
+			/**
+			 * @param index The first index to inspect
+			 * @param end The index after the last index to inspect
+			 * @returns the first unset bit in [index, end) or end, if there is no such bit
+			 */
+			ID_TYPE find_next_empty(ID_TYPE index, const ID_TYPE end) const {
+				if (index >= end) {
+					return end;
+				}
+				ID_TYPE word_index = index / WORD_BITS;
+				std::uint64_t word = ~_words[word_index] & (~std::uint64_t(0) << (index % WORD_BITS));
+				const ID_TYPE last_word = (end - 1) / WORD_BITS;
+				while (word == 0) {
+					if (++word_index > last_word) {
+						return end;
+					}
+					word = ~_words[word_index];
+				}
+				const ID_TYPE found = word_index * WORD_BITS + __builtin_ctzll(word);
+				return found < end ? found : end;
+			}
+
+			/**
+			 * Calls func(index) for every set bit in [begin, end) in ascending order, until func returns false.
+			 * Every word is loaded once and full words are walked without inspecting single bits, so
+			 * densely occupied containers are iterated like a plain array.
+			 *
+			 * @returns false, if func stopped the iteration
+			 */
+			template<typename Func>
+			bool for_each_set(const ID_TYPE begin, const ID_TYPE end, Func&& func) const {
+				if (begin >= end) {
+					return true;
+				}
+				const ID_TYPE last_word = (end - 1) / WORD_BITS;
+				for (ID_TYPE word_index = begin / WORD_BITS; word_index <= last_word; word_index++) {
+					std::uint64_t word = _words[word_index];
+					if (word_index == begin / WORD_BITS) {
+						word &= ~std::uint64_t(0) << (begin % WORD_BITS);
+					}
+					if (word_index == last_word && end % WORD_BITS != 0) {
+						word &= ~(~std::uint64_t(0) << (end % WORD_BITS));
+					}
+					const ID_TYPE base = word_index * WORD_BITS;
+					if (word == ~std::uint64_t(0)) {
+						for (ID_TYPE index = base; index < base + WORD_BITS; index++) {
+							if (!continue_iteration(func, index)) {
+								return false;
+							}
+						}
+						continue;
+					}
+					while (word != 0) {
+						if (!continue_iteration(func, base + ID_TYPE(__builtin_ctzll(word)))) {
+							return false;
+						}
+						word &= word - 1;
+					}
+				}
+				return true;
+			}
+
+			/**
+			 * Replaces the bits by the given words. Bit i is bit (i % 64) of word i / 64.
+			 */
+			void assign(const std::uint64_t* words, const std::size_t number_of_words) {
+				_words.assign(words, words + number_of_words);
+			}
+
+			const std::uint64_t* words() const {
+				return _words.data();
+			}
+
+			std::size_t number_of_words() const {
+				return _words.size();
+			}
+	};
+}
+
+#endif
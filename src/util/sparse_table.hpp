@@ -0,0 +1,118 @@
+#ifndef __SPARSE_TABLE_CLASS__
+#define __SPARSE_TABLE_CLASS__
+
+#include <cstddef>
+#include <vector>
+#include "types.hpp"
+
+namespace encom {
+	/**
+	 * Maps stable indices to positions in a packed array. Used by the containers, that keep their
+	 * elements packed and move them on removal.
+	 *
+	 * Unused entries form an intrusive free list, so released indices are reused first.
+	 */
+	class sparse_table {
+		private:
+			// entries with this bit set are free. The other bits hold the next free entry.
+			static constexpr ID_TYPE FREE_BIT = ID_TYPE(1) << 63;
+			static constexpr ID_TYPE NO_SLOT = ~ID_TYPE(0);
+
+			std::vector<ID_TYPE> _positions;
+			ID_TYPE _free_head;
+
+		public:
+			sparse_table() : _free_head(NO_SLOT) {}
+
+			/**
+			 * Returns an unused index and maps it to the given position.
+			 */
+			ID_TYPE acquire(const ID_TYPE position) {
+				ID_TYPE index = 0;
+				if (_free_head != NO_SLOT) {
+					index = _free_head;
+					const ID_TYPE next = _positions[index] & ~FREE_BIT;
+					_free_head = next == (NO_SLOT & ~FREE_BIT) ? NO_SLOT : next;
+					_positions[index] = position;
+				} else {
+					index = _positions.size();
+					_positions.push_back(position);
+				}
+				return index;
+			}
+
+			/**
+			 * Maps the given unused index to the given position. If the index is at least size(), the
+			 * skipped indices become unused. Otherwise the index is unlinked from the free list, which is
+			 * fast for recently released indices and linear in the number of unused indices otherwise.
+			 */
+			void acquire_at(const ID_TYPE index, const ID_TYPE position) {
+				if (index < _positions.size()) {
+					const ID_TYPE next = _positions[index] & ~FREE_BIT;
+					if (_free_head == index) {
+						_free_head = next == (NO_SLOT & ~FREE_BIT) ? NO_SLOT : next;
+					} else {
+						for (ID_TYPE current = _free_head; current != NO_SLOT; ) {
+							const ID_TYPE current_next = _positions[current] & ~FREE_BIT;
+							if (current_next == index) {
+								_positions[current] = FREE_BIT | next;
+								break;
+							}
+							current = current_next == (NO_SLOT & ~FREE_BIT) ? NO_SLOT : current_next;
+						}
+					}
+					_positions[index] = position;
+					return;
+				}
+				while (_positions.size() < index) {
+					_positions.push_back(FREE_BIT | _free_head);
+					_free_head = _positions.size() - 1;
+				}
+				_positions.push_back(position);
+			}
+
+			/**
+			 * Marks the given index as unused.
+			 */
+			void release(const ID_TYPE index) {
+				_positions[index] = FREE_BIT | _free_head;
+				_free_head = index;
+			}
+
+			void reserve(const ID_TYPE number_of_entries) {
+				_positions.reserve(number_of_entries);
+			}
+
+			void shrink_to_fit() {
+				_positions.shrink_to_fit();
+			}
+
+			bool contains(const ID_TYPE index) const {
+				return (index < _positions.size()) && !(_positions[index] & FREE_BIT);
+			}
+
+			ID_TYPE position(const ID_TYPE index) const {
+				return _positions[index];
+			}
+
+			void set_position(const ID_TYPE index, const ID_TYPE position) {
+				_positions[index] = position;
+			}
+
+			/**
+			 * @returns the bytes allocated for the entries
+			 */
+			std::size_t allocated_bytes() const {
+				return _positions.capacity() * sizeof(ID_TYPE);
+			}
+
+			/**
+			 * @returns the number of entries. Every used index is smaller than this.
+			 */
+			ID_TYPE size() const {
+				return _positions.size();
+			}
+	};
+}
+
+#endif
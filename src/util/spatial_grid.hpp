@@ -0,0 +1,432 @@
+#ifndef __SPATIAL_GRID_CLASS__
+#define __SPATIAL_GRID_CLASS__
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "types.hpp"
+#include "hash_index.hpp"
+
+namespace encom {
+	/**
+	 * A uniform grid of cubic cells over an unbounded space with the given number of dimensions. Only
+	 * occupied cells are stored, they are found through a hash_index by their coordinates. Every cell
+	 * holds the array indices and positions of its elements, so queries read the cells sequentially
+	 * without touching the components. Every slot knows its cell and its position in the cell, so
+	 * moving and erasing an element costs O(1). Cells, that become empty, are released in batches and
+	 * reused for new cells, so moving elements do not grow the grid.
+	 */
+	template<std::size_t Dimensions>
+	class spatial_grid {
+		static_assert(Dimensions >= 1 && Dimensions <= 4, "A spatial grid has 1 to 4 dimensions");
+
+		public:
+			using point = std::array<float, Dimensions>;
+
+		private:
+			using cell_coordinates = std::array<std::int32_t, Dimensions>;
+
+			static constexpr std::uint32_t NO_CELL = ~std::uint32_t(0);
+			static constexpr std::size_t KEY_BITS = std::min<std::size_t>(64 / Dimensions, 32);
+			// cell coordinates are clamped to this range, so every cell has its own key. Elements beyond
+			// the range share the outermost cells.
+			static constexpr float MAX_CELL_COORDINATE = float(std::int64_t(1) << (KEY_BITS - 2));
+
+			struct entry {
+				ID_TYPE array_index;
+				point position;
+			};
+
+			struct slot {
+				std::uint32_t cell;
+				std::uint32_t position_in_cell;
+			};
+
+			float _cell_size;
+			float _inverse_cell_size;
+			hash_index<std::uint64_t, std::uint32_t> _cell_ids;
+			std::vector<std::vector<entry>> _cells;
+			std::vector<cell_coordinates> _cell_coordinates;
+			// the ids of the released cells, that are not in _cell_ids anymore
+			std::vector<std::uint32_t> _free_cells;
+			// the number of empty cells, that are still in _cell_ids, see release_empty_cells()
+			std::size_t _empty_cells;
+			std::vector<slot> _slots;
+			// a box around all occupied cells. It may be larger than needed, until the empty cells are released.
+			cell_coordinates _min_cell;
+			cell_coordinates _max_cell;
+			std::size_t _size;
+
+			cell_coordinates cell_of(const point& position) const {
+				cell_coordinates cell;
+				for (std::size_t d = 0; d < Dimensions; d++) {
+					float coordinate = std::floor(position[d] * _inverse_cell_size);
+					// also catches NaN
+					if (!(coordinate >= -MAX_CELL_COORDINATE)) {
+						coordinate = -MAX_CELL_COORDINATE;
+					}
+					cell[d] = std::int32_t(std::min(coordinate, MAX_CELL_COORDINATE));
+				}
+				return cell;
+			}
+
+			/**
+			 * Packs the coordinates of a cell into a key.
+			 */
+			static std::uint64_t cell_key(const cell_coordinates& cell) {
+				constexpr std::uint64_t mask = (std::uint64_t(1) << KEY_BITS) - 1;
+				std::uint64_t key = 0;
+				for (std::size_t d = 0; d < Dimensions; d++) {
+					key = (key << KEY_BITS) | (std::uint64_t(std::uint32_t(cell[d])) & mask);
+				}
+				return key;
+			}
+
+			const std::vector<entry>* find_cell(const cell_coordinates& cell) const {
+				const std::uint64_t key = cell_key(cell);
+				const std::uint32_t* id = _cell_ids.find(hash_index<std::uint64_t, std::uint32_t>::hash_key(key), key);
+				return id == nullptr ? nullptr : &_cells[*id];
+			}
+
+			/**
+			 * @returns the id of the cell, that an element is about to be added to
+			 */
+			std::uint32_t find_or_add_cell(const cell_coordinates& cell) {
+				const std::uint64_t key = cell_key(cell);
+				const std::uint64_t hash = hash_index<std::uint64_t, std::uint32_t>::hash_key(key);
+				if (const std::uint32_t* id = _cell_ids.find(hash, key)) {
+					if (_cells[*id].empty()) {
+						_empty_cells--;
+					}
+					return *id;
+				}
+				std::uint32_t id;
+				if (_free_cells.empty()) {
+					id = std::uint32_t(_cells.size());
+					_cells.emplace_back();
+					_cell_coordinates.push_back(cell);
+				} else {
+					id = _free_cells.back();
+					_free_cells.pop_back();
+					_cell_coordinates[id] = cell;
+				}
+				_cell_ids.insert(hash, key, id);
+				return id;
+			}
+
+			/**
+			 * Releases all empty cells for reuse and shrinks the box around the occupied cells. Empty
+			 * cells stay registered until they outnumber the occupied cells, so an element moving back
+			 * and forth does not release and add a cell every time, and the O(cells) sweep is amortized
+			 * over as many erases.
+			 */
+			void release_empty_cells() {
+				_cell_ids.clear();
+				_free_cells.clear();
+				_min_cell.fill(std::numeric_limits<std::int32_t>::max());
+				_max_cell.fill(std::numeric_limits<std::int32_t>::min());
+				for (std::size_t id = 0; id < _cells.size(); id++) {
+					if (_cells[id].empty()) {
+						_free_cells.push_back(std::uint32_t(id));
+						continue;
+					}
+					const std::uint64_t key = cell_key(_cell_coordinates[id]);
+					_cell_ids.insert(hash_index<std::uint64_t, std::uint32_t>::hash_key(key), key, std::uint32_t(id));
+					for (std::size_t d = 0; d < Dimensions; d++) {
+						_min_cell[d] = std::min(_min_cell[d], _cell_coordinates[id][d]);
+						_max_cell[d] = std::max(_max_cell[d], _cell_coordinates[id][d]);
+					}
+				}
+				_empty_cells = 0;
+			}
+
+			/**
+			 * @returns whether the box from first to last contains more cells than a scan of all cells visits
+			 */
+			bool larger_than_scan(const cell_coordinates& first, const cell_coordinates& last) const {
+				const std::uint64_t limit = _cells.size();
+				std::uint64_t volume = 1;
+				for (std::size_t d = 0; d < Dimensions; d++) {
+					volume *= std::uint64_t(std::int64_t(last[d]) - first[d] + 1);
+					if (volume > limit) {
+						return true;
+					}
+				}
+				return false;
+			}
+
+			/**
+			 * Calls func(cell, entries) for every occupied cell in the box from first to last, both inclusive.
+			 * Boxes with more cells than the grid has are searched by scanning all cells.
+			 */
+			template<typename Func>
+			void for_each_cell(cell_coordinates first, cell_coordinates last, Func&& func) const {
+				if (_size == 0) {
+					return;
+				}
+				for (std::size_t d = 0; d < Dimensions; d++) {
+					first[d] = std::max(first[d], _min_cell[d]);
+					last[d] = std::min(last[d], _max_cell[d]);
+					if (first[d] > last[d]) {
+						return;
+					}
+				}
+				if (larger_than_scan(first, last)) {
+					for (std::size_t id = 0; id < _cells.size(); id++) {
+						const cell_coordinates& cell = _cell_coordinates[id];
+						bool inside = !_cells[id].empty();
+						for (std::size_t d = 0; d < Dimensions; d++) {
+							inside = inside && cell[d] >= first[d] && cell[d] <= last[d];
+						}
+						if (inside) {
+							func(cell, _cells[id]);
+						}
+					}
+					return;
+				}
+				cell_coordinates cell = first;
+				while (true) {
+					if (const std::vector<entry>* entries = find_cell(cell)) {
+						func(cell, *entries);
+					}
+					std::size_t d = 0;
+					while (d < Dimensions && cell[d] == last[d]) {
+						cell[d] = first[d];
+						d++;
+					}
+					if (d == Dimensions) {
+						return;
+					}
+					cell[d]++;
+				}
+			}
+
+			/**
+			 * Calls func(cell, entries) for every occupied cell inside the box from first to last, whose
+			 * largest distance to center in any dimension is exactly ring. Every face of the ring is a
+			 * box, the dimensions before the face exclude the ring, so every cell is visited once.
+			 */
+			template<typename Func>
+			void for_each_ring_cell(const cell_coordinates& center, const std::int64_t ring, const cell_coordinates& first, const cell_coordinates& last, Func&& func) const {
+				if (ring == 0) {
+					for_each_cell(center, center, func);
+					return;
+				}
+				for (std::size_t face = 0; face < Dimensions; face++) {
+					for (const std::int64_t side : {-ring, ring}) {
+						const std::int64_t coordinate = center[face] + side;
+						if (coordinate < first[face] || coordinate > last[face]) {
+							continue;
+						}
+						cell_coordinates face_first = first;
+						cell_coordinates face_last = last;
+						face_first[face] = std::int32_t(coordinate);
+						face_last[face] = std::int32_t(coordinate);
+						for (std::size_t d = 0; d < face; d++) {
+							face_first[d] = std::int32_t(std::max<std::int64_t>(first[d], center[d] - ring + 1));
+							face_last[d] = std::int32_t(std::min<std::int64_t>(last[d], center[d] + ring - 1));
+						}
+						for_each_cell(face_first, face_last, func);
+					}
+				}
+			}
+
+			static float squared_distance(const point& a, const point& b) {
+				float distance = 0.f;
+				for (std::size_t d = 0; d < Dimensions; d++) {
+					distance += (a[d] - b[d]) * (a[d] - b[d]);
+				}
+				return distance;
+			}
+
+		public:
+			explicit spatial_grid(const float cell_size)
+				: _cell_size(cell_size), _inverse_cell_size(1.f / cell_size), _empty_cells(0), _size(0)
+			{
+				clear();
+			}
+
+			void insert(const ID_TYPE array_index, const point& position) {
+				const cell_coordinates cell = cell_of(position);
+				const std::uint32_t id = find_or_add_cell(cell);
+				if (_slots.size() <= array_index) {
+					_slots.resize(array_index + 1, slot {NO_CELL, 0});
+				}
+				_slots[array_index] = slot {id, std::uint32_t(_cells[id].size())};
+				_cells[id].push_back(entry {array_index, position});
+				for (std::size_t d = 0; d < Dimensions; d++) {
+					_min_cell[d] = std::min(_min_cell[d], cell[d]);
+					_max_cell[d] = std::max(_max_cell[d], cell[d]);
+				}
+				_size++;
+			}
+
+			void erase(const ID_TYPE array_index) {
+				slot& s = _slots[array_index];
+				std::vector<entry>& entries = _cells[s.cell];
+				if (s.position_in_cell + 1 != entries.size()) {
+					entries[s.position_in_cell] = entries.back();
+					_slots[entries[s.position_in_cell].array_index].position_in_cell = s.position_in_cell;
+				}
+				entries.pop_back();
+				s.cell = NO_CELL;
+				_size--;
+				if (entries.empty()) {
+					_empty_cells++;
+					if (_empty_cells > _cell_ids.size() - _empty_cells) {
+						release_empty_cells();
+					}
+				}
+			}
+
+			/**
+			 * Updates the position of the element at array_index. Moves within a cell only overwrite the
+			 * stored position.
+			 */
+			void move(const ID_TYPE array_index, const point& position) {
+				const slot& s = _slots[array_index];
+				if (cell_key(_cell_coordinates[s.cell]) == cell_key(cell_of(position))) {
+					_cells[s.cell][s.position_in_cell].position = position;
+				} else {
+					erase(array_index);
+					insert(array_index, position);
+				}
+			}
+
+			/**
+			 * Calls func(array_index) for every element inside the box from min to max, both inclusive.
+			 */
+			template<typename Func>
+			void for_each_in_box(const point& min, const point& max, Func&& func) const {
+				for_each_cell(cell_of(min), cell_of(max), [&min, &max, &func](const cell_coordinates&, const std::vector<entry>& entries) {
+					for (const entry& e : entries) {
+						bool inside = true;
+						for (std::size_t d = 0; d < Dimensions; d++) {
+							inside = inside && e.position[d] >= min[d] && e.position[d] <= max[d];
+						}
+						if (inside) {
+							func(e.array_index);
+						}
+					}
+				});
+			}
+
+			/**
+			 * Calls func(array_index) for every element, whose distance to center is at most radius.
+			 */
+			template<typename Func>
+			void for_each_in_radius(const point& center, const float radius, Func&& func) const {
+				point min;
+				point max;
+				for (std::size_t d = 0; d < Dimensions; d++) {
+					min[d] = center[d] - radius;
+					max[d] = center[d] + radius;
+				}
+				const float squared_radius = radius * radius;
+				for_each_cell(cell_of(min), cell_of(max), [&center, squared_radius, &func](const cell_coordinates&, const std::vector<entry>& entries) {
+					for (const entry& e : entries) {
+						if (squared_distance(e.position, center) <= squared_radius) {
+							func(e.array_index);
+						}
+					}
+				});
+			}
+
+			/**
+			 * Finds the k elements closest to center. The cells are searched in growing rings around the
+			 * cell of center, until the elements found are closer than every cell not searched yet. Once a
+			 * ring spans more cells than the grid has, the cells not searched yet are scanned instead, so
+			 * distant elements cost O(cells) and not O(distance^Dimensions).
+			 *
+			 * @returns the squared distances and array indices of at most k elements, ordered by distance
+			 */
+			std::vector<std::pair<float, ID_TYPE>> nearest(const point& center, const std::size_t k) const {
+				std::vector<std::pair<float, ID_TYPE>> best;
+				if (k == 0 || _size == 0) {
+					return best;
+				}
+				best.reserve(k + 1);
+				const cell_coordinates center_cell = cell_of(center);
+				const auto search_cell = [&best, &center, k](const cell_coordinates&, const std::vector<entry>& entries) {
+					for (const entry& e : entries) {
+						const float distance = squared_distance(e.position, center);
+						if (best.size() < k) {
+							best.emplace_back(distance, e.array_index);
+							std::push_heap(best.begin(), best.end());
+						} else if (distance < best.front().first) {
+							std::pop_heap(best.begin(), best.end());
+							best.back() = std::make_pair(distance, e.array_index);
+							std::push_heap(best.begin(), best.end());
+						}
+					}
+				};
+				for (std::int64_t ring = 0; ; ring++) {
+					cell_coordinates first;
+					cell_coordinates last;
+					bool covers_all = true;
+					bool reaches_cells = true;
+					for (std::size_t d = 0; d < Dimensions; d++) {
+						first[d] = std::int32_t(std::max<std::int64_t>(center_cell[d] - ring, _min_cell[d]));
+						last[d] = std::int32_t(std::min<std::int64_t>(center_cell[d] + ring, _max_cell[d]));
+						covers_all = covers_all && center_cell[d] - ring <= _min_cell[d] && center_cell[d] + ring >= _max_cell[d];
+						reaches_cells = reaches_cells && first[d] <= last[d];
+					}
+					if (reaches_cells && larger_than_scan(first, last)) {
+						// the inner cells were searched by the previous rings
+						for (std::size_t id = 0; id < _cells.size(); id++) {
+							std::int64_t distance = 0;
+							for (std::size_t d = 0; d < Dimensions; d++) {
+								distance = std::max<std::int64_t>(distance, std::abs(std::int64_t(_cell_coordinates[id][d]) - center_cell[d]));
+							}
+							if (distance >= ring) {
+								search_cell(_cell_coordinates[id], _cells[id]);
+							}
+						}
+						break;
+					}
+					for_each_ring_cell(center_cell, ring, first, last, search_cell);
+					// every element outside of the searched rings is at least ring cells away
+					const float searched = float(ring) * _cell_size;
+					if (covers_all || (best.size() == k && best.front().first <= searched * searched)) {
+						break;
+					}
+				}
+				std::sort_heap(best.begin(), best.end());
+				return best;
+			}
+
+			void clear() {
+				_cell_ids.clear();
+				_cells.clear();
+				_cell_coordinates.clear();
+				_free_cells.clear();
+				_empty_cells = 0;
+				_slots.clear();
+				_min_cell.fill(std::numeric_limits<std::int32_t>::max());
+				_max_cell.fill(std::numeric_limits<std::int32_t>::min());
+				_size = 0;
+			}
+
+			std::size_t size() const {
+				return _size;
+			}
+
+			/**
+			 * @returns the number of cells, including the empty cells kept for reuse
+			 */
+			std::size_t number_of_cells() const {
+				return _cells.size();
+			}
+
+			float cell_size() const {
+				return _cell_size;
+			}
+	};
+}
+
+#endif
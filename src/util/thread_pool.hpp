@@ -0,0 +1,185 @@
+#ifndef __THREAD_POOL_CLASS__
+#define __THREAD_POOL_CLASS__
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace encom {
+	/**
+	 * A persistent set of worker threads. The thread calling parallel_for() participates as worker 0,
+	 * so a pool of size n starts n-1 threads.
+	 *
+	 * parallel_for() splits the chunks evenly into one contiguous range per worker. A worker, that has
+	 * finished its own range, steals the remaining chunks of the other workers. Calls from inside a
+	 * running job are executed sequentially on the calling thread.
+	 */
+	class thread_pool {
+		private:
+			struct alignas(64) chunk_range {
+				std::atomic<std::size_t> next;
+				std::size_t end;
+			};
+
+			std::vector<std::thread> _threads;
+			std::mutex _mutex;
+			std::mutex _run_mutex;
+			std::condition_variable _start_condition;
+			std::condition_variable _finish_condition;
+			const std::function<void(std::size_t)>* _job;
+			std::size_t _generation;
+			std::size_t _running;
+			bool _stop;
+
+			inline static thread_local bool _inside_job = false;
+
+			void worker_loop(const std::size_t worker_index) {
+				std::size_t seen_generation = 0;
+				while (true) {
+					const std::function<void(std::size_t)>* job = nullptr;
+					{
+						std::unique_lock<std::mutex> lock(_mutex);
+						_start_condition.wait(lock, [&]() { return _stop || _generation != seen_generation; });
+						if (_stop) {
+							return;
+						}
+						seen_generation = _generation;
+						job = _job;
+					}
+
+					_inside_job = true;
+					(*job)(worker_index);
+					_inside_job = false;
+
+					std::lock_guard<std::mutex> lock(_mutex);
+					if (--_running == 0) {
+						_finish_condition.notify_one();
+					}
+				}
+			}
+
+			static bool take_chunk(chunk_range& range, std::size_t* chunk) {
+				if (range.next.load(std::memory_order_relaxed) >= range.end) {
+					return false;
+				}
+				*chunk = range.next.fetch_add(1, std::memory_order_relaxed);
+				return *chunk < range.end;
+			}
+
+		public:
+			/**
+			 * Creates a pool with the given number of workers, including the calling thread.
+			 *
+			 * @param number_of_workers The number of workers. 0 uses one worker per hardware thread.
+			 */
+			explicit thread_pool(std::size_t number_of_workers = 0)
+				: _job(nullptr), _generation(0), _running(0), _stop(false)
+			{
+				if (number_of_workers == 0) {
+					number_of_workers = std::max(1u, std::thread::hardware_concurrency());
+				}
+				for (std::size_t worker_index = 1; worker_index < number_of_workers; worker_index++) {
+					_threads.emplace_back(&thread_pool::worker_loop, this, worker_index);
+				}
+			}
+
+			thread_pool(const thread_pool&) = delete;
+			thread_pool& operator=(const thread_pool&) = delete;
+
+			~thread_pool() {
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					_stop = true;
+				}
+				_start_condition.notify_all();
+				for (std::thread& thread : _threads) {
+					thread.join();
+				}
+			}
+
+			/**
+			 * @returns the number of workers including the calling thread
+			 */
+			std::size_t size() const {
+				return _threads.size() + 1;
+			}
+
+			/**
+			 * @returns whether the current thread is executing a job of a thread pool
+			 */
+			static bool inside_job() {
+				return _inside_job;
+			}
+
+			/**
+			 * Executes job(worker_index) once on every worker and returns, when all workers are done.
+			 */
+			void run(const std::function<void(std::size_t)>& job) {
+				if (_inside_job || _threads.empty()) {
+					job(0);
+					return;
+				}
+
+				std::lock_guard<std::mutex> run_lock(_run_mutex);
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					_job = &job;
+					_running = _threads.size();
+					_generation++;
+				}
+				_start_condition.notify_all();
+
+				_inside_job = true;
+				job(0);
+				_inside_job = false;
+
+				std::unique_lock<std::mutex> lock(_mutex);
+				_finish_condition.wait(lock, [this]() { return _running == 0; });
+				_job = nullptr;
+			}
+
+			/**
+			 * Executes func(chunk) for every chunk in [0, number_of_chunks) and returns, when all chunks are done.
+			 * Every worker first processes its own range of chunks and then steals from the other workers.
+			 */
+			template<typename Func>
+			void parallel_for(const std::size_t number_of_chunks, Func&& func) {
+				if (number_of_chunks == 0) {
+					return;
+				}
+				const std::size_t number_of_workers = _inside_job ? 1 : std::min(size(), number_of_chunks);
+				std::unique_ptr<chunk_range[]> ranges(new chunk_range[number_of_workers]);
+				for (std::size_t worker_index = 0; worker_index < number_of_workers; worker_index++) {
+					ranges[worker_index].next.store(number_of_chunks * worker_index / number_of_workers, std::memory_order_relaxed);
+					ranges[worker_index].end = number_of_chunks * (worker_index+1) / number_of_workers;
+				}
+
+				const std::function<void(std::size_t)> job = [&](const std::size_t worker_index) {
+					if (worker_index >= number_of_workers) {
+						return;
+					}
+					std::size_t chunk = 0;
+					for (std::size_t offset = 0; offset < number_of_workers; offset++) {
+						chunk_range& range = ranges[(worker_index + offset) % number_of_workers];
+						while (take_chunk(range, &chunk)) {
+							func(chunk);
+						}
+					}
+				};
+
+				if (number_of_workers == 1) {
+					job(0);
+				} else {
+					run(job);
+				}
+			}
+	};
+}
+
+#endif
@@ -2,9 +2,46 @@
 #define __TYPES_CLASS__
 
 #include <cstdint>
+#include <type_traits>
+
+// #define ENCOM_COMPACT_HANDLES
+
+// compiles out the operation counters of encomsys::stats()
+// #define ENCOM_NO_STATS
+
+// records spans and latencies of the encomsys operations, see tracing.hpp
+// #define ENCOM_TRACING
+
+#ifdef ENCOM_COMPACT_HANDLES
+// the number of bits of a compact handle, that hold the slot index. The remaining bits hold the generation.
+#ifndef ENCOM_HANDLE_INDEX_BITS
+#define ENCOM_HANDLE_INDEX_BITS 24
+#endif
+#endif
 
 namespace encom {
 	using ID_TYPE = std::uint64_t;
+
+#ifdef ENCOM_COMPACT_HANDLES
+	static_assert(ENCOM_HANDLE_INDEX_BITS > 0 && ENCOM_HANDLE_INDEX_BITS < 32, "ENCOM_HANDLE_INDEX_BITS has to be in [1, 31]");
+
+	constexpr unsigned HANDLE_INDEX_BITS = ENCOM_HANDLE_INDEX_BITS;
+	constexpr unsigned HANDLE_GENERATION_BITS = 32 - HANDLE_INDEX_BITS;
+	// the largest slot index, that a compact handle can address
+	constexpr ID_TYPE MAX_HANDLE_INDEX = (ID_TYPE(1) << HANDLE_INDEX_BITS) - 1;
+	constexpr ID_TYPE GENERATION_MASK = (ID_TYPE(1) << HANDLE_GENERATION_BITS) - 1;
+
+	/**
+	 * The smallest unsigned type, that holds a generation.
+	 */
+	using GENERATION_TYPE = std::conditional_t<
+		HANDLE_GENERATION_BITS <= 8,
+		std::uint8_t,
+		std::conditional_t<HANDLE_GENERATION_BITS <= 16, std::uint16_t, std::uint32_t>
+	>;
+#else
+	using GENERATION_TYPE = ID_TYPE;
+#endif
 }
 
 #endif
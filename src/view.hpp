@@ -0,0 +1,61 @@
+#ifndef __VIEW_CLASS__
+#define __VIEW_CLASS__
+
+#include <cstddef>
+#include <utility>
+#include "relation.hpp"
+
+namespace encom {
+	/**
+	 * Iterates over all relations of type RelationType stored in an encomsys and hands them out as
+	 * RelationType::as_ref. In contrast to calling encomsys::get_ref() for every handle, the relations
+	 * are walked in storage order, child handles are not validated again and the child components of
+	 * the relation PREFETCH_DISTANCE iterations ahead are prefetched.
+	 *
+	 * A view must not be used while relations of type RelationType are added or removed.
+	 */
+	template<typename RelationType, typename Encomsys>
+	class relation_view {
+		private:
+			Encomsys* _encomsys;
+
+		public:
+			static constexpr std::size_t PREFETCH_DISTANCE = 4;
+
+			explicit relation_view(Encomsys* encomsys) : _encomsys(encomsys) {}
+
+			/**
+			 * Executes func for every relation of type <RelationType>.
+			 *
+			 * @param func The function to execute. It is called with RelationType::as_ref.
+			 */
+			template<typename Func>
+			void for_each(Func&& func) const {
+				auto& storage = _encomsys->template get_components<RelationType>();
+				const auto end = storage.end();
+
+				auto ahead = storage.begin();
+				for (std::size_t i = 0; i < PREFETCH_DISTANCE && ahead != end; i++) {
+					(*ahead).prefetch_childs(_encomsys);
+					++ahead;
+				}
+
+				for (auto iter = storage.begin(); iter != end; ++iter) {
+					if (ahead != end) {
+						(*ahead).prefetch_childs(_encomsys);
+						++ahead;
+					}
+					func((*iter).get_ref_unchecked(_encomsys));
+				}
+			}
+
+			/**
+			 * @returns the number of relations in this view
+			 */
+			std::size_t size() const {
+				return _encomsys->template get_components<RelationType>().size();
+			}
+	};
+}
+
+#endif
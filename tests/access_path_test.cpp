@@ -0,0 +1,77 @@
+#include <iostream>
+#include <string>
+
+#include "encomsys.hpp"
+
+struct player_name_t {
+	player_name_t() = default;
+	player_name_t(const std::string& name) : name(name) {}
+
+	std::string name;
+};
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x) : x(x) {}
+
+	float x;
+};
+
+struct password_component {
+	std::string passwd;
+
+	password_component() = default;
+	password_component(const std::string& pw) : passwd(pw) {}
+};
+
+struct player_relation : encom::relation<player_name_t, position_t> {
+	using encom::relation<player_name_t, position_t>::relation;
+};
+
+struct admin_player_relation : encom::relation<player_relation, password_component> {
+	using encom::relation<player_relation, password_component>::relation;
+
+	admin_player_relation() {}
+};
+
+template<>
+struct encom::component_storage<position_t> : encom::dense_storage {};
+
+using ensys = encom::encomsys<admin_player_relation, player_relation, player_name_t, position_t, password_component>;
+using admin_position_path = encom::access_path<ensys, admin_player_relation, player_relation, position_t>;
+using admin_password_path = encom::access_path<ensys, admin_player_relation, password_component>;
+
+int main() {
+	ensys ensys;
+	encom::handle admin = ensys.add(admin_player_relation(player_relation("admin", position_t(1.f)), password_component("pw")));
+
+	admin_position_path position_path(admin);
+	admin_password_path password_path(admin);
+
+	position_t* position = position_path.get(ensys);
+	std::cout << "admin x: " << position->x << std::endl;
+	std::cout << "admin password: " << password_path.get(ensys)->passwd << std::endl;
+	std::cout << "same as get_ref: " << (position == &ensys.get_ref(admin)->get<player_relation, position_t>()) << std::endl;
+
+	position->x = 2.f;
+	std::cout << "cached pointer is reused: " << (position_path.get(ensys) == position) << std::endl;
+	std::cout << "admin x after write: " << ensys.get(admin)->get<player_relation>().get<position_t>().x << std::endl;
+
+	// removing a position moves the last position into its place in the dense storage
+	encom::handle first = ensys.add(position_t(10.f));
+	ensys.add(admin_player_relation(player_relation("other", position_t(20.f)), password_component("pw")));
+	const encom::ID_TYPE epoch = ensys.epoch<position_t>();
+	ensys.remove(first);
+	std::cout << "epoch changed: " << (epoch != ensys.epoch<position_t>()) << std::endl;
+	std::cout << "admin x after storage change: " << position_path.get(ensys)->x << std::endl;
+
+	// reserving reallocates the storage
+	const encom::ID_TYPE reserve_epoch = ensys.epoch<position_t>();
+	ensys.reserve<position_t>(100000);
+	std::cout << "epoch changed by reserve: " << (reserve_epoch != ensys.epoch<position_t>()) << std::endl;
+	std::cout << "admin x after reserve: " << position_path.get(ensys)->x << std::endl;
+
+	ensys.remove(admin);
+	std::cout << "path after removing admin: " << (position_path.get(ensys) == nullptr) << std::endl;
+	std::cout << "resolve removed admin: " << (admin_position_path::resolve(ensys, admin) == nullptr) << std::endl;
+}
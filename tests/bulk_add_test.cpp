@@ -0,0 +1,78 @@
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "encomsys.hpp"
+
+struct player_name_t {
+	player_name_t() = default;
+	player_name_t(const std::string& name) : name(name) {}
+
+	std::string name;
+};
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x) : x(x) {}
+
+	float x;
+};
+
+std::istream& operator>>(std::istream& in, position_t& position) {
+	return in >> position.x;
+}
+
+struct password_component {
+	std::string passwd;
+
+	password_component() = default;
+	password_component(const std::string& pw) : passwd(pw) {}
+};
+
+struct player_relation : encom::relation<player_name_t, position_t> {
+	using encom::relation<player_name_t, position_t>::relation;
+};
+
+struct admin_player_relation : encom::relation<player_relation, password_component> {
+	using encom::relation<player_relation, password_component>::relation;
+
+	admin_player_relation() {}
+};
+
+using ensys = encom::encomsys<admin_player_relation, player_relation, player_name_t, position_t, password_component>;
+
+int main() {
+	ensys ensys;
+
+	std::vector<position_t> positions = {position_t(1.f), position_t(2.f), position_t(3.f)};
+	std::vector<encom::handle<position_t>> position_handles;
+	ensys.add_bulk<position_t>(positions.begin(), positions.end(), std::back_inserter(position_handles));
+	for (const encom::handle<position_t>& h : position_handles) {
+		std::cout << "position id=" << h.consecutive_index << " x=" << ensys.get(h)->x << std::endl;
+	}
+
+	std::vector<player_relation> players = {player_relation("a", position_t(1.f)), player_relation("b", position_t(2.f))};
+	std::vector<encom::handle<player_relation>> player_handles(players.size());
+	ensys.add_bulk<player_relation>(players.begin(), players.end(), player_handles.begin());
+	for (const encom::handle<player_relation>& h : player_handles) {
+		std::cout << "player id=" << h.consecutive_index << " name=" << ensys.get(h)->get<player_name_t>().name << std::endl;
+	}
+
+	ensys.reserve<admin_player_relation>(100);
+	std::vector<encom::handle<admin_player_relation>> admin_handles;
+	ensys.add_n(admin_player_relation(player_relation("admin", position_t(0.f)), password_component("pw")), 100, std::back_inserter(admin_handles));
+	std::cout << "number of admins:    " << ensys.get_components<admin_player_relation>().size() << std::endl;
+	std::cout << "number of players:   " << ensys.get_components<player_relation>().size() << std::endl;
+	std::cout << "number of positions: " << ensys.get_components<position_t>().size() << std::endl;
+	std::cout << "last admin name: " << ensys.get(admin_handles.back())->get<player_relation, player_name_t>().name << std::endl;
+
+	// a single pass iterator is read once
+	std::istringstream input("4 5 6");
+	std::vector<encom::handle<position_t>> read_handles;
+	ensys.add_bulk<position_t>(std::istream_iterator<position_t>(input), std::istream_iterator<position_t>(), std::back_inserter(read_handles));
+	for (const encom::handle<position_t>& h : read_handles) {
+		std::cout << "read position x=" << ensys.get(h)->x << std::endl;
+	}
+}
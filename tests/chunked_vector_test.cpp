@@ -0,0 +1,119 @@
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include <util/chunked_vector.hpp>
+#include "encomsys.hpp"
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x) : x(x) {}
+
+	float x;
+};
+
+// a large component, whose chunks are allocated with huge pages
+struct mesh_t {
+	mesh_t() = default;
+	mesh_t(const float first) { vertices[0] = first; }
+
+	float vertices[4096];
+};
+
+template<>
+struct encom::component_storage<position_t> : encom::chunked_storage<> {};
+
+template<>
+struct encom::component_storage<mesh_t> : encom::chunked_storage<encom::huge_page_allocator> {};
+
+using ensys = encom::encomsys<position_t, mesh_t>;
+
+void print_vec(const encom::chunked_vector<int, std::allocator<int>, 4>& vec) {
+	for (auto iter = vec.begin(); iter != vec.end(); ++iter) {
+		std::cout << iter.index() << ": " << *iter << std::endl;
+	}
+}
+
+void test_chunked_vector() {
+	encom::chunked_vector<int, std::allocator<int>, 4> vec;
+
+	for (int i = 0; i < 6; i++) {
+		vec.add(100 + i);
+	}
+	std::cout << "initial vec:" << std::endl;
+	print_vec(vec);
+
+	vec.remove(1);
+	vec.remove(4);
+	std::cout << "removed at index 1 and 4" << std::endl;
+	print_vec(vec);
+
+	std::cout << "added 106 at " << vec.add(106) << std::endl;
+	std::cout << "has index 1: " << vec.has_index(1) << std::endl;
+	std::cout << "index 5 holds " << vec.get(5) << std::endl;
+
+	encom::chunked_vector<int, std::allocator<int>, 4> copy(vec);
+	std::cout << "copy:" << std::endl;
+	print_vec(copy);
+}
+
+void test_pointer_stability() {
+	encom::chunked_vector<std::string, std::allocator<std::string>, 8> vec;
+	vec.add("first");
+	const std::string* first = &vec.get(0);
+	for (int i = 0; i < 1000; i++) {
+		vec.add(std::to_string(i));
+	}
+	std::cout << "first element did not move: " << (first == &vec.get(0)) << std::endl;
+	std::cout << "first element: " << *first << std::endl;
+	std::cout << "size: " << vec.size() << std::endl;
+}
+
+void test_chunked_encomsys() {
+	ensys ensys;
+
+	encom::handle pos1 = ensys.add(position_t(1.f));
+	position_t* pos1_ref = ensys.get_ref(pos1);
+	for (int i = 0; i < 10000; i++) {
+		ensys.add(position_t(2.f));
+	}
+	std::cout << "reference to pos1 is stable: " << (pos1_ref == ensys.get_ref(pos1)) << std::endl;
+
+	ensys.remove(pos1);
+	std::cout << "pos1 present: " << ensys.has_element(pos1) << std::endl;
+	encom::handle pos2 = ensys.add(position_t(3.f));
+	std::cout << "pos2 reused index of pos1: " << (pos2.array_index == pos1.array_index) << std::endl;
+	std::cout << "pos1 present after reuse: " << ensys.has_element(pos1) << std::endl;
+
+	encom::handle mesh1 = ensys.add(mesh_t(1.f));
+	mesh_t* mesh1_ref = ensys.get_ref(mesh1);
+	for (int i = 0; i < 300; i++) {
+		ensys.add(mesh_t(float(i)));
+	}
+	std::cout << "reference to mesh1 is stable: " << (mesh1_ref == ensys.get_ref(mesh1)) << std::endl;
+	std::cout << "mesh1 vertex: " << ensys.get_ref(mesh1)->vertices[0] << std::endl;
+	std::cout << "number of meshes: " << ensys.get_components<mesh_t>().size() << std::endl;
+}
+
+void test_huge_pages() {
+	using allocator_type = encom::huge_page_allocator<char>;
+	allocator_type allocator;
+	const std::size_t size = 3 * allocator_type::HUGE_PAGE_SIZE;
+	char* const memory = allocator.allocate(size);
+	memory[0] = 1;
+	memory[size - 1] = 1;
+	std::cout << "aligned to huge pages: " << (reinterpret_cast<std::uintptr_t>(memory) % allocator_type::HUGE_PAGE_SIZE == 0) << std::endl;
+	allocator.deallocate(memory, size);
+
+	// a chunk fills its huge page without spilling into the next one
+	using mesh_vector = encom::chunked_vector<mesh_t, encom::huge_page_allocator<mesh_t>>;
+	const std::size_t chunk_bytes = mesh_vector::chunk_size * sizeof(encom::index_vector_slot<mesh_t>);
+	std::cout << "mesh chunk fits into a huge page: " << (chunk_bytes <= allocator_type::HUGE_PAGE_SIZE && chunk_bytes + sizeof(encom::index_vector_slot<mesh_t>) > allocator_type::HUGE_PAGE_SIZE) << std::endl;
+}
+
+int main() {
+	test_chunked_vector();
+	test_pointer_stability();
+	test_chunked_encomsys();
+	test_huge_pages();
+}
@@ -0,0 +1,127 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "command_buffer.hpp"
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x) : x(x) {}
+
+	float x;
+};
+
+struct player_name_t {
+	player_name_t() = default;
+	player_name_t(const std::string& name) : name(name) {}
+
+	std::string name;
+};
+
+struct player_relation : encom::relation<player_name_t, position_t> {
+	using encom::relation<player_name_t, position_t>::relation;
+};
+
+template<>
+struct encom::component_storage<player_name_t> : encom::dense_storage {};
+
+using ensys = encom::encomsys<player_relation, player_name_t, position_t>;
+using ensys_command_buffer = encom::command_buffer<ensys>;
+using ensys_command_queue = encom::command_queue<ensys>;
+
+bool test_command_buffer() {
+	ensys ensys;
+	encom::handle pos1 = ensys.add(position_t(1.f));
+	encom::handle pos2 = ensys.add(position_t(2.f));
+	ensys.remove(pos1);
+
+	ensys_command_buffer commands(ensys);
+	encom::handle pos3 = commands.add(position_t(3.f));
+	encom::handle pos4 = commands.emplace<position_t>(4.f);
+	encom::handle player = commands.add(player_relation("player", position_t(5.f)));
+	commands.set(pos2, position_t(20.f));
+	commands.set(pos3, position_t(30.f));
+	commands.remove(pos4);
+
+	std::cout << "pos3 present before apply: " << ensys.has_element(pos3) << std::endl;
+	commands.apply();
+	std::cout << "buffer empty after apply: " << commands.empty() << std::endl;
+
+	std::cout << "pos2 x: " << ensys.get(pos2)->x << std::endl;
+	std::cout << "pos3 x: " << ensys.get(pos3)->x << std::endl;
+	std::cout << "pos4 present: " << ensys.has_element(pos4) << std::endl;
+	std::cout << "player name: " << ensys.get(player)->get<player_name_t>().name << std::endl;
+	std::cout << "player x: " << ensys.get(player)->get<position_t>().x << std::endl;
+
+	// reserved handles only use fresh slots, the freed slots are reused by direct adds after apply
+	encom::handle pos5 = ensys.add(position_t(6.f));
+	std::cout << "pos5 reused slot of pos4: " << (pos5.array_index == pos4.array_index) << std::endl;
+	std::cout << "pos4 present: " << ensys.has_element(pos4) << std::endl;
+	std::cout << "pos1 present: " << ensys.has_element(pos1) << std::endl;
+
+	ensys.remove(player);
+	std::cout << "number of positions: " << ensys.get_components<position_t>().size() << std::endl;
+	std::cout << "number of names: " << ensys.get_components<player_name_t>().size() << std::endl;
+	return ensys.get_components<position_t>().size() == 3 && ensys.get_components<player_name_t>().size() == 0;
+}
+
+bool test_command_queue() {
+	encom::thread_pool pool(4);
+	ensys ensys;
+	ensys.attach_thread_pool(pool);
+	ensys_command_queue commands(ensys);
+
+	for (int i = 0; i < 10000; i++) {
+		ensys.add(position_t(float(i)));
+	}
+
+	// every position with an even x is replaced by a player at the same x, while iterating concurrently
+	std::vector<encom::handle<position_t>> positions;
+	for (auto iter = ensys.get_components<position_t>().begin(); iter != ensys.get_components<position_t>().end(); ++iter) {
+		positions.push_back(encom::handle<position_t>(iter->consecutive_index, iter.index()));
+	}
+	pool.parallel_for(positions.size() / 100, [&](const std::size_t chunk) {
+		ensys_command_buffer& local = commands.local();
+		for (std::size_t i = chunk * 100; i < (chunk+1) * 100; i++) {
+			const float x = ensys.get(positions[i])->x;
+			if (int(x) % 2 == 0) {
+				local.remove(positions[i]);
+				local.add(player_relation("player", position_t(x)));
+			}
+		}
+	});
+	commands.apply();
+
+	float sum = 0.f;
+	ensys.query<player_relation>([&](const player_relation::as_ref& player) {
+		sum += player.get<position_t>().x;
+	});
+	std::cout << "number of players: " << ensys.get_components<player_relation>().size() << std::endl;
+	std::cout << "number of positions: " << ensys.get_components<position_t>().size() << std::endl;
+	std::cout << "sum of player positions: " << sum << std::endl;
+	return ensys.get_components<player_relation>().size() == 5000 && ensys.get_components<position_t>().size() == 10000;
+}
+
+bool test_alternating_queues() {
+	ensys ensys;
+	ensys_command_queue first(ensys);
+	ensys_command_queue second(ensys);
+
+	// a thread, that switches between queues, keeps recording into the same buffer of each queue
+	for (int i = 0; i < 1000; i++) {
+		first.local().add(position_t(float(i)));
+		second.local().add(position_t(float(-i)));
+	}
+	first.apply();
+	second.apply();
+	std::cout << "buffers: " << first.number_of_buffers() << " " << second.number_of_buffers() << std::endl;
+	std::cout << "number of positions: " << ensys.get_components<position_t>().size() << std::endl;
+	return first.number_of_buffers() == 1 && second.number_of_buffers() == 1 && ensys.get_components<position_t>().size() == 2000;
+}
+
+int main() {
+	const bool buffer_ok = test_command_buffer();
+	const bool queue_ok = test_command_queue();
+	const bool alternating_ok = test_alternating_queues();
+	return (buffer_ok && queue_ok && alternating_ok) ? 0 : 1;
+}
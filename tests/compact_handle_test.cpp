@@ -0,0 +1,85 @@
+#define ENCOM_COMPACT_HANDLES
+#define ENCOM_HANDLE_INDEX_BITS 16
+
+#include <iostream>
+#include <string>
+
+#include "encomsys.hpp"
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x) : x(x) {}
+
+	float x;
+};
+
+struct player_name_t {
+	player_name_t() = default;
+	player_name_t(const std::string& name) : name(name) {}
+
+	std::string name;
+};
+
+struct player_relation : encom::relation<player_name_t, position_t> {
+	using encom::relation<player_name_t, position_t>::relation;
+};
+
+template<>
+struct encom::component_storage<player_name_t> : encom::dense_storage {};
+
+using ensys = encom::encomsys<player_relation, player_name_t, position_t>;
+
+void test_sizes() {
+	std::cout << "sizeof(handle): " << sizeof(encom::handle<position_t>) << std::endl;
+	std::cout << "sizeof(generation): " << sizeof(encom::GENERATION_TYPE) << std::endl;
+	std::cout << "sizeof(component_wrapper<position_t>): " << sizeof(encom::component_wrapper<position_t>) << std::endl;
+	std::cout << "sizeof(component_wrapper<player_relation>): " << sizeof(encom::component_wrapper<player_relation>) << std::endl;
+}
+
+void test_stale_handles() {
+	ensys ensys;
+
+	encom::handle pos1 = ensys.add(position_t(1.f));
+	ensys.remove(pos1);
+	encom::handle pos2 = ensys.add(position_t(2.f));
+	std::cout << "pos2 reused slot of pos1: " << (pos2.array_index == pos1.array_index) << std::endl;
+	std::cout << "pos1 present: " << ensys.has_element(pos1) << std::endl;
+	std::cout << "pos2 present: " << ensys.has_element(pos2) << std::endl;
+	std::cout << "pos2 x: " << ensys.get(pos2)->x << std::endl;
+
+	// the same applies to dense storages, which reuse their sparse indices
+	encom::handle name1 = ensys.add(player_name_t("first"));
+	ensys.remove(name1);
+	encom::handle name2 = ensys.emplace<player_name_t>("second");
+	std::cout << "name1 present: " << ensys.has_element(name1) << std::endl;
+	std::cout << "name2: " << ensys.get(name2)->name << std::endl;
+
+	encom::handle player = ensys.add(player_relation("player", position_t(3.f)));
+	std::cout << "player name: " << ensys.get(player)->get<player_name_t>().name << std::endl;
+	ensys.remove(player);
+	std::cout << "player present: " << ensys.has_element(player) << std::endl;
+	encom::handle player2 = ensys.add(player_relation("player2", position_t(4.f)));
+	std::cout << "player present after reuse: " << ensys.has_element(player) << std::endl;
+	std::cout << "player2 x: " << ensys.get(player2)->get<position_t>().x << std::endl;
+}
+
+void test_index_limit() {
+	ensys ensys;
+	std::size_t added = 0;
+	try {
+		for (std::size_t i = 0; i < encom::MAX_HANDLE_INDEX + 2; i++) {
+			ensys.add(position_t(float(i)));
+			added++;
+		}
+	} catch (const char* message) {
+		std::cout << "caught: " << message << std::endl;
+	}
+	std::cout << "added: " << added << std::endl;
+	std::cout << "number of positions: " << ensys.get_components<position_t>().size() << std::endl;
+}
+
+int main() {
+	test_sizes();
+	test_stale_handles();
+	test_index_limit();
+}
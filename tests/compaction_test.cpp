@@ -0,0 +1,208 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "encomsys.hpp"
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x, const float y) : x(x), y(y) {}
+
+	float x;
+	float y;
+};
+
+struct health_t {
+	health_t() = default;
+	health_t(const int id) : id(id) {}
+
+	int id;
+};
+
+struct tag_t {
+	tag_t() = default;
+	tag_t(const int id) : id(id) {}
+
+	int id;
+};
+
+struct player_relation : encom::relation<position_t, health_t> {
+	using encom::relation<position_t, health_t>::relation;
+};
+
+template<>
+struct encom::component_storage<health_t> : encom::dense_storage {};
+
+template<>
+struct encom::component_storage<tag_t> : encom::chunked_storage<std::allocator, 64> {};
+
+template<> struct encom::secondary_index<player_relation> : encom::unique_key<&health_t::id> {};
+template<> struct encom::track_changes<position_t> : std::true_type {};
+
+using ensys = encom::encomsys<player_relation, position_t, health_t, tag_t>;
+using player_position_path = encom::access_path<ensys, player_relation, position_t>;
+
+// the id of the player, that shares the position of another player
+constexpr int SHARING_ID = 5000;
+
+/**
+ * Checks, that every player still points to the position, that was added with its id.
+ */
+bool players_intact(ensys& ensys) {
+	bool intact = true;
+	const auto& players = ensys.get_components<player_relation>();
+	for (auto iter = players.begin(); iter != players.end(); ++iter) {
+		const player_relation::as_ref player = ensys.__resolve_unchecked(encom::handle<player_relation>((*iter).consecutive_index, iter.index()));
+		const int id = player.get<health_t>().id;
+		intact = intact && (player.get<position_t>().x == float(id) || id == SHARING_ID);
+	}
+	return intact;
+}
+
+/**
+ * @returns whether the positions are visited front to back, when iterating over the players
+ */
+bool positions_in_player_order(ensys& ensys) {
+	bool ordered = true;
+	encom::ID_TYPE previous = 0;
+	bool first = true;
+	const auto& players = ensys.get_components<player_relation>();
+	for (auto iter = players.begin(); iter != players.end(); ++iter) {
+		const encom::ID_TYPE position = std::get<encom::handle<position_t>>((*iter)._handles).array_index;
+		ordered = ordered && (first || position > previous);
+		previous = position;
+		first = false;
+	}
+	return ordered;
+}
+
+int main() {
+	ensys ensys;
+
+	std::vector<encom::handle<player_relation>> players;
+	std::vector<encom::handle<tag_t>> tags;
+	std::vector<encom::handle<position_t>> loose_positions;
+	for (int i = 0; i < 1000; i++) {
+		players.push_back(ensys.add(player_relation(position_t(float(i), 0.f), health_t(i))));
+		tags.push_back(ensys.add(tag_t(i)));
+		loose_positions.push_back(ensys.add(position_t(-float(i), 1.f)));
+	}
+	// leave holes everywhere
+	for (std::size_t i = 0; i < players.size(); i += 2) {
+		ensys.remove(players[i]);
+		ensys.remove(tags[i]);
+	}
+	for (std::size_t i = 0; i < loose_positions.size(); i += 3) {
+		ensys.remove(loose_positions[i]);
+	}
+	std::cout << "positions before: " << ensys.get_components<position_t>().size() << " in "
+		<< ensys.get_components<position_t>().slot_count() << " slots" << std::endl;
+
+	// incremental compaction with a small budget per tick
+	const encom::ID_TYPE since = ensys.advance_tick();
+	std::size_t number_of_steps = 1;
+	while (!ensys.compact_step<position_t>(64)) {
+		number_of_steps++;
+	}
+	std::cout << "positions after: " << ensys.get_components<position_t>().size() << " in "
+		<< ensys.get_components<position_t>().slot_count() << " slots" << std::endl;
+	std::cout << "took more than one step: " << (number_of_steps > 1) << std::endl;
+	std::cout << "players intact: " << players_intact(ensys) << std::endl;
+
+	// handles held outside are translated
+	bool remapped = true;
+	for (std::size_t i = 1; i < loose_positions.size(); i++) {
+		if (i % 3 != 0) {
+			const std::optional<position_t> position = ensys.get(ensys.remap(loose_positions[i]));
+			remapped = remapped && position && position->x == -float(i);
+		}
+	}
+	std::cout << "remapped handles valid: " << remapped << std::endl;
+	std::cout << "removed handle stays invalid: " << !ensys.has_element(ensys.remap(loose_positions[0])) << std::endl;
+
+	// moves are recorded as removal and add
+	std::size_t added = 0;
+	std::size_t removed = 0;
+	ensys.for_each_change<position_t>(since, [&](const encom::handle<position_t>&, const encom::change_kind kind) {
+		added += kind == encom::change_kind::added;
+		removed += kind == encom::change_kind::removed;
+	});
+	std::cout << "moves recorded: " << (added != 0 && added == removed) << std::endl;
+
+	// reorder the childs to the iteration order of the players. Adds between the steps are fine.
+	for (int i = 1000; i < 1100; i++) {
+		players.push_back(ensys.add(player_relation(position_t(float(i), 0.f), health_t(i))));
+	}
+	std::cout << "positions in player order before: " << positions_in_player_order(ensys) << std::endl;
+	ensys.compact<player_relation>();
+	bool interleaved = true;
+	while (!ensys.compact_step<position_t>(100, encom::compaction_order::parents)) {
+		interleaved = interleaved && players_intact(ensys);
+		ensys.add(tag_t(-1));
+	}
+	std::cout << "intact between steps: " << interleaved << std::endl;
+	std::cout << "positions in player order after: " << positions_in_player_order(ensys) << std::endl;
+	std::cout << "players intact: " << players_intact(ensys) << std::endl;
+	std::cout << "positions dense: " << (ensys.get_components<position_t>().size() == ensys.get_components<position_t>().slot_count()) << std::endl;
+
+	// the secondary index follows the moved relations
+	const std::optional<encom::handle<player_relation>> found = ensys.lookup<player_relation>(1001);
+	std::cout << "lookup after compaction: " << (found && ensys.get_ref(*found)->get<position_t>().x == 1001.f) << std::endl;
+
+	// a child shared by two players keeps its slot
+	const encom::handle<player_relation> owner = ensys.remap(players[1099]);
+	const auto& owner_wrapper = ensys.get_components<player_relation>().get(owner.array_index);
+	const encom::handle<position_t> shared = std::get<encom::handle<position_t>>(owner_wrapper._handles);
+	ensys.__place(shared, 2, *ensys.get(shared));
+	ensys.__place(
+		encom::handle<player_relation>(1 << 20, ensys.get_components<player_relation>().slot_count()),
+		0,
+		player_relation::__component_handles(shared, ensys.add(health_t(SHARING_ID), 1))
+	);
+	ensys.remove(ensys.remap(players[1]));
+	ensys.compact<position_t>(encom::compaction_order::parents);
+	std::cout << "shared child kept its slot: " << ensys.has_element(shared) << std::endl;
+	std::cout << "players intact: " << players_intact(ensys) << std::endl;
+
+	// packed storages keep their handles and change their order
+	ensys.compact<health_t>(encom::compaction_order::parents);
+	bool health_order = true;
+	const auto& health = ensys.get_components<health_t>();
+	encom::ID_TYPE next_position = 0;
+	const auto& all_players = ensys.get_components<player_relation>();
+	for (auto iter = all_players.begin(); iter != all_players.end(); ++iter) {
+		const encom::handle<health_t> h = std::get<encom::handle<health_t>>((*iter)._handles);
+		health_order = health_order && health.position_of(h.array_index) == next_position++;
+	}
+	std::cout << "health in player order: " << health_order << std::endl;
+	std::cout << "players intact: " << players_intact(ensys) << std::endl;
+
+	// everything at once, with chunked storage
+	const std::size_t number_of_tags = ensys.get_components<tag_t>().size();
+	ensys.defragment();
+	std::cout << "tags after defragment: " << ensys.get_components<tag_t>().size() << " of " << number_of_tags
+		<< " in " << ensys.get_components<tag_t>().slot_count() << " slots" << std::endl;
+	bool tags_remapped = true;
+	for (std::size_t i = 1; i < tags.size(); i += 2) {
+		const std::optional<tag_t> tag = ensys.get(ensys.remap(tags[i]));
+		tags_remapped = tags_remapped && tag && tag->id == int(i);
+	}
+	std::cout << "tags remapped: " << tags_remapped << std::endl;
+	std::cout << "players intact: " << players_intact(ensys) << std::endl;
+
+	// compacting an empty storage
+	ensys.clear<tag_t>();
+	ensys.compact<tag_t>();
+	std::cout << "empty tags: " << ensys.get_components<tag_t>().slot_count() << std::endl;
+	std::cout << "add after compaction: " << ensys.get(ensys.add(tag_t(7)))->id << std::endl;
+
+	// shrinking a storage without holes reallocates it, so cached access paths are resolved again
+	encom::handle<player_relation> last = ensys.add(player_relation(position_t(3.f, 4.f), health_t(SHARING_ID + 1)));
+	player_position_path path(last);
+	ensys.compact<position_t>();
+	ensys.reserve<position_t>(100000);
+	path.get(ensys);
+	const encom::ID_TYPE epoch = ensys.epoch<position_t>();
+	ensys.compact<position_t>();
+	std::cout << "epoch changed by compaction: " << (epoch != ensys.epoch<position_t>()) << " y: " << path.get(ensys)->y << std::endl;
+}
@@ -0,0 +1,181 @@
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "delta.hpp"
+
+struct config_t {
+	config_t() = default;
+	config_t(const int difficulty, const float scale) : difficulty(difficulty), scale(scale) {}
+
+	bool operator==(const config_t& other) const {
+		return difficulty == other.difficulty && scale == other.scale;
+	}
+
+	int difficulty;
+	float scale;
+};
+
+struct player_name_t {
+	player_name_t() = default;
+	player_name_t(const std::string& name) : name(name) {}
+
+	bool operator==(const player_name_t& other) const {
+		return name == other.name;
+	}
+
+	encom::interned_string name;
+};
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x) : x(x) {}
+
+	float x;
+};
+
+struct unit_relation : encom::relation<player_name_t, config_t, position_t> {
+	using encom::relation<player_name_t, config_t, position_t>::relation;
+};
+
+template<>
+struct std::hash<config_t> {
+	std::size_t operator()(const config_t& config) const {
+		return std::hash<int>()(config.difficulty) * 31 + std::hash<float>()(config.scale);
+	}
+};
+
+template<>
+struct std::hash<player_name_t> {
+	std::size_t operator()(const player_name_t& name) const {
+		return std::hash<encom::interned_string>()(name.name);
+	}
+};
+
+template<> struct encom::deduplicate<config_t> : std::true_type {};
+template<> struct encom::deduplicate<player_name_t> : std::true_type {};
+template<> struct encom::track_changes<unit_relation> : std::true_type {};
+template<> struct encom::track_changes<config_t> : std::true_type {};
+
+template<>
+struct encom::serializer<player_name_t> {
+	static void write(encom::snapshot_writer& out, const player_name_t& name) {
+		encom::serializer<encom::interned_string>::write(out, name.name);
+	}
+
+	static player_name_t read(encom::snapshot_reader& in) {
+		player_name_t name;
+		name.name = encom::serializer<encom::interned_string>::read(in);
+		return name;
+	}
+};
+
+using ensys = encom::encomsys<unit_relation, player_name_t, config_t, position_t>;
+
+const char* const SNAPSHOT_PATH = "dedup_test.bin";
+
+unit_relation make_unit(const int i) {
+	return unit_relation(player_name_t("player" + std::to_string(i % 10)), config_t(i % 3, 1.5f), position_t(float(i)));
+}
+
+void print_sizes(const ensys& ensys) {
+	std::cout << "units: " << ensys.get_components<unit_relation>().size()
+		<< " names: " << ensys.get_components<player_name_t>().size()
+		<< " configs: " << ensys.get_components<config_t>().size()
+		<< " positions: " << ensys.get_components<position_t>().size() << std::endl;
+}
+
+/**
+ * @returns the number of relations referencing the config of unit
+ */
+std::uint32_t config_references(ensys& ensys, const encom::handle<unit_relation>& unit) {
+	const encom::handle<config_t>& config = std::get<encom::handle<config_t>>(ensys.get_components<unit_relation>().get(unit.array_index)._handles);
+	return ensys.get_components<config_t>().get(config.array_index).number_of_references;
+}
+
+int main() {
+	// interned strings are stored once and compare by address
+	const encom::interned_string alice("alice");
+	const encom::interned_string other_alice(std::string("ali") + "ce");
+	std::cout << "interned: " << (alice == other_alice) << " " << (alice.c_str() == other_alice.c_str()) << " " << alice.view() << " " << alice.size() << std::endl;
+	std::cout << "empty: " << (encom::interned_string("") == encom::interned_string()) << " '" << encom::interned_string().c_str() << "'" << std::endl;
+	const std::size_t number_of_strings = encom::string_arena::instance().size();
+	encom::interned_string("alice");
+	std::cout << "no new string: " << (encom::string_arena::instance().size() == number_of_strings) << std::endl;
+
+	// equal childs are stored once
+	ensys source;
+	std::vector<encom::handle<unit_relation>> units;
+	for (int i = 0; i < 1000; i++) {
+		units.push_back(source.add(make_unit(i)));
+	}
+	print_sizes(source);
+	std::cout << "references of a config: " << config_references(source, units[0]) << std::endl;
+
+	// shared childs are const in relation references and can not be written through their handle
+	static_assert(std::is_same_v<decltype(source.get_ref(units[0])->get<config_t>()), const config_t&>);
+	static_assert(std::is_same_v<decltype(source.get_ref(units[0])->get<position_t>()), position_t&>);
+	const encom::ID_TYPE before_get_ref = source.advance_tick();
+	auto unit = source.get_ref(units[0]);
+	unit->get<position_t>().x = 5.f;
+	std::cout << "get_ref of a relation with a shared child: " << unit->get<config_t>().difficulty << " " << source.get(units[0])->get<position_t>().x
+		<< " references: " << config_references(source, units[0]) << std::endl;
+	std::size_t modified_configs = 0;
+	source.for_each_change<config_t>(before_get_ref, [&modified_configs](const encom::handle<config_t>&, encom::change_kind) {
+		modified_configs++;
+	});
+	std::cout << "modified configs: " << modified_configs << std::endl;
+	const encom::handle<config_t> shared_config = std::get<encom::handle<config_t>>(source.get_components<unit_relation>().get(units[0].array_index)._handles);
+	try {
+		source.patch(shared_config, config_t(9, 1.5f));
+	} catch (const char* message) {
+		std::cout << "patch of a shared child: " << message << std::endl;
+	}
+	std::cout << "unchanged: " << source.get(units[3])->get<config_t>().difficulty << std::endl;
+
+	// modify_child() of a relation copies the shared child on write
+	const encom::ID_TYPE since = source.advance_tick();
+	source.modify_child<config_t>(units[0], [](config_t& config) { config.difficulty = 7; });
+	print_sizes(source);
+	std::cout << "written: " << source.get(units[0])->get<config_t>().difficulty << " others: " << source.get(units[3])->get<config_t>().difficulty
+		<< " references: " << config_references(source, units[0]) << " " << config_references(source, units[3]) << std::endl;
+	std::size_t modified_units = 0;
+	source.for_each_change<unit_relation>(since, [&modified_units](const encom::handle<unit_relation>&, encom::change_kind kind) {
+		modified_units += kind == encom::change_kind::modified;
+	});
+	std::cout << "modified units: " << modified_units << std::endl;
+
+	// an exclusive child is written in place, but is not shared anymore
+	source.modify_child<config_t>(units[0], [](config_t& config) { config.difficulty = 8; });
+	source.add(unit_relation(player_name_t("player0"), config_t(8, 1.5f), position_t(0.f)));
+	print_sizes(source);
+
+	// shared childs are removed with their last relation
+	const std::size_t removed = source.remove_bulk<unit_relation>(units.begin() + 1, units.end());
+	std::cout << "removed: " << removed << std::endl;
+	print_sizes(source);
+
+	// the shareable childs are found again after a compaction and after loading a snapshot
+	for (int i = 0; i < 100; i++) {
+		units.push_back(source.add(make_unit(i)));
+	}
+	source.remove_bulk<unit_relation>(units.end() - 50, units.end());
+	source.defragment();
+	source.add(make_unit(1));
+	print_sizes(source);
+
+	source.save(SNAPSHOT_PATH);
+	ensys loaded;
+	loaded.load(SNAPSHOT_PATH);
+	std::remove(SNAPSHOT_PATH);
+	loaded.add(make_unit(2));
+	print_sizes(loaded);
+	std::size_t player3 = 0;
+	loaded.query<unit_relation>([&player3](const unit_relation::as_ref& unit) {
+		player3 += unit.get<player_name_t>().name == encom::interned_string("player3");
+	});
+	std::cout << "loaded player3: " << player3 << std::endl;
+}
@@ -0,0 +1,126 @@
+#include <iostream>
+#include <string>
+
+#include "delta.hpp"
+
+struct player_name_t {
+	player_name_t() = default;
+	player_name_t(const std::string& name) : name(name) {}
+
+	std::string name;
+};
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x) : x(x) {}
+
+	float x;
+};
+
+struct player_relation : encom::relation<player_name_t, position_t> {
+	using encom::relation<player_name_t, position_t>::relation;
+};
+
+template<>
+struct encom::component_storage<position_t> : encom::dense_storage {};
+
+template<> struct encom::track_changes<player_relation> : std::true_type {};
+template<> struct encom::track_changes<player_name_t> : std::true_type {};
+template<> struct encom::track_changes<position_t> : std::true_type {};
+
+using ensys = encom::encomsys<player_relation, player_name_t, position_t>;
+using ensys_delta = encom::delta<ensys>;
+
+void print_player(ensys& ensys, const encom::handle<player_relation>& player) {
+	if (auto ref = ensys.get_ref(player)) {
+		std::cout << ref->get<player_name_t>().name << " x=" << ref->get<position_t>().x << std::endl;
+	} else {
+		std::cout << "player not present" << std::endl;
+	}
+}
+
+void print_delta(const ensys_delta& delta) {
+	std::cout << "delta since " << delta.since() << ": size=" << delta.size()
+		<< " player adds=" << delta.adds<player_relation>().size()
+		<< " position updates=" << delta.updates<position_t>().size()
+		<< " player removes=" << delta.removes<player_relation>().size() << std::endl;
+}
+
+void move_position(position_t& position) {
+	position.x += 100.f;
+}
+
+int main() {
+	ensys source;
+	ensys replica;
+
+	encom::handle alice = source.add(player_relation("alice", position_t(1.f)));
+	encom::handle bob = source.add(player_relation("bob", position_t(2.f)));
+	encom::handle carol = source.add(player_relation("carol", position_t(3.f)));
+
+	// the first delta contains everything
+	encom::ID_TYPE last_tick = 0;
+	ensys_delta initial(source, last_tick);
+	last_tick = source.advance_tick();
+	print_delta(initial);
+	initial.apply(replica);
+	print_player(replica, alice);
+	print_player(replica, bob);
+	print_player(replica, carol);
+
+	// nothing changed
+	std::cout << "empty delta: " << ensys_delta(source, last_tick).empty() << std::endl;
+
+	// writes through get_ref, removes and adds. The new player reuses the slots of bob.
+	source.get_ref(alice)->get<position_t>().x = 10.f;
+	source.get_ref(alice)->get<position_t>().x = 11.f;
+	source.remove(bob);
+	encom::handle dave = source.add(player_relation("dave", position_t(4.f)));
+
+	ensys_delta changes(source, last_tick);
+	last_tick = source.advance_tick();
+	print_delta(changes);
+	changes.apply(replica);
+	print_player(replica, alice);
+	print_player(replica, bob);
+	print_player(replica, carol);
+	print_player(replica, dave);
+	std::cout << "replica names: " << replica.get_components<player_name_t>().size() << std::endl;
+
+	// components added to the replica later get new consecutive indices
+	encom::handle own = replica.add(position_t(5.f));
+	std::cout << "own position present: " << replica.has_element(own) << std::endl;
+	replica.remove(own);
+
+	// changes, that were added and removed between two deltas, only remove handles, the replica never had
+	encom::handle short_lived = source.add(player_relation("short", position_t(6.f)));
+	source.remove(short_lived);
+	source.remove(carol);
+	ensys_delta removes(source, last_tick);
+	last_tick = source.advance_tick();
+	print_delta(removes);
+	removes.apply(replica);
+	print_player(replica, carol);
+	print_player(replica, dave);
+	std::cout << "replica players: " << replica.get_components<player_relation>().size() << std::endl;
+
+	// a delta since an older tick contains the changes of all following ticks
+	ensys_delta combined(source, 1);
+	print_delta(combined);
+
+	// writes, that do not go through get_ref(), are marked explicitly
+	encom::handle single = source.add(position_t(7.f));
+	ensys_delta(source, last_tick).apply(replica);
+	last_tick = source.advance_tick();
+	source.for_each<position_t>(move_position);
+	source.mark_changed(single);
+	ensys_delta after_for_each(source, last_tick);
+	print_delta(after_for_each);
+	after_for_each.apply(replica);
+	std::cout << "single x: " << replica.get(single)->x << std::endl;
+	// the unmarked write to the position of alice is not replicated
+	print_player(replica, alice);
+
+	source.discard_changes_before(last_tick);
+	std::cout << "delta after discard: " << ensys_delta(source, 0).size() << std::endl;
+}
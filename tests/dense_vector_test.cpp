@@ -0,0 +1,99 @@
+#include <iostream>
+#include <string>
+
+#include <util/dense_vector.hpp>
+#include "encomsys.hpp"
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x) : x(x) {}
+
+	float x;
+};
+
+struct player_name_t {
+	player_name_t() = default;
+	player_name_t(const std::string& name) : name(name) {}
+
+	std::string name;
+};
+
+struct player_relation : encom::relation<player_name_t, position_t> {
+	using encom::relation<player_name_t, position_t>::relation;
+};
+
+template<>
+struct encom::component_storage<position_t> : encom::dense_storage {};
+
+template<>
+struct encom::component_storage<player_relation> : encom::dense_storage {};
+
+using ensys = encom::encomsys<player_relation, player_name_t, position_t>;
+
+void print_vec(const encom::dense_vector<int>& vec) {
+	for (auto iter = vec.begin(); iter != vec.end(); ++iter) {
+		std::cout << iter.index() << ": " << *iter << std::endl;
+	}
+}
+
+void test_dense_vector() {
+	encom::dense_vector<int> vec;
+
+	vec.add(100);
+	vec.add(101);
+	vec.add(102);
+	vec.add(103);
+	vec.add(104);
+
+	std::cout << "initial vec:" << std::endl;
+	print_vec(vec);
+
+	vec.remove(0);
+	vec.remove(2);
+	std::cout << "removed at index 0 and 2" << std::endl;
+	print_vec(vec);
+
+	std::cout << "added 105 at " << vec.add(105) << std::endl;
+	print_vec(vec);
+
+	std::cout << "index 4 holds " << vec.get(4) << std::endl;
+	std::cout << "has index 0: " << vec.has_index(0) << std::endl;
+}
+
+void move_position(position_t& pos) {
+	pos.x += 1.f;
+}
+
+void print_position(const position_t& pos) {
+	std::cout << "Position (x=" << pos.x << ")" << std::endl;
+}
+
+void test_dense_encomsys() {
+	ensys ensys;
+
+	encom::handle pos1 = ensys.add(position_t(1.f));
+	encom::handle pos2 = ensys.add(position_t(2.f));
+	encom::handle player = ensys.add(player_relation("player", position_t(3.f)));
+
+	ensys.remove(pos1);
+	std::cout << "pos1 present: " << ensys.has_element(pos1) << std::endl;
+	std::cout << "pos2 present: " << ensys.has_element(pos2) << std::endl;
+
+	ensys.for_each<position_t>(move_position);
+	ensys.for_each<position_t>(print_position);
+
+	encom::handle pos3 = ensys.add(position_t(4.f));
+	std::cout << "pos3 reused index of pos1: " << (pos3.array_index == pos1.array_index) << std::endl;
+	std::cout << "pos1 present after reuse: " << ensys.has_element(pos1) << std::endl;
+
+	std::cout << "player name: " << ensys.get(player)->get<player_name_t>().name << std::endl;
+	std::cout << "player x: " << ensys.get(player)->get<position_t>().x << std::endl;
+
+	ensys.remove(player);
+	std::cout << "number of positions: " << ensys.get_components<position_t>().size() << std::endl;
+}
+
+int main() {
+	test_dense_vector();
+	test_dense_encomsys();
+}
@@ -0,0 +1,142 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "encomsys.hpp"
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x) : x(x) {}
+
+	float x;
+};
+
+struct health_t {
+	health_t() = default;
+	health_t(const int hp) : hp(hp) {}
+
+	int hp;
+};
+
+struct velocity_t {
+	velocity_t() = default;
+	velocity_t(const float x, const float y) : x(x), y(y) {}
+
+	float x;
+	float y;
+};
+
+template<>
+struct encom::soa_layout<velocity_t> {
+	using fields = encom::soa_fields<&velocity_t::x, &velocity_t::y>;
+};
+
+template<>
+struct encom::component_storage<health_t> : encom::dense_storage {};
+
+struct player_relation : encom::relation<position_t, health_t> {
+	using encom::relation<position_t, health_t>::relation;
+};
+
+using ensys = encom::encomsys<player_relation, position_t, health_t, velocity_t>;
+
+void move_position(position_t& position) {
+	position.x += 1.f;
+}
+
+float sum_positions(const ensys& ensys) {
+	float sum = 0.f;
+	ensys.for_each<position_t>([&sum](const position_t& position) {
+		sum += position.x;
+	});
+	return sum;
+}
+
+int main() {
+	ensys entities;
+	std::vector<encom::handle<position_t>> positions;
+	for (int i = 0; i < 10; i++) {
+		positions.push_back(entities.add(position_t(float(i))));
+		entities.add(health_t(i));
+		entities.add(velocity_t(float(i), 0.f));
+	}
+	entities.remove(positions[2]);
+	entities.remove(positions[5]);
+	entities.add(player_relation(position_t(100.f), health_t(100)));
+
+	// capturing lambdas and function pointers
+	float sum = 0.f;
+	entities.for_each<position_t>([&sum](position_t& position) { sum += position.x; });
+	std::cout << "sum: " << sum << std::endl;
+	entities.for_each<position_t>(move_position);
+	entities.for_each<position_t>(&move_position);
+	std::cout << "const sum after moves: " << sum_positions(entities) << std::endl;
+
+	// the encomsys is passed as second argument, if the callable accepts it
+	std::size_t visited = 0;
+	entities.for_each<health_t>([&visited](health_t&, const ensys& e) { visited += e.get_components<health_t>().size(); });
+	std::cout << "with encomsys: " << visited << std::endl;
+
+	// returning false stops the iteration
+	int first_low_hp = -1;
+	const bool completed = entities.for_each<health_t>([&first_low_hp](const health_t& health) {
+		if (health.hp > 3) {
+			first_low_hp = health.hp;
+			return false;
+		}
+		return true;
+	});
+	std::cout << "stopped: " << !completed << " at " << first_low_hp << std::endl;
+	std::size_t all = 0;
+	std::cout << "completed: " << entities.for_each<health_t>([&all](const health_t&) { all++; return true; }) << " " << all << std::endl;
+
+	// ranges split one iteration of a storage with holes
+	const encom::ID_TYPE end = entities.get_components<position_t>().position_count();
+	std::vector<float> parts;
+	for (encom::ID_TYPE begin = 0; begin < end; begin += 4) {
+		entities.for_each_in<position_t>(begin, begin + 4, [&parts](const position_t& position) { parts.push_back(position.x); });
+	}
+	std::cout << "positions in parts:";
+	for (const float x : parts) {
+		std::cout << " " << x;
+	}
+	std::cout << std::endl;
+	const ensys& readonly = entities;
+	std::size_t in_range = 0;
+	readonly.for_each_in<health_t>(2, 5, [&in_range](const health_t&) { in_range++; });
+	std::cout << "const range: " << in_range << std::endl;
+
+	// relations and structure-of-arrays components
+	entities.for_each<player_relation>([](const player_relation::as_ref& player) {
+		player.get<health_t>().hp -= 10;
+	});
+	entities.for_each<velocity_t>([](encom::soa_ref<velocity_t> velocity) {
+		velocity.get<&velocity_t::y>() = velocity.get<&velocity_t::x>() * 2.f;
+	});
+	float velocity_sum = 0.f;
+	entities.for_each<velocity_t>([&velocity_sum](encom::soa_ref<velocity_t> velocity) { velocity_sum += velocity.get<&velocity_t::y>(); });
+	int player_hp = 0;
+	entities.for_each<player_relation>([&player_hp](const player_relation::as_ref& player) { player_hp = player.get<health_t>().hp; });
+	std::cout << "player hp: " << player_hp << " velocity y: " << velocity_sum << std::endl;
+
+	// ranges across full and partially occupied words of the occupancy bitmap
+	for (int i = 0; i < 200; i++) {
+		positions.push_back(entities.add(position_t(float(i))));
+	}
+	for (std::size_t i = 20; i < positions.size(); i += 7) {
+		entities.remove(positions[i]);
+	}
+	std::size_t iterated = 0;
+	for (const encom::component_wrapper<position_t>& wrapper : entities.get_components<position_t>()) {
+		(void)wrapper;
+		iterated++;
+	}
+	const encom::ID_TYPE slots = entities.get_components<position_t>().position_count();
+	std::size_t in_ranges = 0;
+	for (encom::ID_TYPE begin = 0; begin < slots; begin += 37) {
+		entities.for_each_in<position_t>(begin, begin + 37, [&in_ranges](const position_t&) { in_ranges++; });
+	}
+	std::size_t until_stop = 0;
+	entities.for_each<position_t>([&until_stop](const position_t&) { return ++until_stop < 130; });
+	std::cout << "iterated: " << iterated << " in ranges: " << in_ranges << " until stop: " << until_stop << std::endl;
+}
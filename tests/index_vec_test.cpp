@@ -1,3 +1,4 @@
+#include <cstdint>
 #include <iostream>
 
 #include <util/index_vector.hpp>
@@ -56,4 +57,32 @@ int main() {
 	print_vec(vec);
 
 	std::cout << vec.get(5) << std::endl;
+
+	vec.remove(1);
+	vec.remove(3);
+	vec.remove(4);
+	vec.emplace_at(3, 109);
+	std::cout << "removed at index 1, 3 and 4, emplaced 109 at 3" << std::endl;
+	print_vec(vec);
+	std::cout << "added 110 at " << vec.add(110) << std::endl;
+	std::cout << "added 111 at " << vec.add(111) << std::endl;
+	std::cout << "added 112 at " << vec.add(112) << std::endl;
+
+	// snapshots write the slots as raw bytes, so a removed value does not stay behind the free list links
+	struct sample_t {
+		std::uint32_t id;
+		double first;
+		double second;
+	};
+	encom::index_vector<sample_t> samples;
+	samples.add(sample_t {1, 2.0, 3.0});
+	samples.add(sample_t {4, 5.0, 6.0});
+	samples.remove(0);
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(samples.slots());
+	bool zeroed = true;
+	for (std::size_t i = sizeof(encom::free_slot_links); i < sizeof(encom::index_vector_slot<sample_t>); i++) {
+		zeroed = zeroed && bytes[i] == 0;
+	}
+	std::cout << "removed slot zeroed: " << zeroed << std::endl;
+	std::cout << "reused slot " << samples.add(sample_t {7, 8.0, 9.0}) << ": " << samples.get(0).second << std::endl;
 }
@@ -0,0 +1,145 @@
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "command_buffer.hpp"
+#include "delta.hpp"
+
+struct player_name_t {
+	player_name_t() = default;
+	player_name_t(const std::string& name) : name(name) {}
+
+	std::string name;
+};
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x) : x(x) {}
+
+	float x;
+};
+
+struct health_t {
+	health_t() = default;
+	health_t(const int id) : id(id) {}
+
+	int id;
+};
+
+struct player_relation : encom::relation<player_name_t, position_t> {
+	using encom::relation<player_name_t, position_t>::relation;
+};
+
+// stores its position and health inline, the player relation by handle
+struct unit_relation : encom::relation<player_relation, position_t, health_t> {
+	using encom::relation<player_relation, position_t, health_t>::relation;
+
+	unit_relation() {}
+};
+
+template<> struct encom::inline_childs<player_relation> : std::true_type {};
+template<> struct encom::inline_childs<unit_relation> : std::true_type {};
+template<> struct encom::secondary_index<unit_relation> : encom::unique_key<&health_t::id> {};
+template<> struct encom::track_changes<unit_relation> : std::true_type {};
+template<> struct encom::track_changes<player_relation> : std::true_type {};
+
+template<>
+struct encom::serializer<player_name_t> {
+	static void write(encom::snapshot_writer& out, const player_name_t& name) {
+		out.write_string(name.name);
+	}
+
+	static player_name_t read(encom::snapshot_reader& in) {
+		return player_name_t(in.read_string());
+	}
+};
+
+using ensys = encom::encomsys<unit_relation, player_relation, player_name_t, position_t, health_t>;
+using ensys_commands = encom::command_buffer<ensys>;
+using ensys_delta = encom::delta<ensys>;
+using inline_path = encom::access_path<ensys, unit_relation, position_t>;
+using nested_path = encom::access_path<ensys, unit_relation, player_relation, position_t>;
+
+static_assert(std::is_same_v<encom::stored_childs_t<unit_relation>, std::tuple<encom::handle<player_relation>, position_t, health_t>>);
+static_assert(std::is_same_v<decltype(std::declval<unit_relation::as_ref&>().get<position_t>()), position_t&>);
+
+unit_relation make_unit(const int id) {
+	return unit_relation(player_relation("unit" + std::to_string(id), position_t(float(id))), position_t(float(-id)), health_t(id));
+}
+
+/**
+ * @returns whether every unit still has the name, positions and health, that were added with its id
+ */
+bool units_intact(ensys& ensys) {
+	bool intact = true;
+	ensys.query<unit_relation>([&intact](const unit_relation::as_ref& unit) {
+		const int id = unit.get<health_t>().id;
+		intact = intact && unit.get<player_relation, player_name_t>().name == "unit" + std::to_string(id)
+			&& unit.get<player_relation, position_t>().x == float(id) && unit.get<position_t>().x == float(-id);
+	});
+	return intact;
+}
+
+int main() {
+	ensys source;
+
+	std::vector<encom::handle<unit_relation>> units;
+	for (int i = 0; i < 100; i++) {
+		units.push_back(source.add(make_unit(i)));
+	}
+	std::cout << "units: " << source.get_components<unit_relation>().size() << std::endl;
+	std::cout << "players by handle: " << source.get_components<player_relation>().size() << std::endl;
+	std::cout << "stored positions: " << source.get_components<position_t>().size() << std::endl;
+	std::cout << "stored names: " << source.get_components<player_name_t>().size() << std::endl;
+
+	// get, get_ref and views resolve inline childs from the slot of the relation
+	std::cout << "get: " << source.get(units[7])->get<position_t>().x << " " << source.get(units[7])->get<player_relation, player_name_t>().name << std::endl;
+	source.get_ref(units[7])->get<position_t>().x = 70.f;
+	source.get_ref(units[7])->get<player_relation, position_t>().x = 700.f;
+	std::cout << "get_ref: " << source.get(units[7])->get<position_t>().x << " " << source.get(units[7])->get<player_relation, position_t>().x << std::endl;
+	source.get_ref(units[7])->get<position_t>().x = -7.f;
+	source.get_ref(units[7])->get<player_relation, position_t>().x = 7.f;
+	std::cout << "intact: " << units_intact(source) << std::endl;
+
+	// secondary index keys and access paths read inline childs
+	const std::optional<encom::handle<unit_relation>> found = source.lookup<unit_relation>(42);
+	std::cout << "lookup: " << (found && source.get(*found)->get<position_t>().x == -42.f) << std::endl;
+	std::cout << "access paths: " << inline_path(units[3]).get(source)->x << " " << nested_path(units[3]).get(source)->x << std::endl;
+
+	// removing a unit releases the player relation, the inline childs go with the slot
+	std::cout << "removed with childs: " << source.remove_bulk<unit_relation>(units.begin(), units.begin() + 10) << std::endl;
+	std::cout << "players after remove: " << source.get_components<player_relation>().size() << std::endl;
+
+	// commands keep the inline childs in the recorded relation
+	ensys_commands commands(source);
+	const encom::handle<unit_relation> commanded = commands.add(make_unit(1000));
+	commands.apply();
+	std::cout << "command: " << source.get(commanded)->get<player_relation, player_name_t>().name << " "
+		<< source.get(commanded)->get<position_t>().x << std::endl;
+
+	// deltas carry the inline childs, the childs by handle are tracked by themselves
+	ensys replica;
+	ensys_delta(source, 0).apply(replica);
+	std::cout << "replica intact: " << units_intact(replica) << " " << replica.get_components<unit_relation>().size() << std::endl;
+
+	// compaction moves the relations with their inline childs
+	source.defragment();
+	for (encom::handle<unit_relation>& unit : units) {
+		unit = source.remap(unit);
+	}
+	std::cout << "after defragment: " << units_intact(source) << " " << source.get(units[50])->get<position_t>().x << std::endl;
+
+	// snapshots write inline childs like components
+	const std::string path = "/tmp/encomsys_inline_childs_test.snapshot";
+	source.save(path);
+	ensys loaded;
+	loaded.load(path);
+	std::remove(path.c_str());
+	std::cout << "loaded intact: " << units_intact(loaded) << " " << loaded.get(units[50])->get<player_relation, player_name_t>().name << std::endl;
+
+	// the slot holds the childs themselves
+	const encom::component_stats stats = source.stats<unit_relation>();
+	std::cout << "payload per unit: " << stats.payload_bytes / stats.live << " of " << sizeof(encom::stored_childs_t<unit_relation>) << std::endl;
+}
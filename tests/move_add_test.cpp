@@ -0,0 +1,120 @@
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include "encomsys.hpp"
+
+// counts every heap allocation of this program
+static std::size_t number_of_allocations = 0;
+
+void* operator new(std::size_t size) {
+	number_of_allocations++;
+	if (void* p = std::malloc(size)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+struct player_name_t {
+	player_name_t() = default;
+	player_name_t(const std::string& name) : name(name) {}
+	player_name_t(const char* name) : name(name) {}
+
+	std::string name;
+};
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x) : x(x) {}
+
+	float x;
+};
+
+struct copy_counter {
+	static int copies;
+
+	copy_counter() = default;
+	copy_counter(const copy_counter&) { copies++; }
+	copy_counter(copy_counter&&) = default;
+	copy_counter& operator=(const copy_counter&) { copies++; return *this; }
+	copy_counter& operator=(copy_counter&&) = default;
+};
+int copy_counter::copies = 0;
+
+struct player_relation : encom::relation<player_name_t, position_t, copy_counter> {
+	using encom::relation<player_name_t, position_t, copy_counter>::relation;
+};
+
+struct admin_player_relation : encom::relation<player_relation, player_name_t> {
+	using encom::relation<player_relation, player_name_t>::relation;
+
+	admin_player_relation() {}
+};
+
+using ensys = encom::encomsys<admin_player_relation, player_relation, player_name_t, position_t, copy_counter>;
+
+// longer than the small string buffer, so every copy of a name allocates
+const char* const LONG_NAME = "a player name, that does not fit into the small string buffer";
+
+int main() {
+	ensys ensys;
+	ensys.reserve<admin_player_relation>(10);
+	ensys.reserve<player_relation>(10);
+	ensys.reserve<player_name_t>(10);
+
+	int result = 0;
+
+	player_name_t name(LONG_NAME);
+	number_of_allocations = 0;
+	ensys.add(name);
+	std::cout << "add(const player_name_t&) allocations: " << number_of_allocations << std::endl;
+	result |= number_of_allocations != 1;
+
+	number_of_allocations = 0;
+	ensys.add(std::move(name));
+	std::cout << "add(player_name_t&&) allocations: " << number_of_allocations << std::endl;
+	result |= number_of_allocations != 0;
+
+	number_of_allocations = 0;
+	ensys.emplace<player_name_t>(LONG_NAME);
+	std::cout << "emplace<player_name_t>(const char*) allocations: " << number_of_allocations << std::endl;
+	result |= number_of_allocations != 1;
+
+	player_relation player(player_name_t(LONG_NAME), position_t(1.f), copy_counter());
+	number_of_allocations = 0;
+	copy_counter::copies = 0;
+	encom::handle player_handle = ensys.add(std::move(player));
+	std::cout << "add(player_relation&&) allocations: " << number_of_allocations << " copies: " << copy_counter::copies << std::endl;
+	result |= number_of_allocations != 0 || copy_counter::copies != 0;
+
+	admin_player_relation admin(player_relation(player_name_t(LONG_NAME), position_t(2.f), copy_counter()), player_name_t(LONG_NAME));
+	number_of_allocations = 0;
+	copy_counter::copies = 0;
+	ensys.add(std::move(admin));
+	std::cout << "add(admin_player_relation&&) allocations: " << number_of_allocations << " copies: " << copy_counter::copies << std::endl;
+	result |= number_of_allocations != 0 || copy_counter::copies != 0;
+
+	std::cout << "moved player name: " << ensys.get(player_handle)->get<player_name_t>().name << std::endl;
+
+	// adding a copy of a stored element has to read it before the storage grows, whenever it is full
+	::ensys copies;
+	encom::handle<player_name_t> original = copies.add(player_name_t(LONG_NAME));
+	bool copied = true;
+	for (int i = 0; i < 64; i++) {
+		const encom::handle<player_name_t> copy = copies.add(*copies.get_ref(original));
+		copied = copied && copies.get(copy)->name == LONG_NAME;
+		original = copy;
+	}
+	std::cout << "added copies of stored names: " << copied << std::endl;
+	result |= !copied;
+	return result;
+}
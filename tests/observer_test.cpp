@@ -0,0 +1,80 @@
+#include <iostream>
+#include <string>
+
+#include "encomsys.hpp"
+
+struct player_name_t {
+	player_name_t() = default;
+	player_name_t(const std::string& name) : name(name) {}
+
+	std::string name;
+};
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x) : x(x) {}
+
+	float x;
+};
+
+struct player_relation : encom::relation<player_name_t, position_t> {
+	using encom::relation<player_name_t, position_t>::relation;
+};
+
+template<>
+struct encom::component_storage<position_t> : encom::dense_storage {};
+
+using ensys = encom::encomsys<player_relation, player_name_t, position_t>;
+
+int main() {
+	ensys ensys;
+
+	// immediate observers are called for every event
+	ensys.on_add<player_relation>([&ensys](const encom::handle<player_relation>& player) {
+		std::cout << "added player " << ensys.get_ref(player)->get<player_name_t>().name << std::endl;
+	});
+	ensys.on_remove<position_t>([&ensys](const encom::handle<position_t>& position) {
+		std::cout << "removing position x=" << ensys.get(position)->x << std::endl;
+	});
+	const encom::observer_id modify_observer = ensys.on_modify<position_t>([&ensys](const encom::handle<position_t>& position) {
+		std::cout << "modified position x=" << ensys.get(position)->x << std::endl;
+	});
+
+	// batched observers get all handles since the last dispatch_events() at once
+	ensys.on_add<position_t>([](const encom::handle<position_t>*, std::size_t count) {
+		std::cout << "batch of " << count << " added positions" << std::endl;
+	});
+	ensys.on_remove<player_name_t>([](const encom::handle<player_name_t>* handles, std::size_t count) {
+		std::cout << "batch of " << count << " removed names, first index " << handles[0].array_index << std::endl;
+	});
+
+	encom::handle alice = ensys.add(player_relation("alice", position_t(1.f)));
+	encom::handle bob = ensys.add(player_relation("bob", position_t(2.f)));
+	encom::handle single = ensys.add(position_t(3.f));
+	ensys.dispatch_events();
+	std::cout << "nothing left to dispatch" << std::endl;
+	ensys.dispatch_events();
+
+	// modify and patch notify the modify observers
+	ensys.modify(single, [](position_t& position) { position.x += 10.f; });
+	ensys.patch(single, position_t(20.f));
+	const encom::handle<position_t> bob_position = std::get<encom::handle<position_t>>(ensys.get_components<player_relation>().get(bob.array_index)._handles);
+	ensys.patch(bob_position, position_t(5.f));
+	std::cout << "patched removed handle: " << ensys.patch(encom::handle<position_t>(99, 99), position_t(0.f)) << std::endl;
+
+	// removing a relation notifies the observers of its childs, relation observers can still read the childs
+	ensys.on_remove<player_relation>([&ensys](const encom::handle<player_relation>& player) {
+		std::cout << "removing player " << ensys.get(player)->get<player_name_t>().name << std::endl;
+	});
+	ensys.remove(alice);
+	ensys.remove(single);
+	ensys.dispatch_events();
+
+	std::cout << "removed modify observer: " << ensys.remove_observer<position_t>(modify_observer) << std::endl;
+	std::cout << "removed twice: " << ensys.remove_observer<position_t>(modify_observer) << std::endl;
+	ensys.patch(bob_position, position_t(6.f));
+	std::cout << "bob x: " << ensys.get(bob_position)->x << std::endl;
+
+	ensys.clear<player_relation>();
+	ensys.dispatch_events();
+}
@@ -0,0 +1,66 @@
+#include <atomic>
+#include <iostream>
+#include <string>
+
+#include "encomsys.hpp"
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x) : x(x) {}
+
+	float x;
+};
+
+struct player_name_t {
+	player_name_t() = default;
+	player_name_t(const std::string& name) : name(name) {}
+
+	std::string name;
+};
+
+struct player_relation : encom::relation<player_name_t, position_t> {
+	using encom::relation<player_name_t, position_t>::relation;
+};
+
+using ensys = encom::encomsys<player_relation, player_name_t, position_t>;
+
+int main() {
+	encom::thread_pool pool(4);
+	ensys ensys;
+	ensys.attach_thread_pool(pool);
+
+	std::vector<encom::handle<position_t>> handles;
+	for (int i = 0; i < 10000; i++) {
+		handles.push_back(ensys.add(position_t(static_cast<float>(i))));
+	}
+	for (int i = 0; i < 1000; i++) {
+		ensys.add(player_relation("player", position_t(0.f)));
+	}
+	// leave holes, so chunks have different costs
+	for (int i = 0; i < 10000; i += 3) {
+		ensys.remove(handles[i]);
+	}
+
+	std::atomic<int> number_of_positions(0);
+	ensys.parallel_for_each<position_t>([&](position_t& pos) {
+		pos.x += 1.f;
+		number_of_positions++;
+	}, 256);
+	std::cout << "visited positions: " << number_of_positions << " of " << ensys.get_components<position_t>().size() << std::endl;
+	std::cout << "position 1: " << ensys.get(handles[1])->x << std::endl;
+
+	std::atomic<int> number_of_players(0);
+	ensys.parallel_for_each<player_relation>([&](const player_relation::as_ref& player) {
+		std::get<position_t&>(player).x = 5.f;
+		number_of_players++;
+	}, 64);
+	std::cout << "visited players: " << number_of_players << std::endl;
+
+	float sum = 0.f;
+	ensys.query<player_relation>([&](const player_relation::as_ref& player) {
+		sum += player.get<position_t>().x;
+	});
+	std::cout << "sum of player positions: " << sum << std::endl;
+
+	return (number_of_positions == int(ensys.get_components<position_t>().size()) && number_of_players == 1000) ? 0 : 1;
+}
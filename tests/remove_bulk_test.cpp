@@ -0,0 +1,102 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "encomsys.hpp"
+
+struct player_name_t {
+	player_name_t() = default;
+	player_name_t(const std::string& name) : name(name) {}
+
+	std::string name;
+};
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x) : x(x) {}
+
+	float x;
+};
+
+struct password_component {
+	std::string passwd;
+
+	password_component() = default;
+	password_component(const std::string& pw) : passwd(pw) {}
+};
+
+struct player_relation : encom::relation<player_name_t, position_t> {
+	using encom::relation<player_name_t, position_t>::relation;
+};
+
+struct admin_player_relation : encom::relation<player_relation, password_component> {
+	using encom::relation<player_relation, password_component>::relation;
+
+	admin_player_relation() {}
+};
+
+template<>
+struct encom::component_storage<position_t> : encom::dense_storage {};
+
+using ensys = encom::encomsys<admin_player_relation, player_relation, player_name_t, position_t, password_component>;
+
+void print_sizes(const ensys& ensys) {
+	std::cout << "admins=" << ensys.get_components<admin_player_relation>().size()
+		<< " players=" << ensys.get_components<player_relation>().size()
+		<< " names=" << ensys.get_components<player_name_t>().size()
+		<< " positions=" << ensys.get_components<position_t>().size()
+		<< " passwords=" << ensys.get_components<password_component>().size() << std::endl;
+}
+
+void test_remove_bulk() {
+	ensys ensys;
+	std::vector<encom::handle<admin_player_relation>> admins;
+	for (int i = 0; i < 10; i++) {
+		admins.push_back(ensys.add(admin_player_relation(player_relation("admin", position_t(float(i))), password_component("pw"))));
+	}
+	encom::handle single_player = ensys.add(player_relation("player", position_t(100.f)));
+	print_sizes(ensys);
+
+	// duplicates and stale handles are ignored
+	std::vector<encom::handle<admin_player_relation>> to_remove(admins.begin(), admins.begin() + 6);
+	to_remove.push_back(admins[0]);
+	std::cout << "removed: " << ensys.remove_bulk<admin_player_relation>(to_remove.begin(), to_remove.end()) << std::endl;
+	std::cout << "removed again: " << ensys.remove_bulk<admin_player_relation>(to_remove.begin(), to_remove.end()) << std::endl;
+	std::cout << "admin 0 present: " << ensys.has_element(admins[0]) << std::endl;
+	std::cout << "admin 6 present: " << ensys.has_element(admins[6]) << std::endl;
+	std::cout << "admin 6 x: " << ensys.get(admins[6])->get<player_relation>().get<position_t>().x << std::endl;
+	print_sizes(ensys);
+
+	// referenced childs are not removed
+	encom::handle<player_relation> child = std::get<0>(ensys.get_components<admin_player_relation>().get(admins[7].array_index)._handles);
+	std::vector<encom::handle<player_relation>> players {child, single_player};
+	std::cout << "removed players: " << ensys.remove_bulk<player_relation>(players.begin(), players.end()) << std::endl;
+	std::cout << "child present: " << ensys.has_element(child) << std::endl;
+	print_sizes(ensys);
+}
+
+void test_clear() {
+	ensys ensys;
+	for (int i = 0; i < 10; i++) {
+		ensys.add(admin_player_relation(player_relation("admin", position_t(float(i))), password_component("pw")));
+		ensys.add(player_relation("player", position_t(float(i))));
+	}
+	encom::handle position = ensys.add(position_t(-1.f));
+	print_sizes(ensys);
+
+	// players owned by admins are referenced, so only the free players are removed
+	std::cout << "cleared players: " << ensys.clear<player_relation>() << std::endl;
+	print_sizes(ensys);
+
+	std::cout << "cleared admins: " << ensys.clear<admin_player_relation>() << std::endl;
+	print_sizes(ensys);
+	std::cout << "position present: " << ensys.has_element(position) << std::endl;
+
+	encom::handle admin = ensys.add(admin_player_relation(player_relation("new admin", position_t(1.f)), password_component("pw")));
+	std::cout << "new admin: " << ensys.get(admin)->get<player_relation>().get<player_name_t>().name << std::endl;
+}
+
+int main() {
+	test_remove_bulk();
+	test_clear();
+}
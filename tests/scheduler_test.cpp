@@ -0,0 +1,104 @@
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "encomsys.hpp"
+#include "scheduler.hpp"
+
+struct player_name_t {
+	player_name_t() = default;
+	player_name_t(const std::string& name) : name(name) {}
+
+	std::string name;
+};
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x) : x(x) {}
+
+	float x;
+};
+
+struct password_component {
+	std::string passwd;
+
+	password_component() = default;
+	password_component(const std::string& pw) : passwd(pw) {}
+};
+
+struct player_relation : encom::relation<player_name_t, position_t> {
+	using encom::relation<player_name_t, position_t>::relation;
+};
+
+struct admin_player_relation : encom::relation<player_relation, password_component> {
+	using encom::relation<player_relation, password_component>::relation;
+
+	admin_player_relation() {}
+};
+
+using ensys = encom::encomsys<admin_player_relation, player_relation, player_name_t, position_t, password_component>;
+using ensys_scheduler = encom::scheduler<ensys>;
+
+void do_physics(ensys& ensys) {
+	ensys.query<player_relation>([](const player_relation::as_ref& player) {
+		std::get<position_t&>(player).x += 1.f;
+	});
+}
+
+void change_password(ensys& ensys) {
+	ensys.query<admin_player_relation>([](const admin_player_relation::as_ref& admin) {
+		admin.get<password_component>().passwd = "new password";
+	});
+}
+
+void print_admins(ensys& ensys) {
+	ensys.query<admin_player_relation>([](const admin_player_relation::as_ref& admin) {
+		std::cout << "Admin (name=" << admin.get<player_relation, player_name_t>().name <<
+					 ", x=" << admin.get<player_relation, position_t>().x <<
+					 ", pw=" << admin.get<password_component>().passwd << ")" << std::endl;
+	});
+}
+
+int main() {
+	ensys ensys;
+	ensys.add(player_relation("player", position_t(0.f)));
+	ensys.add(admin_player_relation(player_relation("admin", position_t(0.f)), password_component("pw")));
+
+	encom::thread_pool pool(2);
+	ensys_scheduler scheduler(ensys, pool);
+	scheduler.add_system<encom::reads<>, encom::writes<player_relation>>("physics", do_physics);
+	scheduler.add_system<encom::reads<>, encom::writes<password_component>>("password", change_password);
+	scheduler.add_system<encom::reads<admin_player_relation>>("print", print_admins);
+
+	for (int tick = 0; tick < 3; tick++) {
+		scheduler.run();
+	}
+
+	for (const encom::system_timing& timing : scheduler.timings()) {
+		std::cout << "system " << timing.name << " ran" << std::endl;
+	}
+
+	// print reads admin_player_relation, which expands to player_relation and password_component
+	std::cout << "critical path:";
+	for (std::size_t system : scheduler.critical_path()) {
+		std::cout << " " << scheduler.timings()[system].name;
+	}
+	std::cout << std::endl;
+
+	// the systems of a chain run one after another, the other workers sleep instead of spinning
+	encom::thread_pool wide_pool(4);
+	ensys_scheduler chain(ensys, wide_pool);
+	for (int i = 0; i < 5; i++) {
+		chain.add_system<encom::reads<>, encom::writes<position_t>>("step" + std::to_string(i), [](auto&) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		});
+	}
+	const std::clock_t cpu_start = std::clock();
+	const auto wall_start = std::chrono::steady_clock::now();
+	chain.run();
+	const double cpu_ms = 1000.0 * double(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+	const double wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall_start).count();
+	std::cout << "idle workers sleep: " << (cpu_ms < wall_ms / 2) << std::endl;
+}
@@ -0,0 +1,153 @@
+#include <cstdio>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "delta.hpp"
+
+struct player_name_t {
+	player_name_t() = default;
+	player_name_t(const std::string& name) : name(name) {}
+
+	std::string name;
+};
+
+struct team_t {
+	team_t() = default;
+	team_t(const int id) : id(id) {}
+
+	int id;
+};
+
+struct player_relation : encom::relation<player_name_t, team_t> {
+	using encom::relation<player_name_t, team_t>::relation;
+};
+
+template<>
+struct encom::component_storage<team_t> : encom::dense_storage {};
+
+// players are found by the name of their child, teams by their id
+template<> struct encom::secondary_index<player_relation> : encom::unique_key<&player_name_t::name> {};
+template<> struct encom::secondary_index<team_t> : encom::multi_key<&team_t::id> {};
+
+template<> struct encom::track_changes<player_relation> : std::true_type {};
+template<> struct encom::track_changes<player_name_t> : std::true_type {};
+template<> struct encom::track_changes<team_t> : std::true_type {};
+
+template<>
+struct encom::serializer<player_name_t> {
+	static void write(encom::snapshot_writer& out, const player_name_t& name) {
+		out.write_string(name.name);
+	}
+
+	static player_name_t read(encom::snapshot_reader& in) {
+		return player_name_t(in.read_string());
+	}
+};
+
+using ensys = encom::encomsys<player_relation, player_name_t, team_t>;
+
+const char* const SNAPSHOT_PATH = "secondary_index_test.bin";
+
+void print_player(ensys& ensys, const std::string& name) {
+	if (std::optional<encom::handle<player_relation>> player = ensys.lookup<player_relation>(name)) {
+		std::cout << name << " is in team " << ensys.get_ref(*player)->get<team_t>().id << std::endl;
+	} else {
+		std::cout << name << " not found" << std::endl;
+	}
+}
+
+void print_team(const ensys& ensys, const int id) {
+	std::vector<encom::handle<team_t>> members;
+	ensys.lookup_all<team_t>(id, std::back_inserter(members));
+	std::cout << "team " << id << " has " << members.size() << " members" << std::endl;
+}
+
+int main() {
+	ensys ensys;
+
+	const encom::handle alice = ensys.add(player_relation("alice", team_t(1)));
+	const encom::handle bob = ensys.add(player_relation("bob", team_t(1)));
+	ensys.add(player_relation("carol", team_t(2)));
+	print_player(ensys, "alice");
+	print_player(ensys, "bob");
+	print_player(ensys, "dave");
+	print_team(ensys, 1);
+	print_team(ensys, 2);
+	print_team(ensys, 3);
+
+	// a second player with the same name is not added
+	try {
+		ensys.add(player_relation("alice", team_t(3)));
+	} catch (const char* e) {
+		std::cout << "error: " << e << std::endl;
+	}
+	std::cout << "players: " << ensys.get_components<player_relation>().size()
+		<< " teams: " << ensys.get_components<team_t>().size() << std::endl;
+	print_team(ensys, 3);
+
+	// removed players are not found anymore, their names can be used again
+	ensys.remove(alice);
+	print_player(ensys, "alice");
+	print_team(ensys, 1);
+	ensys.add(player_relation("alice", team_t(2)));
+	print_player(ensys, "alice");
+	print_team(ensys, 2);
+
+	// modify() and patch() update the key
+	const encom::handle<team_t> bob_team = std::get<encom::handle<team_t>>(ensys.get_components<player_relation>().get(bob.array_index)._handles);
+	ensys.modify(bob_team, [](team_t& team) { team.id = 3; });
+	print_team(ensys, 1);
+	print_team(ensys, 3);
+	ensys.patch(bob_team, team_t(2));
+	print_team(ensys, 2);
+	print_team(ensys, 3);
+
+	// modify() and patch() of a child update the key of its relation
+	const encom::handle<player_name_t> bob_name = std::get<encom::handle<player_name_t>>(ensys.get_components<player_relation>().get(bob.array_index)._handles);
+	ensys.patch(bob_name, player_name_t("bobby"));
+	print_player(ensys, "bob");
+	print_player(ensys, "bobby");
+	try {
+		ensys.modify(bob_name, [](player_name_t& name) { name.name = "carol"; });
+	} catch (const char* e) {
+		std::cout << "error: " << e << std::endl;
+	}
+	print_player(ensys, "bobby");
+	ensys.add(player_relation("bob", team_t(4)));
+	print_player(ensys, "bob");
+
+	// many keys grow the index
+	for (int i = 0; i < 1000; i++) {
+		ensys.add(player_relation("player" + std::to_string(i), team_t(10 + i % 10)));
+	}
+	print_player(ensys, "player0");
+	print_player(ensys, "player999");
+	print_team(ensys, 15);
+	for (int i = 0; i < 1000; i += 2) {
+		ensys.remove(*ensys.lookup<player_relation>("player" + std::to_string(i)));
+	}
+	print_player(ensys, "player0");
+	print_player(ensys, "player999");
+	print_team(ensys, 15);
+
+	// replicas and loaded snapshots are indexed as well
+	::ensys replica;
+	encom::delta<::ensys>(ensys, 0).apply(replica);
+	print_player(replica, "player501");
+	print_team(replica, 15);
+
+	ensys.save(SNAPSHOT_PATH);
+	::ensys loaded;
+	loaded.load(SNAPSHOT_PATH);
+	print_player(loaded, "bob");
+	print_player(loaded, "player2");
+	print_team(loaded, 2);
+
+	ensys.clear<player_relation>();
+	print_player(ensys, "bob");
+	print_team(ensys, 2);
+
+	std::remove(SNAPSHOT_PATH);
+}
@@ -0,0 +1,138 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "encomsys.hpp"
+
+struct player_name_t {
+	player_name_t() = default;
+	player_name_t(const std::string& name) : name(name) {}
+
+	std::string name;
+};
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x) : x(x) {}
+
+	float x;
+};
+
+struct velocity_t {
+	velocity_t() = default;
+	velocity_t(const float dx) : dx(dx) {}
+
+	float dx;
+};
+
+struct player_relation : encom::relation<player_name_t, position_t> {
+	using encom::relation<player_name_t, position_t>::relation;
+};
+
+struct moving_player_relation : encom::relation<player_relation, velocity_t> {
+	using encom::relation<player_relation, velocity_t>::relation;
+
+	moving_player_relation() {}
+};
+
+template<>
+struct encom::component_storage<velocity_t> : encom::dense_storage {};
+
+template<>
+struct encom::serializer<player_name_t> {
+	static void write(encom::snapshot_writer& out, const player_name_t& name) {
+		out.write_string(name.name);
+	}
+
+	static player_name_t read(encom::snapshot_reader& in) {
+		return player_name_t(in.read_string());
+	}
+};
+
+using ensys = encom::encomsys<moving_player_relation, player_relation, player_name_t, position_t, velocity_t>;
+
+const char* const SNAPSHOT_PATH = "snapshot_test.bin";
+const char* const CORRUPT_PATH = "snapshot_test_corrupt.bin";
+
+void print_player(ensys& ensys, const encom::handle<player_relation>& player) {
+	if (auto ref = ensys.get_ref(player)) {
+		std::cout << ref->get<player_name_t>().name << " x=" << ref->get<position_t>().x << std::endl;
+	} else {
+		std::cout << "player not present" << std::endl;
+	}
+}
+
+int main() {
+	encom::handle<player_relation> alice;
+	encom::handle<player_relation> bob;
+	encom::handle<moving_player_relation> carol;
+	encom::handle<position_t> single;
+	{
+		ensys ensys;
+		alice = ensys.add(player_relation("alice", position_t(1.f)));
+		encom::handle removed = ensys.add(player_relation("removed", position_t(2.f)));
+		bob = ensys.add(player_relation("bob", position_t(3.f)));
+		carol = ensys.add(moving_player_relation(player_relation("carol", position_t(4.f)), velocity_t(0.5f)));
+		single = ensys.add(position_t(5.f));
+		ensys.remove(removed);
+		ensys.save(SNAPSHOT_PATH);
+	}
+
+	ensys ensys;
+	ensys.load(SNAPSHOT_PATH);
+	std::cout << "players: " << ensys.get_components<player_relation>().size() << std::endl;
+	std::cout << "positions: " << ensys.get_components<position_t>().size() << std::endl;
+	print_player(ensys, alice);
+	print_player(ensys, bob);
+	std::cout << "carol velocity: " << ensys.get_ref(carol)->get<velocity_t>().dx << std::endl;
+	std::cout << "single x: " << ensys.get(single)->x << std::endl;
+
+	// writes only change the mapped memory
+	ensys.get_ref(single)->x = 6.f;
+	std::cout << "single x after write: " << ensys.get(single)->x << std::endl;
+
+	// the removed slot is reused and adding beyond the mapped slots moves them into an own allocation
+	encom::handle dave = ensys.add(player_relation("dave", position_t(7.f)));
+	for (int i = 0; i < 100; i++) {
+		ensys.add(position_t(float(i)));
+	}
+	print_player(ensys, dave);
+	print_player(ensys, alice);
+	ensys.remove(carol);
+	std::cout << "carol present: " << ensys.has_element(carol) << std::endl;
+	print_player(ensys, bob);
+
+	// loading again restores the saved state
+	ensys.load(SNAPSHOT_PATH);
+	std::cout << "carol present after reload: " << ensys.has_element(carol) << std::endl;
+	std::cout << "dave present after reload: " << ensys.has_element(dave) << std::endl;
+	std::cout << "single x after reload: " << ensys.get(single)->x << std::endl;
+
+	{
+		std::ofstream corrupt(CORRUPT_PATH, std::ios::binary | std::ios::trunc);
+		corrupt << "not a snapshot, but long enough for a header";
+	}
+	try {
+		ensys.load(CORRUPT_PATH);
+		std::cout << "loaded corrupt snapshot" << std::endl;
+	} catch (const char* error) {
+		std::cout << "corrupt snapshot: " << error << std::endl;
+	}
+	print_player(ensys, bob);
+
+	// saving over the loaded snapshot keeps the mapping of the old file
+	ensys.get_ref(single)->x = 8.f;
+	ensys.save(SNAPSHOT_PATH);
+	print_player(ensys, alice);
+	ensys.load(SNAPSHOT_PATH);
+	std::cout << "single x after save and load: " << ensys.get(single)->x << std::endl;
+
+	std::remove(SNAPSHOT_PATH);
+	std::remove(CORRUPT_PATH);
+	try {
+		ensys.load(SNAPSHOT_PATH);
+	} catch (const char* error) {
+		std::cout << "missing snapshot: " << error << std::endl;
+	}
+}
@@ -0,0 +1,71 @@
+#include <iostream>
+#include <string>
+
+#include "encomsys.hpp"
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x, const float y) : x(x), y(y) {}
+
+	float x;
+	float y;
+};
+
+template<>
+struct encom::soa_layout<position_t> {
+	using fields = encom::soa_fields<&position_t::x, &position_t::y>;
+};
+
+struct player_name_t {
+	player_name_t() = default;
+	player_name_t(const std::string& name) : name(name) {}
+
+	std::string name;
+};
+
+struct player_relation : encom::relation<player_name_t, position_t> {
+	using encom::relation<player_name_t, position_t>::relation;
+};
+
+using ensys = encom::encomsys<player_relation, player_name_t, position_t>;
+
+void print_position(const position_t& pos) {
+	std::cout << "Position (x=" << pos.x << ", y=" << pos.y << ")" << std::endl;
+}
+
+int main() {
+	ensys ensys;
+
+	encom::handle pos1 = ensys.add(position_t(1.f, 10.f));
+	encom::handle pos2 = ensys.add(position_t(2.f, 20.f));
+	encom::handle player = ensys.add(player_relation("player", position_t(3.f, 30.f)));
+
+	std::cout << "get:" << std::endl;
+	print_position(*ensys.get(pos1));
+	print_position(*ensys.get(pos2));
+
+	std::cout << "get_ref:" << std::endl;
+	ensys.get_ref(pos1)->get<&position_t::x>() = 5.f;
+	print_position(*ensys.get(pos1));
+
+	std::cout << "batch_update:" << std::endl;
+	ensys.batch_update<position_t>([](std::size_t count, float* x, float* y) {
+		for (std::size_t i = 0; i < count; i++) {
+			x[i] += y[i];
+		}
+	});
+	print_position(*ensys.get(pos1));
+	print_position(*ensys.get(pos2));
+
+	std::cout << "relation:" << std::endl;
+	const player_relation::as_ref player_ref = *ensys.get_ref(player);
+	std::get<encom::soa_ref<position_t>>(player_ref).get<&position_t::y>() = 0.f;
+	print_position(ensys.get(player)->get<position_t>());
+
+	std::cout << "remove:" << std::endl;
+	ensys.remove(pos1);
+	std::cout << "pos1 present: " << ensys.has_element(pos1) << std::endl;
+	print_position(*ensys.get(pos2));
+	ensys.remove(player);
+	std::cout << "number of positions: " << ensys.get_components<position_t>().size() << std::endl;
+}
@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "encomsys.hpp"
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x, const float y) : x(x), y(y) {}
+
+	float x;
+	float y;
+};
+
+struct position3_t {
+	position3_t() = default;
+	position3_t(const float x, const float y, const float z) : x(x), y(y), z(z) {}
+
+	float x;
+	float y;
+	float z;
+};
+
+template<>
+struct encom::component_storage<position3_t> : encom::dense_storage {};
+
+template<> struct encom::spatial_index<position_t> : encom::uniform_grid<&position_t::x, &position_t::y> {
+	static constexpr float cell_size = 4.f;
+};
+template<> struct encom::spatial_index<position3_t> : encom::uniform_grid<&position3_t::x, &position3_t::y, &position3_t::z> {
+	static constexpr float cell_size = 2.f;
+};
+
+using ensys = encom::encomsys<position_t, position3_t>;
+
+float squared_distance(const position_t& a, const position_t& b) {
+	return (a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y);
+}
+
+std::vector<encom::ID_TYPE> sorted_indices(const std::vector<encom::handle<position_t>>& handles) {
+	std::vector<encom::ID_TYPE> indices;
+	for (const encom::handle<position_t>& h : handles) {
+		indices.push_back(h.array_index);
+	}
+	std::sort(indices.begin(), indices.end());
+	return indices;
+}
+
+/**
+ * Compares the queries around center with a scan over all positions.
+ */
+bool matches_scan(ensys& ensys, const position_t& center, const float radius, const std::size_t k) {
+	std::vector<encom::ID_TYPE> in_radius;
+	std::vector<encom::ID_TYPE> in_box;
+	std::vector<std::pair<float, encom::ID_TYPE>> by_distance;
+	const auto& positions = ensys.get_components<position_t>();
+	for (auto iter = positions.begin(); iter != positions.end(); ++iter) {
+		const position_t& p = (*iter).value;
+		if (squared_distance(p, center) <= radius * radius) {
+			in_radius.push_back(iter.index());
+		}
+		if (p.x >= center.x - radius && p.x <= center.x + radius && p.y >= center.y - radius && p.y <= center.y + radius) {
+			in_box.push_back(iter.index());
+		}
+		by_distance.emplace_back(squared_distance(p, center), iter.index());
+	}
+	std::sort(by_distance.begin(), by_distance.end());
+
+	std::vector<encom::handle<position_t>> result;
+	ensys.query_radius(center, radius, std::back_inserter(result));
+	const bool radius_matches = sorted_indices(result) == in_radius;
+
+	result.clear();
+	ensys.query_box(position_t(center.x - radius, center.y - radius), position_t(center.x + radius, center.y + radius), std::back_inserter(result));
+	const bool box_matches = sorted_indices(result) == in_box;
+
+	result.clear();
+	ensys.query_nearest(center, k, std::back_inserter(result));
+	bool nearest_matches = result.size() == std::min(k, by_distance.size());
+	for (std::size_t i = 0; nearest_matches && i < result.size(); i++) {
+		nearest_matches = squared_distance(*ensys.get(result[i]), center) == by_distance[i].first;
+	}
+	return radius_matches && box_matches && nearest_matches;
+}
+
+int main() {
+	ensys ensys;
+
+	std::vector<encom::handle<position_t>> handles;
+	const encom::handle<position_t> origin = ensys.add(position_t(0.f, 0.f));
+	ensys.add(position_t(3.f, 0.f));
+	ensys.add(position_t(-5.f, 0.f));
+	ensys.add(position_t(0.f, 20.f));
+
+	ensys.query_radius(position_t(0.f, 0.f), 4.f, std::back_inserter(handles));
+	std::cout << "within 4 of origin: " << handles.size() << std::endl;
+	handles.clear();
+	ensys.query_nearest(position_t(0.f, 18.f), 2, std::back_inserter(handles));
+	std::cout << "nearest to (0, 18): (" << ensys.get(handles[0])->x << ", " << ensys.get(handles[0])->y << ") then ("
+		<< ensys.get(handles[1])->x << ", " << ensys.get(handles[1])->y << ")" << std::endl;
+	handles.clear();
+	ensys.query_box(position_t(-10.f, -1.f), position_t(1.f, 1.f), std::back_inserter(handles));
+	std::cout << "in box (-10, -1) to (1, 1): " << handles.size() << std::endl;
+
+	// patch() moves the position in the index
+	ensys.patch(origin, position_t(0.f, 19.f));
+	handles.clear();
+	ensys.query_nearest(position_t(0.f, 18.f), 1, std::back_inserter(handles));
+	std::cout << "nearest after patch is the origin: " << (handles[0].array_index == origin.array_index) << std::endl;
+
+	// writes through get_ref() are seen after mark_changed()
+	ensys.get_ref(origin)->y = -100.f;
+	handles.clear();
+	ensys.query_radius(position_t(0.f, -100.f), 1.f, std::back_inserter(handles));
+	std::cout << "found before mark_changed: " << handles.size() << std::endl;
+	ensys.mark_changed(origin);
+	handles.clear();
+	ensys.query_radius(position_t(0.f, -100.f), 1.f, std::back_inserter(handles));
+	std::cout << "found after mark_changed: " << handles.size() << std::endl;
+
+	// random positions, moves and removes against a scan
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> coordinate(-100.f, 100.f);
+	std::vector<encom::handle<position_t>> added;
+	for (int i = 0; i < 2000; i++) {
+		added.push_back(ensys.add(position_t(coordinate(rng), coordinate(rng))));
+	}
+	bool all_match = true;
+	for (int i = 0; i < 50; i++) {
+		all_match = all_match && matches_scan(ensys, position_t(coordinate(rng), coordinate(rng)), 10.f, 7);
+	}
+	std::cout << "queries match scan: " << all_match << std::endl;
+	for (std::size_t i = 0; i < added.size(); i += 3) {
+		ensys.modify(added[i], [&](position_t& p) { p.x += coordinate(rng) * 0.1f; });
+	}
+	for (std::size_t i = 1; i < added.size(); i += 3) {
+		ensys.remove(added[i]);
+	}
+	for (int i = 0; i < 50; i++) {
+		all_match = all_match && matches_scan(ensys, position_t(coordinate(rng), coordinate(rng)), 15.f, 20);
+	}
+	// far away from all positions and more neighbours than positions
+	all_match = all_match && matches_scan(ensys, position_t(10000.f, -5000.f), 1.f, 3);
+	all_match = all_match && matches_scan(ensys, position_t(0.f, 0.f), 1000.f, 100000);
+	std::cout << "queries match scan after moves and removes: " << all_match << std::endl;
+
+	// distant positions are found by scanning the occupied cells instead of searching every ring
+	ensys.clear<position_t>();
+	ensys.add(position_t(0.f, 0.f));
+	ensys.add(position_t(80000.f, 3.f));
+	ensys.add(position_t(-20000.f, 60000.f));
+	handles.clear();
+	ensys.query_nearest(position_t(1.f, 1.f), 2, std::back_inserter(handles));
+	std::cout << "nearest distant: " << handles.size() << " second x=" << ensys.get(handles[1])->x << std::endl;
+	std::cout << "distant queries match scan: " << (matches_scan(ensys, position_t(50000.f, 0.f), 5.f, 2) && matches_scan(ensys, position_t(-1.f, 30000.f), 5.f, 3)) << std::endl;
+
+	// a moving element reuses the cells it leaves
+	encom::spatial_grid<2> grid(1.f);
+	grid.insert(0, {0.f, 0.f});
+	grid.insert(1, {0.5f, 0.5f});
+	for (int i = 1; i <= 10000; i++) {
+		grid.move(0, {float(i), float(i)});
+	}
+	const std::vector<std::pair<float, encom::ID_TYPE>> nearest = grid.nearest({0.f, 0.f}, 2);
+	std::cout << "cells after moves: " << grid.number_of_cells() << " nearest: " << nearest[0].second << " " << nearest[1].second << std::endl;
+
+	// three dimensions
+	ensys.add(position3_t(0.f, 0.f, 0.f));
+	ensys.add(position3_t(1.f, 1.f, 1.f));
+	ensys.add(position3_t(0.f, 0.f, 5.f));
+	std::vector<encom::handle<position3_t>> handles3;
+	ensys.query_radius(position3_t(0.f, 0.f, 0.f), 2.f, std::back_inserter(handles3));
+	std::cout << "3d within 2 of origin: " << handles3.size() << std::endl;
+
+	ensys.clear<position_t>();
+	handles.clear();
+	ensys.query_nearest(position_t(0.f, 0.f), 5, std::back_inserter(handles));
+	std::cout << "nearest after clear: " << handles.size() << std::endl;
+}
@@ -0,0 +1,110 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "encomsys.hpp"
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x, const float y) : x(x), y(y) {}
+
+	float x;
+	float y;
+};
+
+template<>
+struct encom::soa_layout<position_t> {
+	using fields = encom::soa_fields<&position_t::x, &position_t::y>;
+};
+
+struct health_t {
+	health_t() = default;
+	health_t(const int hp) : hp(hp) {}
+
+	int hp;
+};
+
+template<>
+struct encom::component_storage<health_t> : encom::dense_storage {};
+
+struct name_t {
+	name_t() = default;
+	name_t(const std::string& name) : name(name) {}
+
+	std::string name;
+};
+
+struct player_relation : encom::relation<name_t, health_t> {
+	using encom::relation<name_t, health_t>::relation;
+};
+
+using ensys = encom::encomsys<player_relation, name_t, health_t, position_t>;
+
+void print_stats(const encom::component_stats& stats) {
+	std::cout << "  live=" << stats.live << " holes=" << stats.holes << " capacity>=live: " << (stats.capacity >= stats.live)
+		<< " payload=" << stats.payload_bytes << " metadata=" << stats.metadata_bytes
+		<< " allocated>=payload: " << (stats.allocated_bytes >= stats.payload_bytes + stats.metadata_bytes) << std::endl;
+	std::cout << "  adds=" << stats.adds << " removes=" << stats.removes << " gets=" << stats.gets
+		<< " get_refs=" << stats.get_refs << " failed_has_element=" << stats.failed_has_element << std::endl;
+}
+
+int main() {
+	ensys ensys;
+
+	std::vector<encom::handle<name_t>> names;
+	for (int i = 0; i < 10; i++) {
+		names.push_back(ensys.add(name_t("name" + std::to_string(i))));
+	}
+	ensys.remove(names[2]);
+	ensys.remove(names[5]);
+	ensys.get(names[0]);
+	ensys.get(names[2]);
+	ensys.get_ref(names[1]);
+	ensys.has_element(names[5]);
+
+	std::cout << "name_t:" << std::endl;
+	print_stats(ensys.stats<name_t>());
+	std::cout << "  fragmentation: " << ensys.stats<name_t>().fragmentation() << std::endl;
+
+	// reading a relation is only counted for the relation, adding it also for its childs
+	const encom::handle<player_relation> player = ensys.add(player_relation("player", health_t(100)));
+	ensys.get(player);
+	ensys.get_ref(player);
+	std::cout << "player_relation:" << std::endl;
+	print_stats(ensys.stats<player_relation>());
+	std::cout << "  payload is handles: " << (ensys.stats<player_relation>().payload_bytes == sizeof(player_relation::__component_handles)) << std::endl;
+	std::cout << "health_t:" << std::endl;
+	print_stats(ensys.stats<health_t>());
+
+	// soa storages have no wrapper, the metadata are the columns of the consecutive indices and references
+	const encom::handle<position_t> position = ensys.add(position_t(1.f, 2.f));
+	ensys.add(position_t(3.f, 4.f));
+	ensys.get_ref(position);
+	std::cout << "position_t:" << std::endl;
+	print_stats(ensys.stats<position_t>());
+
+	// every thread counts into its own shard
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; t++) {
+		threads.emplace_back([&ensys, &names]() {
+			const auto& readonly = ensys;
+			for (int i = 0; i < 1000; i++) {
+				readonly.get(names[0]);
+			}
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	std::cout << "gets from threads: " << ensys.stats<name_t>().gets << std::endl;
+
+	std::cout << "all types:" << std::endl;
+	for (const encom::component_stats& stats : ensys.stats()) {
+		std::cout << "  live=" << stats.live << " adds=" << stats.adds << std::endl;
+	}
+
+	ensys.reset_stats();
+	std::cout << "after reset:" << std::endl;
+	print_stats(ensys.stats<name_t>());
+}
@@ -0,0 +1,115 @@
+#define ENCOM_TRACING
+#define ENCOM_TRACE_RING_CAPACITY 1024
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "encomsys.hpp"
+#include "scheduler.hpp"
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x) : x(x) {}
+
+	float x;
+};
+
+struct health_t {
+	health_t() = default;
+	health_t(const int hp) : hp(hp) {}
+
+	int hp;
+};
+
+struct player_relation : encom::relation<position_t, health_t> {
+	using encom::relation<position_t, health_t>::relation;
+};
+
+using ensys = encom::encomsys<player_relation, position_t, health_t>;
+using ensys_scheduler = encom::scheduler<ensys>;
+
+void movement_system(ensys& ensys) {
+	ENCOM_TRACE_SPAN("movement");
+	ensys.query<player_relation>([](const player_relation::as_ref& player) {
+		player.get<position_t>().x += 1.f;
+	});
+}
+
+const encom::latency_summary* find_latency(const std::vector<encom::latency_summary>& latencies, const std::string& name) {
+	for (const encom::latency_summary& latency : latencies) {
+		if (latency.name == name) {
+			return &latency;
+		}
+	}
+	return nullptr;
+}
+
+std::size_t count(const std::string& haystack, const std::string& needle) {
+	std::size_t n = 0;
+	for (std::size_t pos = haystack.find(needle); pos != std::string::npos; pos = haystack.find(needle, pos + 1)) {
+		n++;
+	}
+	return n;
+}
+
+int main() {
+	encom::tracer& tracer = encom::tracer::instance();
+	ensys ensys;
+
+	const encom::handle<player_relation> player = ensys.add(player_relation(position_t(1.f), health_t(100)));
+	for (int i = 0; i < 10; i++) {
+		ensys.get(player);
+	}
+	ensys.remove(ensys.add(position_t(2.f)));
+
+	// user systems are spans too, on the scheduler threads
+	encom::thread_pool pool(2);
+	ensys_scheduler scheduler(ensys, pool);
+	scheduler.add_system<encom::reads<>, encom::writes<player_relation>>("movement_system", movement_system);
+	scheduler.run();
+
+	std::thread other([&ensys, player]() {
+		const auto& readonly = ensys;
+		readonly.get(player);
+	});
+	other.join();
+
+	const std::vector<encom::latency_summary> latencies = tracer.latencies();
+	const encom::latency_summary* get = find_latency(latencies, "encomsys::get");
+	std::cout << "gets: " << (get ? get->count : 0) << std::endl;
+	std::cout << "p50 <= p99 <= max: " << (get && get->p50_ns <= get->p99_ns && get->p99_ns <= get->max_ns) << std::endl;
+	std::cout << "relation adds and childs: " << find_latency(latencies, "encomsys::add")->count << std::endl;
+	std::cout << "removes: " << find_latency(latencies, "encomsys::remove")->count << std::endl;
+	std::cout << "user span: " << find_latency(latencies, "movement")->count << std::endl;
+	std::cout << "system span: " << find_latency(latencies, "movement_system")->count << std::endl;
+
+	std::ostringstream trace;
+	tracer.write_chrome_trace(trace);
+	const std::string json = trace.str();
+	std::cout << "chrome trace: " << (json.rfind("{\"traceEvents\":[", 0) == 0) << std::endl;
+	std::cout << "complete events: " << (count(json, "\"ph\":\"X\"") == count(json, "\"name\":")) << std::endl;
+	std::cout << "gets in trace: " << count(json, "\"name\":\"encomsys::get\"") << std::endl;
+	std::cout << "threads in trace: " << (count(json, "\"tid\":0") > 0 && json.find("\"tid\":1") != std::string::npos) << std::endl;
+
+	// the ring buffer keeps the latest spans, the histograms count all of them
+	tracer.reset();
+	for (int i = 0; i < 3000; i++) {
+		ENCOM_TRACE_SPAN("loop");
+	}
+	std::ostringstream overflowed;
+	tracer.write_chrome_trace(overflowed);
+	std::cout << "spans after overflow: " << count(overflowed.str(), "\"name\":\"loop\"") << std::endl;
+	std::cout << "gets after reset: " << (find_latency(tracer.latencies(), "encomsys::get") == nullptr) << std::endl;
+	std::cout << "loops counted: " << find_latency(tracer.latencies(), "loop")->count << std::endl;
+
+	// bucket limits
+	bool buckets_ordered = true;
+	for (std::uint64_t ns = 1; ns < 100000000; ns = ns * 3 + 1) {
+		const std::size_t bucket = encom::latency_histogram::bucket_of(ns);
+		buckets_ordered = buckets_ordered && ns <= encom::latency_histogram::bucket_limit(bucket)
+			&& (bucket == 0 || ns > encom::latency_histogram::bucket_limit(bucket - 1));
+	}
+	std::cout << "buckets ordered: " << buckets_ordered << std::endl;
+}
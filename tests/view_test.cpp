@@ -0,0 +1,72 @@
+#include <iostream>
+#include <string>
+
+#include "encomsys.hpp"
+
+struct player_name_t {
+	player_name_t() = default;
+	player_name_t(const std::string& name) : name(name) {}
+
+	std::string name;
+};
+
+struct position_t {
+	position_t() = default;
+	position_t(const float x) : x(x) {}
+
+	float x;
+};
+
+struct password_component {
+	std::string passwd;
+
+	password_component() = default;
+	password_component(const std::string& pw) : passwd(pw) {}
+};
+
+struct player_relation : encom::relation<player_name_t, position_t> {
+	using encom::relation<player_name_t, position_t>::relation;
+};
+
+struct admin_player_relation : encom::relation<player_relation, password_component> {
+	using encom::relation<player_relation, password_component>::relation;
+
+	admin_player_relation() {}
+};
+
+using ensys = encom::encomsys<admin_player_relation, player_relation, player_name_t, position_t, password_component>;
+
+void do_physics(const player_relation::as_ref& player) {
+	std::get<position_t&>(player).x += 1.f;
+}
+
+void print_player(const player_relation::as_ref& player) {
+	std::cout << "Player (name=" << player.get<player_name_t>().name << ", x=" << player.get<position_t>().x << ")" << std::endl;
+}
+
+void print_admin(const admin_player_relation::as_ref& admin) {
+	std::cout << "Admin (name=" << admin.get<player_relation, player_name_t>().name <<
+				 ", x=" << admin.get<player_relation, position_t>().x <<
+				 ", pw=" << admin.get<password_component>().passwd << ")" << std::endl;
+}
+
+int main() {
+	ensys ensys;
+
+	ensys.add(player_relation("player1", position_t(0.f)));
+	encom::handle player2 = ensys.add(player_relation("player2", position_t(10.f)));
+	ensys.add(player_relation("player3", position_t(20.f)));
+	ensys.add(admin_player_relation(player_relation("admin", position_t(30.f)), password_component("pw")));
+
+	ensys.remove(player2);
+
+	std::cout << "players in view: " << ensys.view<player_relation>().size() << std::endl;
+	ensys.view<player_relation>().for_each(do_physics);
+	ensys.query<player_relation>(print_player);
+
+	std::cout << "admins:" << std::endl;
+	ensys.query<admin_player_relation>([](const admin_player_relation::as_ref& admin) {
+		admin.get<password_component>().passwd = "changed";
+	});
+	ensys.query<admin_player_relation>(print_admin);
+}